@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 
@@ -145,18 +147,21 @@ namespace Azure { namespace Core {
     struct ContextSharedState
     {
       std::shared_ptr<ContextSharedState> Parent;
-      time_point CancelAt;
+      // Cancel may be called from another thread than the ones checking the context, so the
+      // deadline is kept as an atomic count of clock ticks since the epoch.
+      std::atomic<time_point::rep> CancelAt;
       std::string Key;
       ContextValue Value;
 
-      explicit ContextSharedState() : CancelAt(time_point::max()) {}
+      explicit ContextSharedState() : CancelAt(time_point::max().time_since_epoch().count()) {}
 
       explicit ContextSharedState(
           const std::shared_ptr<ContextSharedState>& parent,
           time_point cancelAt,
           const std::string& key,
           ContextValue&& value)
-          : Parent(parent), CancelAt(cancelAt), Key(key), Value(std::move(value))
+          : Parent(parent), CancelAt(cancelAt.time_since_epoch().count()), Key(key),
+            Value(std::move(value))
       {
       }
     };
@@ -204,14 +209,17 @@ namespace Azure { namespace Core {
       return empty;
     }
 
-    void Cancel() { m_contextSharedState->CancelAt = time_point::min(); }
+    void Cancel()
+    {
+      m_contextSharedState->CancelAt.store(
+          time_point::min().time_since_epoch().count(), std::memory_order_release);
+    }
 
     void ThrowIfCanceled()
     {
       if (CancelWhen() < std::chrono::system_clock::now())
       {
-        // TODO: Runtime Exc
-        throw;
+        throw std::runtime_error("the operation was cancelled");
       }
     }
   };
@@ -45,6 +45,17 @@ namespace Azure { namespace Core { namespace Http {
     // return copied size
     virtual int64_t Read(Context& context, uint8_t* buffer, int64_t count) = 0;
 
+    // Streams on top of contiguous memory hand out their data without copying it: returns a
+    // pointer to the next *bytesRead (at most count) bytes and moves past them, the pointer stays
+    // valid as long as the underlying memory. Returns nullptr if the stream isn't contiguous.
+    virtual const uint8_t* ReadContiguous(Context& context, int64_t count, int64_t* bytesRead)
+    {
+      (void)context;
+      (void)count;
+      (void)bytesRead;
+      return nullptr;
+    }
+
     // Keep reading until buffer is all fill out of the end of stream content is reached
     static int64_t ReadToCount(Context& context, BodyStream& body, uint8_t* buffer, int64_t count);
 
@@ -75,6 +86,8 @@ namespace Azure { namespace Core { namespace Http {
 
     int64_t Read(Context& context, uint8_t* buffer, int64_t count) override;
 
+    const uint8_t* ReadContiguous(Context& context, int64_t count, int64_t* bytesRead) override;
+
     void Rewind() override { m_offset = 0; }
   };
 
@@ -171,6 +184,7 @@ namespace Azure { namespace Core { namespace Http {
       this->m_bytesRead = 0;
     }
     int64_t Read(Context& context, uint8_t* buffer, int64_t count) override;
+    const uint8_t* ReadContiguous(Context& context, int64_t count, int64_t* bytesRead) override;
   };
 
 }}} // namespace Azure::Core::Http
@@ -16,6 +16,8 @@ namespace Azure { namespace Core { namespace Http {
 
   // libcurl CURL_MAX_WRITE_SIZE is 16k.
   constexpr auto UploadStreamPageSize = 1024 * 64;
+  // Bodies on top of contiguous memory are sent straight from it, this much per send call.
+  constexpr auto UploadContiguousPageSize = 1024 * 1024;
   constexpr auto LibcurlReaderSize = 1024;
 
   /**
@@ -194,9 +194,9 @@ namespace Azure { namespace Core { namespace Http {
       auto port = this->m_port.size() > 0 ? ":" + this->m_port : "";
       return this->m_scheme + "://" + this->m_host + port + this->m_path;
     }
-    std::string GetPath() const { return this->m_path; }
+    std::string const& GetPath() const { return this->m_path; }
     std::string GetHost() const { return this->m_host; }
-    std::map<std::string, std::string> GetQueryParameters() const
+    std::map<std::string, std::string> const& GetQueryParameters() const
     {
       return this->m_queryParameters;
     }
@@ -230,6 +230,35 @@ namespace Azure { namespace Core { namespace Http {
       return left;
     }
 
+    // calls func for the items of the maps MergeMaps would return, in order, without copying them
+    template <class Func>
+    static void ForEachMerged(
+        std::map<std::string, std::string> const& left,
+        std::map<std::string, std::string> const& right,
+        Func& func)
+    {
+      auto leftIte = left.begin();
+      auto rightIte = right.begin();
+      while (leftIte != left.end() || rightIte != right.end())
+      {
+        if (rightIte == right.end()
+            || (leftIte != left.end() && !(rightIte->first < leftIte->first)))
+        {
+          if (rightIte != right.end() && rightIte->first == leftIte->first)
+          {
+            ++rightIte;
+          }
+          func(leftIte->first, leftIte->second);
+          ++leftIte;
+        }
+        else
+        {
+          func(rightIte->first, rightIte->second);
+          ++rightIte;
+        }
+      }
+    }
+
     std::string GetQueryString() const;
 
   public:
@@ -258,6 +287,19 @@ namespace Azure { namespace Core { namespace Http {
     std::map<std::string, std::string> GetHeaders() const;
     BodyStream* GetBodyStream() { return this->m_bodyStream; }
     std::string GetHTTPMessagePreBody() const;
+
+    // Methods used by policies that read the whole request on every send, like signing, they
+    // visit the same values as GetHeaders and GetEncodedUrl without building copies of them.
+    // func is called with the name and the value, in the order of the names.
+    std::string const& GetPath() const { return this->m_url.GetPath(); }
+    template <class Func> void ForEachHeader(Func func) const
+    {
+      ForEachMerged(this->m_retryHeaders, this->m_headers, func);
+    }
+    template <class Func> void ForEachQueryParameter(Func func) const
+    {
+      ForEachMerged(this->m_retryQueryParameters, this->m_url.GetQueryParameters(), func);
+    }
   };
 
   /*
@@ -14,14 +14,15 @@ Context& GetApplicationContext()
 
 time_point Context::CancelWhen()
 {
-  auto result = time_point::max();
+  auto result = time_point::max().time_since_epoch().count();
   for (auto ptr = m_contextSharedState; ptr; ptr = ptr->Parent)
   {
-    if (result > ptr->CancelAt)
+    auto cancelAt = ptr->CancelAt.load(std::memory_order_acquire);
+    if (result > cancelAt)
     {
-      result = ptr->CancelAt;
+      result = cancelAt;
     }
   }
 
-  return result;
+  return time_point(time_point::duration(result));
 }
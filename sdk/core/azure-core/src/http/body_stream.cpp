@@ -71,6 +71,17 @@ int64_t MemoryBodyStream::Read(Context& context, uint8_t* buffer, int64_t count)
   return copy_length;
 }
 
+const uint8_t* MemoryBodyStream::ReadContiguous(Context& context, int64_t count, int64_t* bytesRead)
+{
+  context.ThrowIfCanceled();
+
+  const uint8_t* data = this->m_data + m_offset;
+  *bytesRead = std::min(count, static_cast<int64_t>(this->m_length - this->m_offset));
+  m_offset += *bytesRead;
+
+  return data;
+}
+
 #ifdef POSIX
 
 int64_t FileBodyStream::Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count)
@@ -122,3 +133,14 @@ int64_t LimitBodyStream::Read(Context& context, uint8_t* buffer, int64_t count)
   this->m_bytesRead += bytesRead;
   return bytesRead;
 }
+
+const uint8_t* LimitBodyStream::ReadContiguous(Context& context, int64_t count, int64_t* bytesRead)
+{
+  const uint8_t* data = m_inner->ReadContiguous(
+      context, std::min(count, this->m_length - this->m_bytesRead), bytesRead);
+  if (data != nullptr)
+  {
+    this->m_bytesRead += *bytesRead;
+  }
+  return data;
+}
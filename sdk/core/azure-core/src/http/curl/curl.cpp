@@ -232,8 +232,7 @@ CURLcode CurlSession::SendBuffer(uint8_t const* buffer, size_t bufferSize)
         case CURLE_AGAIN:
           if (!WaitForSocketReady(this->m_curlSocket, 0, 60000L))
           {
-            // TODO: Change this to something more relevant
-            throw;
+            throw Azure::Core::Http::TransportException();
           }
           break;
         default:
@@ -248,8 +247,8 @@ CURLcode CurlSession::SendBuffer(uint8_t const* buffer, size_t bufferSize)
 CURLcode CurlSession::UploadBody(Context& context)
 {
   // Send body UploadStreamPageSize at a time (libcurl default)
-  // NOTE: if stream is on top a contiguous memory, we can avoid allocating this copying buffer
-  auto unique_buffer = std::make_unique<uint8_t[]>(UploadStreamPageSize);
+  // If stream is on top a contiguous memory, send straight from it and skip the copying buffer
+  std::unique_ptr<uint8_t[]> unique_buffer;
   auto streamBody = this->m_request.GetBodyStream();
   CURLcode sendResult = CURLE_OK;
 
@@ -257,12 +256,23 @@ CURLcode CurlSession::UploadBody(Context& context)
   this->m_uploadedBytes = 0;
   while (true)
   {
-    auto rawRequestLen = streamBody->Read(context, unique_buffer.get(), UploadStreamPageSize);
+    int64_t rawRequestLen = 0;
+    const uint8_t* rawRequest
+        = streamBody->ReadContiguous(context, UploadContiguousPageSize, &rawRequestLen);
+    if (rawRequest == nullptr)
+    {
+      if (!unique_buffer)
+      {
+        unique_buffer = std::make_unique<uint8_t[]>(UploadStreamPageSize);
+      }
+      rawRequestLen = streamBody->Read(context, unique_buffer.get(), UploadStreamPageSize);
+      rawRequest = unique_buffer.get();
+    }
     if (rawRequestLen == 0)
     {
       break;
     }
-    sendResult = SendBuffer(unique_buffer.get(), static_cast<size_t>(rawRequestLen));
+    sendResult = SendBuffer(rawRequest, static_cast<size_t>(rawRequestLen));
     if (sendResult != CURLE_OK)
     {
       return sendResult;
@@ -515,8 +525,9 @@ int64_t CurlSession::ReadSocketToBuffer(uint8_t* buffer, int64_t bufferSize)
       case CURLE_AGAIN:
         if (!WaitForSocketReady(this->m_curlSocket, 0, 60000L))
         {
-          // TODO: Change this to somehing more relevant
-          throw;
+          // The connection stalled. There is no exception being handled here, a bare throw would
+          // terminate the process.
+          throw Azure::Core::Http::TransportException();
         }
         break;
       case CURLE_OK:
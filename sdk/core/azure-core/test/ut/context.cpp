@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "gtest/gtest.h"
+#include <context.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace Azure::Core;
+
+TEST(Context, cancelFromAnotherThread)
+{
+  Context context;
+  auto child = context.WithDeadline(Context::time_point::max());
+  EXPECT_NO_THROW(child.ThrowIfCanceled());
+
+  std::thread canceller([&context]() { context.Cancel(); });
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (child.CancelWhen() >= std::chrono::system_clock::now()
+         && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::yield();
+  }
+  canceller.join();
+
+  EXPECT_EQ(child.CancelWhen(), Context::time_point::min());
+  EXPECT_THROW(child.ThrowIfCanceled(), std::runtime_error);
+}
+
+TEST(Context, deadline)
+{
+  Context context;
+  auto deadline = std::chrono::system_clock::now() + std::chrono::hours(1);
+  auto child = context.WithDeadline(deadline);
+  EXPECT_EQ(child.CancelWhen(), deadline);
+  EXPECT_EQ(context.CancelWhen(), Context::time_point::max());
+  EXPECT_NO_THROW(child.ThrowIfCanceled());
+}
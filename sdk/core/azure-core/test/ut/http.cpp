@@ -4,6 +4,7 @@
 #include "gtest/gtest.h"
 #include <http/http.hpp>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace Azure::Core;
@@ -116,3 +117,64 @@ TEST(Http_Request, add_path)
       req.GetEncodedUrl(),
       url + "/path/path2/path3?query=value");
 }
+
+TEST(Http_BodyStream, read_contiguous)
+{
+  std::vector<uint8_t> data = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  Context context;
+
+  Http::MemoryBodyStream memoryStream(data);
+  int64_t bytesRead = 0;
+  EXPECT_EQ(memoryStream.ReadContiguous(context, 4, &bytesRead), data.data());
+  EXPECT_EQ(bytesRead, 4);
+
+  // Contiguous and copying reads share the position.
+  uint8_t buffer[2];
+  EXPECT_EQ(memoryStream.Read(context, buffer, 2), 2);
+  EXPECT_EQ(buffer[0], 5);
+  EXPECT_EQ(memoryStream.ReadContiguous(context, 100, &bytesRead), data.data() + 6);
+  EXPECT_EQ(bytesRead, 4);
+  EXPECT_NE(memoryStream.ReadContiguous(context, 100, &bytesRead), nullptr);
+  EXPECT_EQ(bytesRead, 0);
+
+  memoryStream.Rewind();
+  Http::LimitBodyStream limitStream(&memoryStream, 5);
+  EXPECT_EQ(limitStream.ReadContiguous(context, 100, &bytesRead), data.data());
+  EXPECT_EQ(bytesRead, 5);
+  EXPECT_NE(limitStream.ReadContiguous(context, 100, &bytesRead), nullptr);
+  EXPECT_EQ(bytesRead, 0);
+
+  auto nullStream = Http::NullBodyStream::GetNullBodyStream();
+  EXPECT_EQ(nullStream->ReadContiguous(context, 1, &bytesRead), nullptr);
+}
+
+TEST(Http_Request, visit_in_place)
+{
+  Http::Request req(Http::HttpMethod::Get, "http://test.com/container/blob?b=1&a=2");
+  req.AddHeader("X-Ms-B", "value");
+  req.AddHeader("a", "value");
+  req.StartRetry();
+  req.AddHeader("x-ms-b", "retryValue");
+  req.AddHeader("c", "retryValue");
+  req.AddQueryParameter("a", "3");
+  req.AddQueryParameter("c", "4");
+
+  // Same items and order as the copying getters.
+  std::vector<std::pair<std::string, std::string>> headers;
+  req.ForEachHeader([&headers](const std::string& name, const std::string& value) {
+    headers.emplace_back(name, value);
+  });
+  auto expectedHeaders = req.GetHeaders();
+  using HeaderList = std::vector<std::pair<std::string, std::string>>;
+  EXPECT_EQ(headers, HeaderList(expectedHeaders.begin(), expectedHeaders.end()));
+  EXPECT_EQ(headers.size(), 3U);
+  EXPECT_EQ(headers[2].second, "retryValue");
+
+  std::string query;
+  req.ForEachQueryParameter([&query](const std::string& key, const std::string& value) {
+    query += (query.empty() ? "?" : "&") + key + "=" + value;
+  });
+  EXPECT_EQ(query, "?a=3&b=1&c=4");
+  EXPECT_EQ(req.GetEncodedUrl(), "http://test.com" + req.GetPath() + query);
+  EXPECT_EQ(req.GetPath(), "/container/blob");
+}
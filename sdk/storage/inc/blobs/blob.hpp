@@ -4,8 +4,10 @@
 #pragma once
 
 #include "blobs/append_blob_client.hpp"
+#include "blobs/blob_batch_client.hpp"
 #include "blobs/blob_client.hpp"
 #include "blobs/blob_container_client.hpp"
 #include "blobs/blob_service_client.hpp"
 #include "blobs/block_blob_client.hpp"
 #include "blobs/page_blob_client.hpp"
+#include "common/transfer_governor.hpp"
@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "blob_options.hpp"
+#include "common/storage_credential.hpp"
+#include "common/storage_url_builder.hpp"
+#include "internal/protocol/blob_rest_client.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Blobs {
+
+  /**
+   * @brief The outcome of one operation of a blob batch.
+   */
+  struct BlobBatchItemResult
+  {
+    /**
+     * @brief The HTTP status code the service answered the operation with.
+     */
+    Azure::Core::Http::HttpStatusCode StatusCode = Azure::Core::Http::HttpStatusCode::None;
+
+    /**
+     * @brief The reason phrase of the answer, a description of the error if the operation failed.
+     */
+    std::string ReasonPhrase;
+
+    /**
+     * @brief The service error code, empty if the operation succeeded.
+     */
+    std::string ErrorCode;
+
+    /**
+     * @brief The request id the service assigned to the operation.
+     */
+    std::string RequestId;
+
+    /**
+     * @brief Whether the operation succeeded.
+     */
+    bool Succeeded() const
+    {
+      auto statusCode = static_cast<int>(StatusCode);
+      return statusCode >= 200 && statusCode < 300;
+    }
+  };
+
+  /**
+   * @brief The outcome of a blob batch.
+   */
+  struct SubmitBlobBatchResult
+  {
+    std::string RequestId;
+    std::string Date;
+    std::string Version;
+
+    /**
+     * @brief One result per operation, in the order the operations were added to the batch.
+     */
+    std::vector<BlobBatchItemResult> Results;
+  };
+
+  /**
+   * @brief A set of blob operations that are sent to the service in a single request with
+   * BlobBatchClient. A batch holds up to BlobBatch::MaximumSize operations.
+   */
+  class BlobBatch {
+  public:
+    /**
+     * @brief The maximum number of operations the service accepts in one batch.
+     */
+    static constexpr std::size_t MaximumSize = 256;
+
+    /**
+     * @brief Adds the deletion of a blob to the batch.
+     *
+     * @param containerName The name of the container containing the blob.
+     * @param blobName The name of the blob to delete.
+     * @param options Optional parameters of the deletion, Context is ignored.
+     * @return The index of the operation's result in SubmitBlobBatchResult::Results.
+     */
+    std::size_t DeleteBlob(
+        const std::string& containerName,
+        const std::string& blobName,
+        const DeleteBlobOptions& options = DeleteBlobOptions());
+
+    /**
+     * @brief Adds setting the access tier of a blob to the batch.
+     *
+     * @param containerName The name of the container containing the blob.
+     * @param blobName The name of the blob.
+     * @param tier The new access tier of the blob.
+     * @param options Optional parameters of the operation, Context is ignored.
+     * @return The index of the operation's result in SubmitBlobBatchResult::Results.
+     */
+    std::size_t SetBlobAccessTier(
+        const std::string& containerName,
+        const std::string& blobName,
+        AccessTier tier,
+        const SetAccessTierOptions& options = SetAccessTierOptions());
+
+    /**
+     * @brief Returns the number of operations in the batch.
+     */
+    std::size_t Size() const { return m_operations.size(); }
+
+  private:
+    enum class OperationType
+    {
+      Delete,
+      SetAccessTier,
+    };
+
+    struct Operation
+    {
+      OperationType Type;
+      std::string ContainerName;
+      std::string BlobName;
+      DeleteBlobOptions DeleteOptions;
+      AccessTier Tier = AccessTier::Unknown;
+      SetAccessTierOptions TierOptions;
+    };
+
+    void AddOperation(Operation operation);
+
+    std::vector<Operation> m_operations;
+
+    friend class BlobBatchClient;
+  };
+
+  /**
+   * The BlobBatchClient sends several blob operations to the service in a single request, which
+   * saves a round trip per operation when many small blobs are deleted or re-tiered.
+   */
+  class BlobBatchClient {
+  public:
+    /**
+     * @brief Initialize a new instance of BlobBatchClient.
+     *
+     * @param connectionString A connection string includes the authentication information required
+     * for your application to access data in an Azure Storage account at runtime.
+     * @param options Optional client options that define the transport pipeline policies for
+     * authentication, retries, etc., that are applied to every request.
+     * @return A new BlobBatchClient instance.
+     */
+    static BlobBatchClient CreateFromConnectionString(
+        const std::string& connectionString,
+        const BlobBatchClientOptions& options = BlobBatchClientOptions());
+
+    /**
+     * @brief Initialize a new instance of BlobBatchClient.
+     *
+     * @param serviceUri A uri referencing the blob service of the account.
+     * @param credential The shared key credential used to sign the batch requests and every
+     * operation in them.
+     * @param options Optional client options that define the transport pipeline policies for
+     * authentication, retries, etc., that are applied to every request.
+     */
+    explicit BlobBatchClient(
+        const std::string& serviceUri,
+        std::shared_ptr<SharedKeyCredential> credential,
+        const BlobBatchClientOptions& options = BlobBatchClientOptions());
+
+    /**
+     * @brief Initialize a new instance of BlobBatchClient.
+     *
+     * @param serviceUri A uri referencing the blob service of the account, and possibly also a
+     * SAS token.
+     * @param options Optional client options that define the transport pipeline policies for
+     * authentication, retries, etc., that are applied to every request.
+     */
+    explicit BlobBatchClient(
+        const std::string& serviceUri,
+        const BlobBatchClientOptions& options = BlobBatchClientOptions());
+
+    /**
+     * @brief Gets the blob service's primary uri endpoint.
+     *
+     * @return the blob service's primary uri endpoint.
+     */
+    std::string GetUri() const { return m_serviceUrl.ToString(); }
+
+    /**
+     * @brief Sends the operations of a batch to the service in one multipart/mixed request.
+     * Operations that fail don't fail the call, their errors are reported in the result. Throws
+     * if the batch is empty or the service rejects the batch as a whole. Safe to call from
+     * several threads at once.
+     *
+     * @param batch The operations to send.
+     * @param options Optional parameters to execute this function.
+     * @return A SubmitBlobBatchResult with the outcome of every operation.
+     */
+    SubmitBlobBatchResult SubmitBatch(
+        const BlobBatch& batch,
+        const SubmitBlobBatchOptions& options = SubmitBlobBatchOptions()) const;
+
+    /**
+     * @brief Sends several batches, up to options.Concurrency of them at once. Throws the first
+     * error of a batch that is rejected as a whole, the others stop.
+     *
+     * @param batches The batches to send.
+     * @param options Optional parameters to execute this function.
+     * @return The results of the batches, in the order of batches.
+     */
+    std::vector<SubmitBlobBatchResult> SubmitBatches(
+        const std::vector<BlobBatch>& batches,
+        const SubmitBlobBatchesOptions& options = SubmitBlobBatchesOptions()) const;
+
+  protected:
+    UrlBuilder m_serviceUrl;
+    std::shared_ptr<Azure::Core::Http::HttpPipeline> m_pipeline;
+    // Signs the operations of a batch, never sends anything.
+    std::shared_ptr<Azure::Core::Http::HttpPipeline> m_subRequestPipeline;
+  };
+}}} // namespace Azure::Storage::Blobs
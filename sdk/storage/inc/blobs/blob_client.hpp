@@ -257,6 +257,18 @@ namespace Azure { namespace Storage { namespace Blobs {
         const std::string& file,
         const DownloadBlobToFileOptions& options = DownloadBlobToFileOptions()) const;
 
+    /**
+     * @brief Opens a blob or a blob range for sequential reading. Ranged requests for the
+     * following chunks are issued ahead of the reader, so reading isn't held up by the latency of
+     * every request. All chunks are read from the version of the blob that was current when it
+     * was opened, reading fails if the blob is changed in the meantime.
+     *
+     * @param options Optional parameters to execute this function.
+     * @return A stream of the blob's data.
+     */
+    std::unique_ptr<Azure::Core::Http::BodyStream> OpenRead(
+        const OpenReadBlobOptions& options = OpenReadBlobOptions()) const;
+
     /**
      * @brief Creates a read-only snapshot of a blob.
      *
@@ -5,13 +5,16 @@
 
 #include "blob_options.hpp"
 #include "blobs/blob_client.hpp"
+#include "common/paged_range.hpp"
 #include "common/storage_credential.hpp"
 #include "common/storage_url_builder.hpp"
 #include "internal/protocol/blob_rest_client.hpp"
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace Azure { namespace Storage { namespace Blobs {
 
@@ -186,6 +189,44 @@ namespace Azure { namespace Storage { namespace Blobs {
      */
     BlobsFlatSegment ListBlobsFlat(const ListBlobsOptions& options = ListBlobsOptions()) const;
 
+    /**
+     * @brief Same as ListBlobsFlat, but every blob is handed to blobReceived as soon as it is
+     * parsed from the response, while the rest of the response is still being downloaded. Items
+     * of the returned segment are left empty.
+     *
+     * @param blobReceived Called with every blob, which it may move from.
+     * @param options Optional parameters to execute this function.
+     * @return A BlobsFlatSegment with the NextMarker and BlobPrefixes of the segment.
+     */
+    BlobsFlatSegment ListBlobsFlat(
+        const std::function<void(BlobItem& blob)>& blobReceived,
+        const ListBlobsOptions& options = ListBlobsOptions()) const;
+
+    /**
+     * @brief Returns all blobs in this container from the specified Marker on, ordered
+     * lexicographically by name. Segments are requested as the range is walked, up to
+     * options.PrefetchDepth of them ahead of the caller. Prefixes of a Delimiter listing aren't
+     * part of the range.
+     *
+     * @param options Optional parameters to execute this function.
+     * @return A PagedRange of the blobs in the container.
+     */
+    PagedRange<BlobItem> ListBlobs(const ListBlobsOptions& options = ListBlobsOptions()) const;
+
+    /**
+     * @brief Lists all blobs in this container with up to options.Concurrency requests in flight.
+     * The namespace is split into disjoint prefix ranges, by options.PartitionAlphabet or by the
+     * virtual directories delimiter listings find, and the ranges are listed concurrently. Every
+     * page of blobs is handed to blobsReceived, either in name order or as it arrives. Calls to
+     * blobsReceived don't overlap, but may come from transfer threads.
+     *
+     * @param blobsReceived Called with every page of blobs, which it may move from.
+     * @param options Optional parameters to execute this function.
+     */
+    void ListBlobsParallel(
+        const std::function<void(std::vector<BlobItem>& blobs)>& blobsReceived,
+        const ListBlobsParallelOptions& options = ListBlobsParallelOptions()) const;
+
   private:
     UrlBuilder m_containerUrl;
     std::shared_ptr<Azure::Core::Http::HttpPipeline> m_pipeline;
@@ -124,6 +124,12 @@ namespace Azure { namespace Storage { namespace Blobs {
      * @brief Specifies that the container's metadata be returned.
      */
     ListBlobContainersIncludeOption Include = ListBlobContainersIncludeOption::None;
+
+    /**
+     * @brief The number of pages ListBlobContainers fetches ahead of the caller. Not used by
+     * ListBlobContainersSegment.
+     */
+    int PrefetchDepth = 1;
   };
 
   /**
@@ -137,6 +143,51 @@ namespace Azure { namespace Storage { namespace Blobs {
     Azure::Core::Context Context;
   };
 
+  /**
+   * @brief Batch client options used to initalize BlobBatchClient.
+   */
+  struct BlobBatchClientOptions
+  {
+    /**
+     * @brief Transport pipeline policies for authentication, additional HTTP headers, etc., that
+     * are applied to every batch request.
+     */
+    std::vector<std::unique_ptr<Azure::Core::Http::HttpPolicy>> PerOperationPolicies;
+
+    /**
+     * @brief Transport pipeline policies for authentication, additional HTTP headers, etc., that
+     * are applied to every retrial of a batch request.
+     */
+    std::vector<std::unique_ptr<Azure::Core::Http::HttpPolicy>> PerRetryPolicies;
+  };
+
+  /**
+   * @brief Optional parameters for BlobBatchClient::SubmitBatch.
+   */
+  struct SubmitBlobBatchOptions
+  {
+    /**
+     * @brief Context for cancelling long running operations.
+     */
+    Azure::Core::Context Context;
+  };
+
+  /**
+   * @brief Optional parameters for BlobBatchClient::SubmitBatches.
+   */
+  struct SubmitBlobBatchesOptions
+  {
+    /**
+     * @brief Context for cancelling long running operations.
+     */
+    Azure::Core::Context Context;
+
+    /**
+     * @brief The maximum number of batch requests that may be in flight at once.
+     */
+    int Concurrency = 4;
+  };
+
   /**
    * @brief Container client options used to initalize BlobContainerClient.
    */
@@ -266,6 +317,73 @@ namespace Azure { namespace Storage { namespace Blobs {
      * @brief Specifies one or more datasets to include in the response.
      */
     ListBlobsIncludeItem Include = ListBlobsIncludeItem::None;
+
+    /**
+     * @brief The number of pages ListBlobs fetches ahead of the caller. Not used by
+     * ListBlobsFlat.
+     */
+    int PrefetchDepth = 1;
+  };
+
+  /**
+   * @brief Optional parameters for BlobContainerClient::ListBlobsParallel.
+   */
+  struct ListBlobsParallelOptions
+  {
+    /**
+     * @brief Context for cancelling long running operations.
+     */
+    Azure::Core::Context Context;
+
+    /**
+     * @brief Specifies a string that filters the results to return only blobs whose
+     * name begins with the specified prefix.
+     */
+    Azure::Core::Nullable<std::string> Prefix;
+
+    /**
+     * @brief Specifies the maximum number of blobs every listing request returns.
+     */
+    Azure::Core::Nullable<int32_t> MaxResults;
+
+    /**
+     * @brief Specifies one or more datasets to include in the response. Snapshots can't be
+     * listed along with a delimiter, use a PartitionAlphabet to include them.
+     */
+    ListBlobsIncludeItem Include = ListBlobsIncludeItem::None;
+
+    /**
+     * @brief The characters that may follow Prefix in blob names. The namespace is split into
+     * one range per character. Blobs whose name goes on with a character that isn't part of the
+     * alphabet are not listed. Characters are single bytes, so non-ASCII names are best split
+     * with a Delimiter instead. When not set, ranges are found with delimiter listings.
+     */
+    Azure::Core::Nullable<std::string> PartitionAlphabet;
+
+    /**
+     * @brief The delimiter of the virtual hierarchy ranges are found in when there is no
+     * PartitionAlphabet. Every virtual directory becomes a range of its own, blobs right under a
+     * directory that is split come with its delimiter listing.
+     */
+    std::string Delimiter = "/";
+
+    /**
+     * @brief The number of hierarchy levels below Prefix that are split into ranges. Splitting
+     * stops earlier once there are enough ranges to keep all workers busy.
+     */
+    int PartitionDepth = 2;
+
+    /**
+     * @brief The maximum number of listing requests that may be in flight at once.
+     */
+    int Concurrency = 8;
+
+    /**
+     * @brief Hands out blobs ordered by name, as ListBlobs does. Pages of ranges that come after
+     * the one being handed out are held in memory until it is done. When false, pages are handed
+     * out as soon as they arrive.
+     */
+    bool Sorted = false;
   };
 
   /**
@@ -452,6 +570,33 @@ namespace Azure { namespace Storage { namespace Blobs {
      */
     Azure::Core::Nullable<int64_t> Length;
 
+    /**
+     * @brief When set to true and specified together with the Offset and Length, the service
+     * returns the MD5 hash for the range, as long as the range is less than or equal to 4 MiB in
+     * size.
+     */
+    Azure::Core::Nullable<bool> RangeGetContentMD5;
+
+    /**
+     * @brief When set to true and specified together with the Offset and Length, the service
+     * returns the CRC64 hash for the range, as long as the range is less than or equal to 4 MiB in
+     * size.
+     */
+    Azure::Core::Nullable<bool> RangeGetContentCRC64;
+
+    /**
+     * @brief When set to true, the body stream hashes the content while it's read and throws once
+     * it reaches the end if the MD5 or CRC64 the service returned doesn't match.
+     */
+    bool ValidateContentHash = false;
+
+    /**
+     * @brief The maximum number of times reading the content is resumed with a new request from
+     * where it stopped, after the connection failed or was closed early. The new requests are
+     * made with If-Match on the ETag of the blob. 0 disables resuming.
+     */
+    int MaximumBodyRetries = 5;
+
     /**
      * @brief Optional conditions that must be met to perform this operation.
      */
@@ -495,12 +640,103 @@ namespace Azure { namespace Storage { namespace Blobs {
      * @brief The maximum number of threads that may be used in a parallel transfer.
      */
     int Concurrency = 1;
+
+    /**
+     * @brief Tunes the chunk size and the number of threads to the measured throughput, starting
+     * from the values that worked best for the same endpoint before. ChunkSize and Concurrency
+     * become upper bounds. The initial chunk is not tuned.
+     */
+    bool AutoTune = false;
+
+    /**
+     * @brief Has the service return a CRC64 of every downloaded chunk and checks the received
+     * bytes against it. Chunks, including the initial one, are limited to 4 MiB.
+     */
+    bool TransactionalCRC64 = false;
   };
 
   /**
    * @brief Optional parameters for BlobClient::DownloadToFile.
    */
-  using DownloadBlobToFileOptions = DownloadBlobToBufferOptions;
+  struct DownloadBlobToFileOptions : public DownloadBlobToBufferOptions
+  {
+    DownloadBlobToFileOptions() = default;
+
+    /**
+     * @brief Takes the transfer options of a DownloadToBuffer call, the file specific options keep
+     * their defaults.
+     */
+    DownloadBlobToFileOptions(const DownloadBlobToBufferOptions& options)
+        : DownloadBlobToBufferOptions(options)
+    {
+    }
+
+    /**
+     * @brief Reserves disk space for the whole range up front once its size is known, which
+     * keeps the file from fragmenting. Ignored where the file system doesn't support it.
+     */
+    bool PreallocateFile = false;
+
+    /**
+     * @brief Writes bypass the page cache (O_DIRECT) where the platform and file system support
+     * it. Writes that don't meet the alignment requirements, like the tail of the file, still go
+     * through the page cache.
+     */
+    bool DirectIo = false;
+
+    /**
+     * @brief Evicts written data from the page cache once it is on disk, so that large downloads
+     * don't push other data out of the cache.
+     */
+    bool DropCacheAfterWrite = false;
+
+    /**
+     * @brief Path of a journal that records the chunks written to the file. A download that
+     * fails can be started again with the same options and only downloads the missing chunks, as
+     * long as neither the blob nor the file was changed. All chunks are downloaded with If-Match
+     * on the ETag of the blob and AutoTune is ignored. The journal is deleted once the download
+     * succeeded.
+     */
+    Azure::Core::Nullable<std::string> JournalFile;
+  };
+
+  /**
+   * @brief Optional parameters for BlobClient::OpenRead.
+   */
+  struct OpenReadBlobOptions
+  {
+    /**
+     * @brief Context for cancelling long running operations.
+     */
+    Azure::Core::Context Context;
+
+    /**
+     * @brief Reads only the bytes of the blob from this offset.
+     */
+    Azure::Core::Nullable<int64_t> Offset;
+
+    /**
+     * @brief Reads at most this number of bytes of the blob from the offset. Null means read
+     * until the end.
+     */
+    Azure::Core::Nullable<int64_t> Length;
+
+    /**
+     * @brief The number of bytes in a single range request.
+     */
+    int64_t ChunkSize = 4 * 1024 * 1024;
+
+    /**
+     * @brief The maximum number of range requests in flight ahead of the reader. Up to this
+     * number of chunks is held in memory.
+     */
+    int Concurrency = 1;
+
+    /**
+     * @brief Optional conditions that must be met to perform this operation.
+     */
+    BlobAccessConditions Conditions;
+  };
 
   /**
    * @brief Optional parameters for BlobClient::CreateSnapshot.
@@ -584,6 +820,12 @@ namespace Azure { namespace Storage { namespace Blobs {
      */
     Azure::Core::Nullable<std::string> ContentCRC64;
 
+    /**
+     * @brief When set to true, the content is hashed while it's sent and the MD5 and CRC64 the
+     * service returns are checked against it, an exception is thrown if they don't match.
+     */
+    bool ValidateContentHash = false;
+
     /**
      * @brief The standard HTTP header system properties to set.
      */
@@ -639,6 +881,43 @@ namespace Azure { namespace Storage { namespace Blobs {
      * @brief The maximum number of threads that may be used in a parallel transfer.
      */
     int Concurrency = 1;
+
+    /**
+     * @brief Tunes the block size and the number of threads to the measured throughput, starting
+     * from the values that worked best for the same endpoint before. ChunkSize and Concurrency
+     * become upper bounds.
+     */
+    bool AutoTune = false;
+
+    /**
+     * @brief Sends a CRC64 of every block, which the service checks before storing the block.
+     */
+    bool TransactionalCRC64 = false;
+
+    /**
+     * @brief Sends the blocks of BlockBlobClient::UploadFromFile straight from a shared memory
+     * mapping of the file instead of copying them through a read buffer. The file must not be
+     * truncated during the upload: reading a page past its new end, or an I/O error on a network
+     * file system, raises SIGBUS instead of an error. Files that can't be mapped are read as usual.
+     */
+    bool MemoryMapFile = false;
+
+    /**
+     * @brief Names blocks by the base64 of their index padded to 6 digits rather than to 64, so
+     * that block IDs are 8 characters instead of 88 and the block list committed at the end is
+     * about a third of the size. All block IDs of a blob must have the same length, so this can't
+     * be changed while blocks staged by an earlier upload are still uncommitted on the blob.
+     */
+    bool CompactBlockIds = false;
+
+    /**
+     * @brief Path of a journal that records the blocks staged so far, only used by
+     * BlockBlobClient::UploadFromFile. An upload that fails can be started again with the same
+     * options and only stages the missing blocks, as long as the file wasn't modified. Blocks in
+     * the journal are checked against the uncommitted block list of the blob before they are
+     * skipped. AutoTune is ignored. The journal is deleted once the upload succeeded.
+     */
+    Azure::Core::Nullable<std::string> JournalFile;
   };
 
   /**
@@ -665,6 +944,12 @@ namespace Azure { namespace Storage { namespace Blobs {
      */
     Azure::Core::Nullable<std::string> ContentCRC64;
 
+    /**
+     * @brief When set to true, the content is hashed while it's sent and the MD5 and CRC64 the
+     * service returns are checked against it, an exception is thrown if they don't match.
+     */
+    bool ValidateContentHash = false;
+
     /**
      * @brief Optional conditions that must be met to perform this operation.
      */
@@ -820,6 +1105,12 @@ namespace Azure { namespace Storage { namespace Blobs {
      */
     Azure::Core::Nullable<std::string> ContentCRC64;
 
+    /**
+     * @brief When set to true, the content is hashed while it's sent and the MD5 and CRC64 the
+     * service returns are checked against it, an exception is thrown if they don't match.
+     */
+    bool ValidateContentHash = false;
+
     /**
      * @brief Optional conditions that must be met to perform this operation.
      */
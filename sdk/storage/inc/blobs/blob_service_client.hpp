@@ -5,10 +5,12 @@
 
 #include "blob_options.hpp"
 #include "blobs/blob_container_client.hpp"
+#include "common/paged_range.hpp"
 #include "common/storage_credential.hpp"
 #include "common/storage_url_builder.hpp"
 #include "internal/protocol/blob_rest_client.hpp"
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -106,6 +108,30 @@ namespace Azure { namespace Storage { namespace Blobs {
     ListContainersSegment ListBlobContainersSegment(
         const ListBlobContainersOptions& options = ListBlobContainersOptions()) const;
 
+    /**
+     * @brief Same as ListBlobContainersSegment, but every container is handed to
+     * containerReceived as soon as it is parsed from the response, while the rest of the response
+     * is still being downloaded. Items of the returned segment are left empty.
+     *
+     * @param containerReceived Called with every container, which it may move from.
+     * @param options Optional parameters to execute this function.
+     * @return A ListContainersSegment with the NextMarker of the segment.
+     */
+    ListContainersSegment ListBlobContainersSegment(
+        const std::function<void(BlobContainerItem& container)>& containerReceived,
+        const ListBlobContainersOptions& options = ListBlobContainersOptions()) const;
+
+    /**
+     * @brief Returns all blob containers in the storage account from the specified Marker on,
+     * ordered lexicographically by name. Segments are requested as the range is walked, up to
+     * options.PrefetchDepth of them ahead of the caller.
+     *
+     * @param options Optional parameters to execute this function.
+     * @return A PagedRange of the blob containers in the storage account.
+     */
+    PagedRange<BlobContainerItem> ListBlobContainers(
+        const ListBlobContainersOptions& options = ListBlobContainersOptions()) const;
+
     /**
      * @brief Retrieves a key that can be used to delegate Active Directory authorization to
      * shared access signatures.
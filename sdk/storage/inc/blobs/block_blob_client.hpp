@@ -139,6 +139,20 @@ namespace Azure { namespace Storage { namespace Blobs {
         const std::string& file,
         const UploadBlobOptions& options = UploadBlobOptions()) const;
 
+    /**
+     * @brief Creates a new block blob, or updates the content of an existing block blob. Updating
+     * an existing block blob overwrites any existing metadata on the blob.
+     *
+     * @param content A BodyStream read once to the end, which doesn't need to be rewindable or of
+     * known length. It's cut into blocks that are staged in parallel and committed once the
+     * stream ends. Memory use is bounded by Concurrency times ChunkSize. AutoTune doesn't apply.
+     * @param options Optional parameters to execute this function.
+     * @return A BlobContentInfo describing the state of the updated block blob.
+     */
+    BlobContentInfo UploadFromStream(
+        Azure::Core::Http::BodyStream& content,
+        const UploadBlobOptions& options = UploadBlobOptions()) const;
+
     /**
      * @brief Creates a new block as part of a block blob's staging area to be eventually
      * committed via the CommitBlockList operation.
@@ -16,6 +16,7 @@
 #include <functional>
 #include <limits>
 #include <map>
+#include <memory>
 #include <set>
 #include <stdexcept>
 #include <string>
@@ -1064,6 +1065,7 @@ namespace Azure { namespace Storage { namespace Blobs {
     std::string NextMarker;
     std::string Delimiter;
     std::vector<BlobItem> Items;
+    std::vector<std::string> BlobPrefixes;
   }; // struct BlobsFlatSegment
 
   struct ListContainersSegment
@@ -1127,11 +1129,13 @@ namespace Azure { namespace Storage { namespace Blobs {
         return request;
       }
 
+      // When itemReceived is set, the containers are handed to it as they are parsed from the
+      // response body instead of being collected in Items.
       static ListContainersSegment ListBlobContainersParseResponse(
           Azure::Core::Context context,
-          std::unique_ptr<Azure::Core::Http::Response> pHttpResponse)
+          std::unique_ptr<Azure::Core::Http::Response> pHttpResponse,
+          const std::function<void(BlobContainerItem& item)>& itemReceived = nullptr)
       {
-        unused(context);
         Azure::Core::Http::Response& httpResponse = *pHttpResponse;
         ListContainersSegment response;
         auto http_status_code
@@ -1143,19 +1147,8 @@ namespace Azure { namespace Storage { namespace Blobs {
         }
         {
           auto bodyStream = httpResponse.GetBodyStream();
-          std::vector<uint8_t> bodyContent;
-          if (bodyStream->Length() == -1)
-          {
-            bodyContent = Azure::Core::Http::BodyStream::ReadToEnd(context, *bodyStream);
-          }
-          else
-          {
-            bodyContent.resize(static_cast<std::size_t>(bodyStream->Length()));
-            Azure::Core::Http::BodyStream::ReadToCount(
-                context, *bodyStream, &bodyContent[0], bodyStream->Length());
-          }
-          XmlReader reader(reinterpret_cast<const char*>(bodyContent.data()), bodyContent.size());
-          response = ListContainersSegmentFromXml(reader);
+          XmlReader reader(context, *bodyStream);
+          response = ListContainersSegmentFromXml(reader, itemReceived);
         }
         response.Version = httpResponse.GetHeaders().at("x-ms-version");
         response.Date = httpResponse.GetHeaders().at("Date");
@@ -1173,13 +1166,14 @@ namespace Azure { namespace Storage { namespace Blobs {
           Azure::Core::Context context,
           Azure::Core::Http::HttpPipeline& pipeline,
           const std::string& url,
-          const ListBlobContainersOptions& options)
+          const ListBlobContainersOptions& options,
+          const std::function<void(BlobContainerItem& item)>& itemReceived = nullptr)
       {
         BodyStreamPointer pRequestBody;
         auto request = ListBlobContainersConstructRequest(url, pRequestBody, options);
         auto pResponse = pipeline.Send(context, request);
         pRequestBody.reset();
-        return ListBlobContainersParseResponse(context, std::move(pResponse));
+        return ListBlobContainersParseResponse(context, std::move(pResponse), itemReceived);
       }
 
       struct GetUserDelegationKeyOptions
@@ -1275,7 +1269,9 @@ namespace Azure { namespace Storage { namespace Blobs {
       }
 
     private:
-      static ListContainersSegment ListContainersSegmentFromXml(XmlReader& reader)
+      static ListContainersSegment ListContainersSegmentFromXml(
+          XmlReader& reader,
+          const std::function<void(BlobContainerItem& item)>& itemReceived = nullptr)
       {
         ListContainersSegment ret;
         enum class XmlTagName
@@ -1340,7 +1336,15 @@ namespace Azure { namespace Storage { namespace Blobs {
             if (path.size() == 3 && path[0] == XmlTagName::k_EnumerationResults
                 && path[1] == XmlTagName::k_Containers && path[2] == XmlTagName::k_Container)
             {
-              ret.Items.emplace_back(BlobContainerItemFromXml(reader));
+              if (itemReceived)
+              {
+                auto item = BlobContainerItemFromXml(reader);
+                itemReceived(item);
+              }
+              else
+              {
+                ret.Items.emplace_back(BlobContainerItemFromXml(reader));
+              }
               path.pop_back();
             }
           }
@@ -2108,11 +2112,13 @@ namespace Azure { namespace Storage { namespace Blobs {
         return request;
       }
 
+      // When itemReceived is set, the blobs are handed to it as they are parsed from the
+      // response body instead of being collected in Items.
       static BlobsFlatSegment ListBlobsParseResponse(
           Azure::Core::Context context,
-          std::unique_ptr<Azure::Core::Http::Response> pHttpResponse)
+          std::unique_ptr<Azure::Core::Http::Response> pHttpResponse,
+          const std::function<void(BlobItem& item)>& itemReceived = nullptr)
       {
-        unused(context);
         Azure::Core::Http::Response& httpResponse = *pHttpResponse;
         BlobsFlatSegment response;
         auto http_status_code
@@ -2124,19 +2130,8 @@ namespace Azure { namespace Storage { namespace Blobs {
         }
         {
           auto bodyStream = httpResponse.GetBodyStream();
-          std::vector<uint8_t> bodyContent;
-          if (bodyStream->Length() == -1)
-          {
-            bodyContent = Azure::Core::Http::BodyStream::ReadToEnd(context, *bodyStream);
-          }
-          else
-          {
-            bodyContent.resize(static_cast<std::size_t>(bodyStream->Length()));
-            Azure::Core::Http::BodyStream::ReadToCount(
-                context, *bodyStream, &bodyContent[0], bodyStream->Length());
-          }
-          XmlReader reader(reinterpret_cast<const char*>(bodyContent.data()), bodyContent.size());
-          response = BlobsFlatSegmentFromXml(reader);
+          XmlReader reader(context, *bodyStream);
+          response = BlobsFlatSegmentFromXml(reader, itemReceived);
         }
         response.Version = httpResponse.GetHeaders().at("x-ms-version");
         response.Date = httpResponse.GetHeaders().at("Date");
@@ -2154,17 +2149,20 @@ namespace Azure { namespace Storage { namespace Blobs {
           Azure::Core::Context context,
           Azure::Core::Http::HttpPipeline& pipeline,
           const std::string& url,
-          const ListBlobsOptions& options)
+          const ListBlobsOptions& options,
+          const std::function<void(BlobItem& item)>& itemReceived = nullptr)
       {
         BodyStreamPointer pRequestBody;
         auto request = ListBlobsConstructRequest(url, pRequestBody, options);
         auto pResponse = pipeline.Send(context, request);
         pRequestBody.reset();
-        return ListBlobsParseResponse(context, std::move(pResponse));
+        return ListBlobsParseResponse(context, std::move(pResponse), itemReceived);
       }
 
     private:
-      static BlobsFlatSegment BlobsFlatSegmentFromXml(XmlReader& reader)
+      static BlobsFlatSegment BlobsFlatSegmentFromXml(
+          XmlReader& reader,
+          const std::function<void(BlobItem& item)>& itemReceived = nullptr)
       {
         BlobsFlatSegment ret;
         enum class XmlTagName
@@ -2176,9 +2174,65 @@ namespace Azure { namespace Storage { namespace Blobs {
           k_Delimiter,
           k_Blobs,
           k_Blob,
+          k_BlobPrefix,
+          k_Name,
           k_Unknown,
         };
-        std::vector<XmlTagName> path;
+        // A name is told apart from the others by its hash and confirmed with one comparison.
+        auto tagOf = [](const char* name) {
+          XmlTagName tag = XmlTagName::k_Unknown;
+          const char* tagName = "";
+          switch (XmlNameHash(name))
+          {
+            case XmlNameHash("EnumerationResults"):
+              tag = XmlTagName::k_EnumerationResults;
+              tagName = "EnumerationResults";
+              break;
+            case XmlNameHash("Prefix"):
+              tag = XmlTagName::k_Prefix;
+              tagName = "Prefix";
+              break;
+            case XmlNameHash("Marker"):
+              tag = XmlTagName::k_Marker;
+              tagName = "Marker";
+              break;
+            case XmlNameHash("NextMarker"):
+              tag = XmlTagName::k_NextMarker;
+              tagName = "NextMarker";
+              break;
+            case XmlNameHash("Delimiter"):
+              tag = XmlTagName::k_Delimiter;
+              tagName = "Delimiter";
+              break;
+            case XmlNameHash("Blobs"):
+              tag = XmlTagName::k_Blobs;
+              tagName = "Blobs";
+              break;
+            case XmlNameHash("Blob"):
+              tag = XmlTagName::k_Blob;
+              tagName = "Blob";
+              break;
+            case XmlNameHash("BlobPrefix"):
+              tag = XmlTagName::k_BlobPrefix;
+              tagName = "BlobPrefix";
+              break;
+            case XmlNameHash("Name"):
+              tag = XmlTagName::k_Name;
+              tagName = "Name";
+              break;
+            default:
+              break;
+          }
+          return std::strcmp(name, tagName) == 0 ? tag : XmlTagName::k_Unknown;
+        };
+        // The deepest element read is EnumerationResults/Blobs/BlobPrefix/Name, Blob elements
+        // are read by BlobItemFromXml. tags[i] is the element open at level i + 1, or k_Unknown
+        // when it or one of its parents isn't read.
+        int depth = 0;
+        XmlTagName tags[4] = {XmlTagName::k_Unknown,
+                              XmlTagName::k_Unknown,
+                              XmlTagName::k_Unknown,
+                              XmlTagName::k_Unknown};
         while (true)
         {
           auto node = reader.Read();
@@ -2188,92 +2242,78 @@ namespace Azure { namespace Storage { namespace Blobs {
           }
           else if (node.Type == XmlNodeType::EndTag)
           {
-            if (path.size() > 0)
-            {
-              path.pop_back();
-            }
-            else
+            if (depth == 0)
             {
               break;
             }
+            --depth;
           }
           else if (node.Type == XmlNodeType::StartTag)
           {
-            if (std::strcmp(node.Name, "EnumerationResults") == 0)
-            {
-              path.emplace_back(XmlTagName::k_EnumerationResults);
-            }
-            else if (std::strcmp(node.Name, "Prefix") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Prefix);
-            }
-            else if (std::strcmp(node.Name, "Marker") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Marker);
-            }
-            else if (std::strcmp(node.Name, "NextMarker") == 0)
-            {
-              path.emplace_back(XmlTagName::k_NextMarker);
-            }
-            else if (std::strcmp(node.Name, "Delimiter") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Delimiter);
-            }
-            else if (std::strcmp(node.Name, "Blobs") == 0)
+            ++depth;
+            if (depth > 4)
             {
-              path.emplace_back(XmlTagName::k_Blobs);
+              continue;
             }
-            else if (std::strcmp(node.Name, "Blob") == 0)
+            XmlTagName tag = XmlTagName::k_Unknown;
+            if (depth == 1 || tags[depth - 2] != XmlTagName::k_Unknown)
             {
-              path.emplace_back(XmlTagName::k_Blob);
+              tag = tagOf(node.Name);
             }
-            else
+            tags[depth - 1] = tag;
+            if (depth == 3 && tags[1] == XmlTagName::k_Blobs && tag == XmlTagName::k_Blob)
             {
-              path.emplace_back(XmlTagName::k_Unknown);
-            }
-            if (path.size() == 3 && path[0] == XmlTagName::k_EnumerationResults
-                && path[1] == XmlTagName::k_Blobs && path[2] == XmlTagName::k_Blob)
-            {
-              ret.Items.emplace_back(BlobItemFromXml(reader));
-              path.pop_back();
+              if (itemReceived)
+              {
+                auto item = BlobItemFromXml(reader);
+                itemReceived(item);
+              }
+              else
+              {
+                ret.Items.emplace_back(BlobItemFromXml(reader));
+              }
+              --depth;
             }
           }
           else if (node.Type == XmlNodeType::Text)
           {
-            if (path.size() == 2 && path[0] == XmlTagName::k_EnumerationResults
-                && path[1] == XmlTagName::k_Prefix)
-            {
-              ret.Prefix = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_EnumerationResults
-                && path[1] == XmlTagName::k_Marker)
-            {
-              ret.Marker = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_EnumerationResults
-                && path[1] == XmlTagName::k_NextMarker)
-            {
-              ret.NextMarker = node.Value;
+            if (depth == 2 && tags[0] == XmlTagName::k_EnumerationResults)
+            {
+              switch (tags[1])
+              {
+                case XmlTagName::k_Prefix:
+                  ret.Prefix = node.Value;
+                  break;
+                case XmlTagName::k_Marker:
+                  ret.Marker = node.Value;
+                  break;
+                case XmlTagName::k_NextMarker:
+                  ret.NextMarker = node.Value;
+                  break;
+                case XmlTagName::k_Delimiter:
+                  ret.Delimiter = node.Value;
+                  break;
+                default:
+                  break;
+              }
             }
             else if (
-                path.size() == 2 && path[0] == XmlTagName::k_EnumerationResults
-                && path[1] == XmlTagName::k_Delimiter)
+                depth == 4 && tags[0] == XmlTagName::k_EnumerationResults
+                && tags[1] == XmlTagName::k_Blobs && tags[2] == XmlTagName::k_BlobPrefix
+                && tags[3] == XmlTagName::k_Name)
             {
-              ret.Delimiter = node.Value;
+              ret.BlobPrefixes.emplace_back(node.Value);
             }
           }
-          else if (node.Type == XmlNodeType::Attribute)
+          else if (
+              node.Type == XmlNodeType::Attribute && depth == 1
+              && tags[0] == XmlTagName::k_EnumerationResults)
           {
-            if (path.size() == 1 && path[0] == XmlTagName::k_EnumerationResults
-                && std::strcmp(node.Name, "ServiceEndpoint") == 0)
+            if (std::strcmp(node.Name, "ServiceEndpoint") == 0)
             {
               ret.ServiceEndpoint = node.Value;
             }
-            else if (
-                path.size() == 1 && path[0] == XmlTagName::k_EnumerationResults
-                && std::strcmp(node.Name, "ContainerName") == 0)
+            else if (std::strcmp(node.Name, "ContainerName") == 0)
             {
               ret.Container = node.Value;
             }
@@ -2312,7 +2352,113 @@ namespace Azure { namespace Storage { namespace Blobs {
           k_Metadata,
           k_Unknown,
         };
-        std::vector<XmlTagName> path;
+        // A name is told apart from the others by its hash and confirmed with one comparison.
+        auto tagOf = [](const char* name) {
+          XmlTagName tag = XmlTagName::k_Unknown;
+          const char* tagName = "";
+          switch (XmlNameHash(name))
+          {
+            case XmlNameHash("Name"):
+              tag = XmlTagName::k_Name;
+              tagName = "Name";
+              break;
+            case XmlNameHash("Deleted"):
+              tag = XmlTagName::k_Deleted;
+              tagName = "Deleted";
+              break;
+            case XmlNameHash("Snapshot"):
+              tag = XmlTagName::k_Snapshot;
+              tagName = "Snapshot";
+              break;
+            case XmlNameHash("Properties"):
+              tag = XmlTagName::k_Properties;
+              tagName = "Properties";
+              break;
+            case XmlNameHash("Content-Type"):
+              tag = XmlTagName::k_ContentType;
+              tagName = "Content-Type";
+              break;
+            case XmlNameHash("Content-Encoding"):
+              tag = XmlTagName::k_ContentEncoding;
+              tagName = "Content-Encoding";
+              break;
+            case XmlNameHash("Content-Language"):
+              tag = XmlTagName::k_ContentLanguage;
+              tagName = "Content-Language";
+              break;
+            case XmlNameHash("Content-MD5"):
+              tag = XmlTagName::k_ContentMD5;
+              tagName = "Content-MD5";
+              break;
+            case XmlNameHash("Cache-Control"):
+              tag = XmlTagName::k_CacheControl;
+              tagName = "Cache-Control";
+              break;
+            case XmlNameHash("Content-Disposition"):
+              tag = XmlTagName::k_ContentDisposition;
+              tagName = "Content-Disposition";
+              break;
+            case XmlNameHash("Creation-Time"):
+              tag = XmlTagName::k_CreationTime;
+              tagName = "Creation-Time";
+              break;
+            case XmlNameHash("Last-Modified"):
+              tag = XmlTagName::k_LastModified;
+              tagName = "Last-Modified";
+              break;
+            case XmlNameHash("Etag"):
+              tag = XmlTagName::k_Etag;
+              tagName = "Etag";
+              break;
+            case XmlNameHash("Content-Length"):
+              tag = XmlTagName::k_ContentLength;
+              tagName = "Content-Length";
+              break;
+            case XmlNameHash("BlobType"):
+              tag = XmlTagName::k_BlobType;
+              tagName = "BlobType";
+              break;
+            case XmlNameHash("AccessTier"):
+              tag = XmlTagName::k_AccessTier;
+              tagName = "AccessTier";
+              break;
+            case XmlNameHash("AccessTierInferred"):
+              tag = XmlTagName::k_AccessTierInferred;
+              tagName = "AccessTierInferred";
+              break;
+            case XmlNameHash("LeaseStatus"):
+              tag = XmlTagName::k_LeaseStatus;
+              tagName = "LeaseStatus";
+              break;
+            case XmlNameHash("LeaseState"):
+              tag = XmlTagName::k_LeaseState;
+              tagName = "LeaseState";
+              break;
+            case XmlNameHash("LeaseDuration"):
+              tag = XmlTagName::k_LeaseDuration;
+              tagName = "LeaseDuration";
+              break;
+            case XmlNameHash("ServerEncrypted"):
+              tag = XmlTagName::k_ServerEncrypted;
+              tagName = "ServerEncrypted";
+              break;
+            case XmlNameHash("EncryptionKeySHA256"):
+              tag = XmlTagName::k_EncryptionKeySHA256;
+              tagName = "EncryptionKeySHA256";
+              break;
+            case XmlNameHash("Metadata"):
+              tag = XmlTagName::k_Metadata;
+              tagName = "Metadata";
+              break;
+            default:
+              break;
+          }
+          return std::strcmp(name, tagName) == 0 ? tag : XmlTagName::k_Unknown;
+        };
+        // Only the elements of Blob and of Blob/Properties are read, so the elements open at the
+        // first two levels are all there is to keep track of.
+        int depth = 0;
+        XmlTagName tags[2] = {XmlTagName::k_Unknown, XmlTagName::k_Unknown};
         while (true)
         {
           auto node = reader.Read();
@@ -2322,240 +2468,110 @@ namespace Azure { namespace Storage { namespace Blobs {
           }
           else if (node.Type == XmlNodeType::EndTag)
           {
-            if (path.size() > 0)
-            {
-              path.pop_back();
-            }
-            else
+            if (depth == 0)
             {
               break;
             }
+            --depth;
           }
           else if (node.Type == XmlNodeType::StartTag)
           {
-            if (std::strcmp(node.Name, "Name") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Name);
-            }
-            else if (std::strcmp(node.Name, "Deleted") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Deleted);
-            }
-            else if (std::strcmp(node.Name, "Snapshot") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Snapshot);
-            }
-            else if (std::strcmp(node.Name, "Properties") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Properties);
-            }
-            else if (std::strcmp(node.Name, "Content-Type") == 0)
-            {
-              path.emplace_back(XmlTagName::k_ContentType);
-            }
-            else if (std::strcmp(node.Name, "Content-Encoding") == 0)
-            {
-              path.emplace_back(XmlTagName::k_ContentEncoding);
-            }
-            else if (std::strcmp(node.Name, "Content-Language") == 0)
-            {
-              path.emplace_back(XmlTagName::k_ContentLanguage);
-            }
-            else if (std::strcmp(node.Name, "Content-MD5") == 0)
-            {
-              path.emplace_back(XmlTagName::k_ContentMD5);
-            }
-            else if (std::strcmp(node.Name, "Cache-Control") == 0)
-            {
-              path.emplace_back(XmlTagName::k_CacheControl);
-            }
-            else if (std::strcmp(node.Name, "Content-Disposition") == 0)
-            {
-              path.emplace_back(XmlTagName::k_ContentDisposition);
-            }
-            else if (std::strcmp(node.Name, "Creation-Time") == 0)
-            {
-              path.emplace_back(XmlTagName::k_CreationTime);
-            }
-            else if (std::strcmp(node.Name, "Last-Modified") == 0)
-            {
-              path.emplace_back(XmlTagName::k_LastModified);
-            }
-            else if (std::strcmp(node.Name, "Etag") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Etag);
-            }
-            else if (std::strcmp(node.Name, "Content-Length") == 0)
-            {
-              path.emplace_back(XmlTagName::k_ContentLength);
-            }
-            else if (std::strcmp(node.Name, "BlobType") == 0)
-            {
-              path.emplace_back(XmlTagName::k_BlobType);
-            }
-            else if (std::strcmp(node.Name, "AccessTier") == 0)
-            {
-              path.emplace_back(XmlTagName::k_AccessTier);
-            }
-            else if (std::strcmp(node.Name, "AccessTierInferred") == 0)
-            {
-              path.emplace_back(XmlTagName::k_AccessTierInferred);
-            }
-            else if (std::strcmp(node.Name, "LeaseStatus") == 0)
-            {
-              path.emplace_back(XmlTagName::k_LeaseStatus);
-            }
-            else if (std::strcmp(node.Name, "LeaseState") == 0)
-            {
-              path.emplace_back(XmlTagName::k_LeaseState);
-            }
-            else if (std::strcmp(node.Name, "LeaseDuration") == 0)
-            {
-              path.emplace_back(XmlTagName::k_LeaseDuration);
-            }
-            else if (std::strcmp(node.Name, "ServerEncrypted") == 0)
-            {
-              path.emplace_back(XmlTagName::k_ServerEncrypted);
-            }
-            else if (std::strcmp(node.Name, "EncryptionKeySHA256") == 0)
-            {
-              path.emplace_back(XmlTagName::k_EncryptionKeySHA256);
-            }
-            else if (std::strcmp(node.Name, "Metadata") == 0)
-            {
-              path.emplace_back(XmlTagName::k_Metadata);
-            }
-            else
+            ++depth;
+            if (depth == 1)
             {
-              path.emplace_back(XmlTagName::k_Unknown);
+              tags[0] = tagOf(node.Name);
+              if (tags[0] == XmlTagName::k_Metadata)
+              {
+                ret.Metadata = MetadataFromXml(reader);
+                --depth;
+              }
             }
-            if (path.size() == 1 && path[0] == XmlTagName::k_Metadata)
+            else if (depth == 2)
             {
-              ret.Metadata = MetadataFromXml(reader);
-              path.pop_back();
+              tags[1] = tags[0] == XmlTagName::k_Properties ? tagOf(node.Name)
+                                                            : XmlTagName::k_Unknown;
             }
           }
           else if (node.Type == XmlNodeType::Text)
           {
-            if (path.size() == 1 && path[0] == XmlTagName::k_Name)
-            {
-              ret.Name = node.Value;
-            }
-            else if (path.size() == 1 && path[0] == XmlTagName::k_Deleted)
-            {
-              ret.Deleted = std::strcmp(node.Value, "true") == 0;
-            }
-            else if (path.size() == 1 && path[0] == XmlTagName::k_Snapshot)
-            {
-              ret.Snapshot = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_ContentType)
-            {
-              ret.HttpHeaders.ContentType = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_ContentEncoding)
-            {
-              ret.HttpHeaders.ContentEncoding = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_ContentLanguage)
-            {
-              ret.HttpHeaders.ContentLanguage = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_ContentMD5)
-            {
-              ret.HttpHeaders.ContentMD5 = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_CacheControl)
-            {
-              ret.HttpHeaders.CacheControl = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_ContentDisposition)
-            {
-              ret.HttpHeaders.ContentDisposition = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_CreationTime)
-            {
-              ret.CreationTime = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_LastModified)
-            {
-              ret.LastModified = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_Etag)
-            {
-              ret.ETag = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_ContentLength)
-            {
-              ret.ContentLength = std::stoll(node.Value);
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_BlobType)
-            {
-              ret.BlobType = BlobTypeFromString(node.Value);
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_AccessTier)
-            {
-              ret.Tier = AccessTierFromString(node.Value);
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_AccessTierInferred)
-            {
-              ret.AccessTierInferred = std::strcmp(node.Value, "true") == 0;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_LeaseStatus)
-            {
-              ret.LeaseStatus = BlobLeaseStatusFromString(node.Value);
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_LeaseState)
-            {
-              ret.LeaseState = BlobLeaseStateFromString(node.Value);
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_LeaseDuration)
-            {
-              ret.LeaseDuration = node.Value;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_ServerEncrypted)
-            {
-              ret.ServerEncrypted = std::strcmp(node.Value, "true") == 0;
-            }
-            else if (
-                path.size() == 2 && path[0] == XmlTagName::k_Properties
-                && path[1] == XmlTagName::k_EncryptionKeySHA256)
-            {
-              ret.EncryptionKeySHA256 = node.Value;
+            if (depth == 1)
+            {
+              switch (tags[0])
+              {
+                case XmlTagName::k_Name:
+                  ret.Name = node.Value;
+                  break;
+                case XmlTagName::k_Deleted:
+                  ret.Deleted = std::strcmp(node.Value, "true") == 0;
+                  break;
+                case XmlTagName::k_Snapshot:
+                  ret.Snapshot = node.Value;
+                  break;
+                default:
+                  break;
+              }
+            }
+            else if (depth == 2)
+            {
+              switch (tags[1])
+              {
+                case XmlTagName::k_ContentType:
+                  ret.HttpHeaders.ContentType = node.Value;
+                  break;
+                case XmlTagName::k_ContentEncoding:
+                  ret.HttpHeaders.ContentEncoding = node.Value;
+                  break;
+                case XmlTagName::k_ContentLanguage:
+                  ret.HttpHeaders.ContentLanguage = node.Value;
+                  break;
+                case XmlTagName::k_ContentMD5:
+                  ret.HttpHeaders.ContentMD5 = node.Value;
+                  break;
+                case XmlTagName::k_CacheControl:
+                  ret.HttpHeaders.CacheControl = node.Value;
+                  break;
+                case XmlTagName::k_ContentDisposition:
+                  ret.HttpHeaders.ContentDisposition = node.Value;
+                  break;
+                case XmlTagName::k_CreationTime:
+                  ret.CreationTime = node.Value;
+                  break;
+                case XmlTagName::k_LastModified:
+                  ret.LastModified = node.Value;
+                  break;
+                case XmlTagName::k_Etag:
+                  ret.ETag = node.Value;
+                  break;
+                case XmlTagName::k_ContentLength:
+                  ret.ContentLength = std::stoll(node.Value);
+                  break;
+                case XmlTagName::k_BlobType:
+                  ret.BlobType = BlobTypeFromString(node.Value);
+                  break;
+                case XmlTagName::k_AccessTier:
+                  ret.Tier = AccessTierFromString(node.Value);
+                  break;
+                case XmlTagName::k_AccessTierInferred:
+                  ret.AccessTierInferred = std::strcmp(node.Value, "true") == 0;
+                  break;
+                case XmlTagName::k_LeaseStatus:
+                  ret.LeaseStatus = BlobLeaseStatusFromString(node.Value);
+                  break;
+                case XmlTagName::k_LeaseState:
+                  ret.LeaseState = BlobLeaseStateFromString(node.Value);
+                  break;
+                case XmlTagName::k_LeaseDuration:
+                  ret.LeaseDuration = node.Value;
+                  break;
+                case XmlTagName::k_ServerEncrypted:
+                  ret.ServerEncrypted = std::strcmp(node.Value, "true") == 0;
+                  break;
+                case XmlTagName::k_EncryptionKeySHA256:
+                  ret.EncryptionKeySHA256 = node.Value;
+                  break;
+                default:
+                  break;
+              }
             }
           }
         }
@@ -2604,6 +2620,8 @@ namespace Azure { namespace Storage { namespace Blobs {
       {
         Azure::Core::Nullable<int32_t> Timeout;
         Azure::Core::Nullable<std::pair<int64_t, int64_t>> Range;
+        Azure::Core::Nullable<bool> RangeGetContentMD5;
+        Azure::Core::Nullable<bool> RangeGetContentCRC64;
         Azure::Core::Nullable<std::string> EncryptionKey;
         Azure::Core::Nullable<std::string> EncryptionKeySHA256;
         Azure::Core::Nullable<std::string> EncryptionAlgorithm;
@@ -2642,6 +2660,18 @@ namespace Azure { namespace Storage { namespace Blobs {
             request.AddHeader("x-ms-range", "bytes=" + std::to_string(startOffset) + "-");
           }
         }
+        if (options.RangeGetContentMD5.HasValue())
+        {
+          request.AddHeader(
+              "x-ms-range-get-content-md5",
+              options.RangeGetContentMD5.GetValue() ? "true" : "false");
+        }
+        if (options.RangeGetContentCRC64.HasValue())
+        {
+          request.AddHeader(
+              "x-ms-range-get-content-crc64",
+              options.RangeGetContentCRC64.GetValue() ? "true" : "false");
+        }
         if (options.EncryptionKey.HasValue())
         {
           request.AddHeader("x-ms-encryption-key", options.EncryptionKey.GetValue());
@@ -4350,18 +4380,10 @@ namespace Azure { namespace Storage { namespace Blobs {
           BodyStreamPointer& body,
           const CommitBlockListOptions& options)
       {
-        std::string xml_body;
-        {
-          XmlWriter writer;
-          CommitBlockListOptionsToXml(writer, options);
-          xml_body = writer.GetDocument();
-        }
-        std::shared_ptr<std::string> xml_body_ptr
-            = std::make_shared<std::string>(std::move(xml_body));
+        // Up to 50000 block IDs are serialized while the body is sent, options has to outlive it.
         body = BodyStreamPointer(
-            new Azure::Core::Http::MemoryBodyStream(
-                reinterpret_cast<const uint8_t*>(xml_body_ptr->data()), xml_body_ptr->length()),
-            [xml_body_ptr](Azure::Core::Http::BodyStream* bodyStream) { delete bodyStream; });
+            CommitBlockListOptionsToXmlStream(options).release(),
+            [](Azure::Core::Http::BodyStream* bodyStream) { delete bodyStream; });
         auto request
             = Azure::Core::Http::Request(Azure::Core::Http::HttpMethod::Put, url, body.get());
         request.AddHeader("Content-Length", std::to_string(body->Length()));
@@ -4728,18 +4750,27 @@ namespace Azure { namespace Storage { namespace Blobs {
         return ret;
       }
 
-      static void CommitBlockListOptionsToXml(
-          XmlWriter& writer,
+      static std::unique_ptr<XmlListBodyStream> CommitBlockListOptionsToXmlStream(
           const CommitBlockListOptions& options)
       {
-        writer.Write(XmlNode{XmlNodeType::StartTag, "BlockList"});
-        for (const auto& i : options.BlockList)
-        {
-          writer.Write(
-              XmlNode{XmlNodeType::StartTag, BlockTypeToString(i.first).data(), i.second.data()});
-        }
-        writer.Write(XmlNode{XmlNodeType::EndTag});
-        writer.Write(XmlNode{XmlNodeType::End});
+        const auto& blockList = options.BlockList;
+        return std::make_unique<XmlListBodyStream>(
+            "BlockList", blockList.size(), [&blockList](std::size_t index) {
+              const char* name = "";
+              switch (blockList[index].first)
+              {
+                case BlockType::Committed:
+                  name = "Committed";
+                  break;
+                case BlockType::Uncommitted:
+                  name = "Uncommitted";
+                  break;
+                case BlockType::Latest:
+                  name = "Latest";
+                  break;
+              }
+              return XmlNode{XmlNodeType::StartTag, name, blockList[index].second.data()};
+            });
       }
 
     }; // class BlockBlob
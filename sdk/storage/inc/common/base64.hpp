@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Azure { namespace Storage {
+
+  std::string Base64Encode(const std::string& text);
+
+  // Throws std::runtime_error if text isn't padded Base64 with the standard alphabet.
+  std::string Base64Decode(const std::string& text);
+
+  constexpr std::size_t Base64EncodedLength(std::size_t length) { return (length + 2) / 3 * 4; }
+
+  // Upper bound, the actual length is up to two bytes shorter depending on the padding.
+  constexpr std::size_t Base64DecodedMaxLength(std::size_t length) { return length / 4 * 3; }
+
+  // Writes Base64EncodedLength(length) characters to output, without a terminating null.
+  void Base64Encode(const uint8_t* data, std::size_t length, char* output);
+
+  // Writes at most Base64DecodedMaxLength(length) bytes to output and returns how many were
+  // written. output may be the same buffer as text, to decode in place. Throws std::runtime_error
+  // if text isn't padded Base64 with the standard alphabet, the content of output is unspecified
+  // then.
+  std::size_t Base64Decode(const char* text, std::size_t length, uint8_t* output);
+
+}} // namespace Azure::Storage
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "context.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  /**
+   * @brief A bounded pool of equally sized, aligned staging buffers.
+   *
+   * Buffers are allocated lazily and reused once released. Acquire blocks while all buffers are in
+   * use, which applies backpressure to whoever fills them.
+   */
+  class AlignedBufferPool {
+  public:
+    // A buffer borrowed from the pool, returned to the pool on destruction.
+    class Buffer {
+    public:
+      Buffer(Buffer&& other) noexcept
+          : m_pool(other.m_pool), m_data(other.m_data), m_index(other.m_index)
+      {
+        other.m_pool = nullptr;
+        other.m_data = nullptr;
+      }
+
+      ~Buffer()
+      {
+        if (m_pool)
+        {
+          m_pool->Release(m_index);
+        }
+      }
+
+      Buffer(const Buffer&) = delete;
+      Buffer& operator=(const Buffer&) = delete;
+      Buffer& operator=(Buffer&&) = delete;
+
+      uint8_t* Data() const { return m_data; }
+
+      int64_t Size() const { return m_pool->GetBufferSize(); }
+
+      // Position of the buffer in the list returned by AlignedBufferPool::AllocateAll.
+      std::size_t Index() const { return m_index; }
+
+    private:
+      Buffer(AlignedBufferPool* pool, uint8_t* data, std::size_t index)
+          : m_pool(pool), m_data(data), m_index(index)
+      {
+      }
+
+      AlignedBufferPool* m_pool;
+      uint8_t* m_data;
+      std::size_t m_index;
+
+      friend class AlignedBufferPool;
+    };
+
+    static constexpr std::size_t DefaultAlignment = 4096;
+
+    // bufferSize is rounded up to a multiple of alignment.
+    AlignedBufferPool(
+        int64_t bufferSize,
+        int64_t maxBuffers,
+        std::size_t alignment = DefaultAlignment);
+
+    // All buffers must have been returned.
+    ~AlignedBufferPool();
+
+    AlignedBufferPool(const AlignedBufferPool&) = delete;
+    AlignedBufferPool& operator=(const AlignedBufferPool&) = delete;
+
+    // Blocks until a buffer is available, throws if context is cancelled while waiting.
+    Buffer Acquire(Azure::Core::Context& context);
+
+    int64_t GetBufferSize() const { return m_bufferSize; }
+
+    std::size_t GetAlignment() const { return m_alignment; }
+
+    int64_t GetMaximumBuffers() const { return m_maxBuffers; }
+
+    // Number of buffers allocated so far.
+    int64_t GetAllocatedBuffers();
+
+    // Allocates all buffers up front, for callers that register them with the kernel. Returns every
+    // buffer of the pool, buffer i has Index() i.
+    std::vector<uint8_t*> AllocateAll();
+
+  private:
+    void Release(std::size_t index);
+
+    int64_t m_bufferSize;
+    int64_t m_maxBuffers;
+    std::size_t m_alignment;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<uint8_t*> m_allBuffers;
+    // Indices into m_allBuffers.
+    std::vector<std::size_t> m_freeBuffers;
+  };
+
+}}} // namespace Azure::Storage::Details
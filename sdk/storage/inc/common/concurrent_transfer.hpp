@@ -3,68 +3,63 @@
 
 #pragma once
 
-#include <atomic>
-#include <cstdlib>
+#include "context.hpp"
+#include "http/body_stream.hpp"
+
+#include <cstdint>
 #include <functional>
-#include <future>
 
 namespace Azure { namespace Storage { namespace Details {
 
-  inline void ConcurrentTransfer(
+  class TransferAutoTuner;
+
+  // Splits [offset, offset + length) into chunks and runs transferFunc on them with up to
+  // concurrency workers. The calling thread is one of the workers, the others are tasks on the
+  // process-wide transfer thread pool.
+  // A chunk that fails with a transport error or a 408, 500, 502, 503 or 504 from the service is
+  // tried again up to 3 times after a jittered, exponentially growing delay. Once a chunk fails for
+  // good or context is cancelled, no new chunk is started, the context passed to transferFunc is
+  // cancelled so that the chunks in flight stop as well, and the first exception is rethrown to
+  // the caller. transferFunc must use that context for its requests.
+  // Every chunk is admitted by the default TransferGovernor first, chunkBufferSize is the size of
+  // the staging buffer transferFunc allocates for a chunk, if any.
+  void ConcurrentTransfer(
+      Azure::Core::Context context,
       int64_t offset,
       int64_t length,
       int64_t chunkSize,
       int concurrency,
-      // offset, length, chunk id, number of chunks
-      std::function<void(int64_t, int64_t, int64_t, int64_t)> transferFunc)
-  {
-    std::atomic<int> numWorkingThreads{concurrency};
-    std::atomic<int> nextChunkId{0};
-    std::atomic<bool> failed{false};
-
-    const auto numChunks = (length + chunkSize - 1) / chunkSize;
-
-    auto threadFunc = [&]() {
-      while (true)
-      {
-        int chunkId = nextChunkId.fetch_add(1);
-        if (chunkId >= numChunks || failed)
-        {
-          break;
-        }
-        int64_t chunkOffset = offset + chunkSize * chunkId;
-        int64_t chunkLength = std::min(length - chunkSize * chunkId, chunkSize);
-        try
-        {
-          transferFunc(chunkOffset, chunkLength, chunkId, numChunks);
-        }
-        catch (std::exception&)
-        {
-          if (failed.exchange(true) == false)
-          {
-            numWorkingThreads.fetch_sub(1);
-            throw;
-          }
-        }
-      }
-      numWorkingThreads.fetch_sub(1);
-    };
+      // context, offset, length, chunk id, number of chunks
+      std::function<void(Azure::Core::Context&, int64_t, int64_t, int64_t, int64_t)> transferFunc,
+      int64_t chunkBufferSize = 0);
 
-    std::vector<std::future<void>> threadHandles;
-    for (int i = 0; i < concurrency - 1; ++i)
-    {
-      threadHandles.emplace_back(std::async(std::launch::async, threadFunc));
-    }
-    threadFunc();
-    for (auto& handle : threadHandles)
-    {
-      handle.get();
-    }
+  // Same as ConcurrentTransfer, but chunk size and the number of workers follow tuner as the
+  // transfer goes. Chunks are made large enough for [offset, offset + length) to fit in
+  // maxNumChunks chunks. Returns the number of chunks, chunk ids are contiguous from 0.
+  int64_t AdaptiveConcurrentTransfer(
+      Azure::Core::Context context,
+      int64_t offset,
+      int64_t length,
+      int64_t maxNumChunks,
+      TransferAutoTuner& tuner,
+      // context, offset, length, chunk id
+      std::function<void(Azure::Core::Context&, int64_t, int64_t, int64_t)> transferFunc,
+      int64_t chunkBufferSize = 0);
 
-    if (numWorkingThreads != 0)
-    {
-      std::abort();
-    }
-  }
+  // Reads content to the end on the calling thread, cuts it into chunks of chunkSize bytes and runs
+  // transferFunc on up to concurrency filled chunks at once on the transfer thread pool. The chunks
+  // live in a pool of concurrency buffers, so memory stays bounded however long content is, and
+  // reading waits while all of them are in flight. Only the last chunk may be shorter. Chunks are
+  // retried and cancelled like in ConcurrentTransfer. Stops reading once a chunk fails or context
+  // is cancelled and rethrows the first exception. Throws if content has more than maxNumChunks
+  // chunks. Returns the number of chunks, chunk ids are contiguous from 0.
+  int64_t StreamingConcurrentTransfer(
+      Azure::Core::Context context,
+      Azure::Core::Http::BodyStream& content,
+      int64_t chunkSize,
+      int concurrency,
+      int64_t maxNumChunks,
+      // context, data, length, chunk id
+      std::function<void(Azure::Core::Context&, const uint8_t*, int64_t, int64_t)> transferFunc);
 
 }}} // namespace Azure::Storage::Details
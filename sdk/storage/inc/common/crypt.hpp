@@ -3,14 +3,86 @@
 
 #pragma once
 
+#include "common/base64.hpp"
+
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace Azure { namespace Storage {
 
   std::string HMAC_SHA256(const std::string& text, const std::string& key);
-  std::string Base64Encode(const std::string& text);
-  std::string Base64Decode(const std::string& text);
   std::string MD5(const std::string& text);
   std::string CRC64(const std::string& text);
 
+  // Streaming MD5. Unlike CRC64, MD5 hashes of separate chunks can't be combined into the hash of
+  // the whole content, so the data has to be passed in order.
+  class Md5 {
+  public:
+    Md5();
+    ~Md5();
+
+    Md5(const Md5&) = delete;
+    Md5& operator=(const Md5&) = delete;
+
+    void Update(const uint8_t* data, std::size_t length);
+
+    // Returns the 16 byte digest. The object can't be updated afterwards.
+    std::string Digest();
+
+  private:
+    void* m_context;
+  };
+
+  class Sha256 {
+  public:
+    Sha256();
+    ~Sha256();
+
+    Sha256(const Sha256&) = delete;
+    Sha256& operator=(const Sha256&) = delete;
+
+    void Update(const uint8_t* data, std::size_t length);
+
+    // Returns the 32 byte digest. The object can't be updated afterwards.
+    std::string Digest();
+
+  private:
+    void* m_context;
+  };
+
+  // HMAC-SHA256 with the key schedule computed once, for signing many strings with the same key.
+  // Sign can be called from several threads at once.
+  class HmacSha256 {
+  public:
+    explicit HmacSha256(const std::string& key);
+    ~HmacSha256();
+
+    HmacSha256(const HmacSha256&) = delete;
+    HmacSha256& operator=(const HmacSha256&) = delete;
+
+    std::string Sign(const std::string& text) const;
+
+  private:
+    void* m_innerContext;
+    void* m_outerContext;
+  };
+
+  // Streaming CRC64 with the polynomial used by Azure Storage.
+  class Crc64 {
+  public:
+    void Update(const uint8_t* data, std::size_t length);
+
+    // Appends the data passed to other, so chunks can be checksummed in parallel and combined in
+    // order afterwards.
+    void Concatenate(const Crc64& other);
+
+    // Returns the 8 byte checksum, as sent in x-ms-content-crc64 once Base64 encoded.
+    std::string Digest() const;
+
+  private:
+    uint64_t m_context = 0;
+    uint64_t m_length = 0;
+  };
+
 }} // namespace Azure::Storage
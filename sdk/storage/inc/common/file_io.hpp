@@ -7,8 +7,19 @@
 #include <Windows.h>
 #endif
 
+#include "common/buffer_pool.hpp"
+
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace Azure { namespace Storage { namespace Details {
 
@@ -28,23 +39,171 @@ namespace Azure { namespace Storage { namespace Details {
 
     int64_t GetFileSize() const { return m_fileSize; }
 
+    // Last modification time of the file when it was opened, in platform specific units. Only
+    // meant to be compared with an earlier value to tell whether the file was modified.
+    int64_t GetLastModifiedTime() const { return m_lastModifiedTime; }
+
   private:
     FileHandle m_handle;
     int64_t m_fileSize;
+    int64_t m_lastModifiedTime;
+  };
+
+  // Shared read-only mapping of a whole file, so that its contents can be sent without copying
+  // them into intermediate buffers. Any number of threads can read from one mapping. The file must
+  // not be truncated while mapped.
+  class MemoryMappedFile {
+  public:
+    // Throws if the file can't be mapped, empty files for example. fileReader must outlive the
+    // mapping.
+    explicit MemoryMappedFile(const FileReader& fileReader);
+
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    const uint8_t* Data() const { return m_data; }
+
+    int64_t Size() const { return m_size; }
+
+  private:
+    const uint8_t* m_data;
+    int64_t m_size;
+#ifdef _WIN32
+    HANDLE m_mapping;
+#endif
   };
 
   class FileWriter {
   public:
-    FileWriter(const std::string& filename);
+    // Alignment of buffer, offset and length for a write to bypass the page cache.
+    static constexpr int64_t DirectIoAlignment = 4096;
+
+    // With directIo, writes that meet the alignment requirements bypass the page cache if the
+    // platform and file system support it. Without truncate, the contents of an existing file are
+    // kept, so that a transfer can pick up where an earlier one stopped.
+    FileWriter(const std::string& filename, bool directIo = false, bool truncate = true);
 
     ~FileWriter();
 
     FileHandle GetHandle() const { return m_handle; }
 
+    // Returns the handle a write of length bytes from buffer at offset should go through.
+    FileHandle GetHandle(const uint8_t* buffer, int64_t length, int64_t offset) const;
+
+    bool IsDirectIo() const;
+
     void Write(const uint8_t* buffer, int64_t length, int64_t offset);
 
+    // Reserves disk space for size bytes. Does nothing where the file system doesn't support it.
+    void Preallocate(int64_t size);
+
+    // Evicts [offset, offset + length) from the page cache after flushing it to disk. Does nothing
+    // where not supported.
+    void DropCache(int64_t offset, int64_t length);
+
   private:
     FileHandle m_handle;
+    FileHandle m_directHandle;
+  };
+
+  struct FileIoRequest
+  {
+    bool IsWrite = false;
+    FileHandle Handle;
+    uint8_t* Buffer = nullptr;
+    int64_t Length = 0;
+    int64_t Offset = 0;
+    // Index of a buffer registered with FileIoEngine::RegisterBuffers, or -1.
+    int BufferIndex = -1;
+    // Set by FileIoEngine::Run. Reads may come back short at the end of the file.
+    int64_t BytesTransferred = 0;
+  };
+
+  // Runs batches of positional reads and writes. The engine is backed by io_uring when the library
+  // is built with BUILD_STORAGE_IO_URING and the kernel lets us set up a ring, and by
+  // pread/pwrite otherwise, or once the ring fails. An engine is meant to be used by one thread at
+  // a time.
+  class FileIoEngine {
+  public:
+    explicit FileIoEngine(unsigned queueDepth = 64);
+
+    ~FileIoEngine();
+
+    FileIoEngine(const FileIoEngine&) = delete;
+    FileIoEngine& operator=(const FileIoEngine&) = delete;
+
+    bool IsIoUring() const { return m_ring != nullptr; }
+
+    // Registers buffers with the kernel so requests can refer to them by index and skip mapping
+    // them on every call. Returns false if fixed buffers aren't available, requests must then
+    // leave BufferIndex at -1. Can be called once per engine.
+    bool RegisterBuffers(const std::vector<std::pair<uint8_t*, int64_t>>& buffers);
+
+    // Returns once all requests completed. Throws if any of them failed.
+    void Run(std::vector<FileIoRequest>& requests);
+
+  private:
+    struct IoUring;
+    std::unique_ptr<IoUring> m_ring;
+  };
+
+  // Writes staging buffers to a file on a dedicated thread, so that the threads filling the
+  // buffers from the network don't wait on the disk. The number of queued writes is bounded by
+  // the pool the buffers come from. Writes queued while one batch is in progress go to disk
+  // together in the next batch.
+  class FileWriteStage {
+  public:
+    // If bufferPool is given and io_uring is in use, all buffers of the pool are allocated and
+    // registered up front. With dropCache, written ranges are evicted from the page cache.
+    explicit FileWriteStage(
+        FileWriter& fileWriter,
+        AlignedBufferPool* bufferPool = nullptr,
+        bool dropCache = false);
+
+    // Waits for queued writes, errors are dropped.
+    ~FileWriteStage();
+
+    FileWriteStage(const FileWriteStage&) = delete;
+    FileWriteStage& operator=(const FileWriteStage&) = delete;
+
+    // Queues the first length bytes of buffer to be written at offset. The buffer goes back to its
+    // pool once written. Throws if an earlier write failed.
+    void Write(AlignedBufferPool::Buffer buffer, int64_t length, int64_t offset);
+
+    // Calls written on the writer thread once all writes queued so far are on disk, or right away
+    // if there are none. Not called if a write fails. Throws if an earlier write failed.
+    void WhenWritten(std::function<void()> written);
+
+    // Waits for queued writes and rethrows the first write error.
+    void Flush();
+
+  private:
+    struct PendingWrite
+    {
+      AlignedBufferPool::Buffer Buffer;
+      int64_t Length;
+      int64_t Offset;
+    };
+
+    void WriterFunc();
+
+    FileWriter& m_fileWriter;
+    FileIoEngine m_engine;
+    bool m_buffersRegistered = false;
+    bool m_dropCache;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<PendingWrite> m_queue;
+    // Writes are counted as they are queued and as they complete, batches complete in order.
+    uint64_t m_numQueued = 0;
+    uint64_t m_numWritten = 0;
+    std::deque<std::pair<uint64_t, std::function<void()>>> m_writtenCallbacks;
+    bool m_writing = false;
+    bool m_stop = false;
+    std::exception_ptr m_exception;
+    std::thread m_thread;
   };
 
 }}} // namespace Azure::Storage::Details
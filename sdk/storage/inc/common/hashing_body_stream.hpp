@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "common/crypt.hpp"
+#include "http/body_stream.hpp"
+#include "nullable.hpp"
+
+#include <memory>
+#include <string>
+
+namespace Azure { namespace Storage {
+
+  /**
+   * @brief Hashes the bytes that are read through it, so that content is hashed while it is sent or
+   * received instead of in a pass of its own.
+   *
+   * Rewind starts the hashes over, so after a retried request they cover what was sent last.
+   */
+  class HashingBodyStream : public Azure::Core::Http::BodyStream {
+  public:
+    HashingBodyStream(
+        Azure::Core::Http::BodyStream* inner,
+        bool md5,
+        bool crc64,
+        bool sha256 = false);
+
+    HashingBodyStream(
+        std::unique_ptr<Azure::Core::Http::BodyStream> inner,
+        bool md5,
+        bool crc64,
+        bool sha256 = false);
+
+    int64_t Length() const override { return m_inner->Length(); }
+
+    void Rewind() override;
+
+    int64_t Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count) override;
+
+    const uint8_t* ReadContiguous(Azure::Core::Context& context, int64_t count, int64_t* bytesRead)
+        override;
+
+    // Whether the stream has been read to the end, the digests are available from then on.
+    bool IsComplete() const { return m_complete; }
+
+    // Digests of the content, throw if the stream hasn't been read to the end or the hash wasn't
+    // requested.
+    const std::string& GetMd5() const;
+    const std::string& GetCrc64() const;
+    const std::string& GetSha256() const;
+
+    // Makes the read that reaches the end of the stream throw if the content doesn't match the
+    // expected hashes, which are Base64 encoded like in the Content-MD5 and x-ms-content-crc64
+    // headers. Missing hashes aren't checked. Verifies right away if the end was already reached.
+    void VerifyOnCompletion(
+        Azure::Core::Nullable<std::string> md5,
+        Azure::Core::Nullable<std::string> crc64);
+
+    // Throws if the content doesn't match the hashes the service returned. Hashes the service
+    // didn't return aren't checked.
+    void Verify(
+        const Azure::Core::Nullable<std::string>& md5,
+        const Azure::Core::Nullable<std::string>& crc64) const;
+
+  private:
+    void Reset();
+    void Update(const uint8_t* data, int64_t length);
+    void Complete();
+
+    std::unique_ptr<Azure::Core::Http::BodyStream> m_ownedInner;
+    Azure::Core::Http::BodyStream* m_inner;
+    bool m_computeMd5;
+    bool m_computeCrc64;
+    bool m_computeSha256;
+
+    std::unique_ptr<Md5> m_md5;
+    Crc64 m_crc64;
+    std::unique_ptr<Sha256> m_sha256;
+    int64_t m_bytesRead = 0;
+    bool m_complete = false;
+    std::string m_md5Digest;
+    std::string m_crc64Digest;
+    std::string m_sha256Digest;
+
+    Azure::Core::Nullable<std::string> m_expectedMd5;
+    Azure::Core::Nullable<std::string> m_expectedCrc64;
+  };
+
+}} // namespace Azure::Storage
@@ -0,0 +1,273 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "common/thread_pool.hpp"
+#include "context.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Azure { namespace Storage {
+
+  /**
+   * @brief The items of a paged listing, walked page by page or item by item. Up to a prefetch
+   * depth of pages following the page being consumed are fetched in the background on the
+   * transfer thread pool, so the next page is usually there when the caller gets to it. Pages are
+   * fetched one after the other, the marker of a page is only known once the page before it
+   * arrived.
+   *
+   * An error of a fetch is thrown to the caller when it gets to the page that failed. Fetches in
+   * flight when the range is destroyed are cancelled through their context.
+   */
+  template <class Item> class PagedRange {
+  public:
+    /**
+     * @brief Fetches the page starting at marker, empty for the first page, and sets nextMarker
+     * to the marker of the page after it, empty after the last page.
+     */
+    using FetchPageFunc = std::function<std::vector<Item>(
+        Azure::Core::Context& context,
+        const std::string& marker,
+        std::string& nextMarker)>;
+
+    /**
+     * @brief An input iterator over the items of a PagedRange. Advancing past the last item of a
+     * page waits for the next page.
+     */
+    class Iterator {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = Item;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const Item*;
+      using reference = const Item&;
+
+      Iterator() = default;
+
+      reference operator*() const { return m_range->m_page[m_index]; }
+      pointer operator->() const { return &m_range->m_page[m_index]; }
+
+      Iterator& operator++()
+      {
+        ++m_index;
+        Settle();
+        return *this;
+      }
+
+      bool operator==(const Iterator& other) const
+      {
+        return m_range == other.m_range && m_index == other.m_index;
+      }
+      bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+      explicit Iterator(PagedRange* range) : m_range(range) { Settle(); }
+
+      // Moves on to the next non-empty page once the current one is used up, becomes the end
+      // iterator after the last page.
+      void Settle()
+      {
+        while (m_range != nullptr && m_index >= m_range->m_page.size())
+        {
+          m_index = 0;
+          if (!m_range->NextPage(m_range->m_page))
+          {
+            m_range = nullptr;
+          }
+        }
+      }
+
+      PagedRange* m_range = nullptr;
+      std::size_t m_index = 0;
+
+      friend class PagedRange;
+    };
+
+    /**
+     * @brief Starts listing at marker, empty for the first page, with up to prefetchDepth pages
+     * fetched ahead of the caller. A prefetchDepth of 0 fetches every page when it is asked for.
+     */
+    PagedRange(
+        Azure::Core::Context context,
+        std::string marker,
+        int prefetchDepth,
+        FetchPageFunc fetchPageFunc)
+        : m_context(std::move(context)), m_state(std::make_shared<State>())
+    {
+      m_state->Context = m_context.WithDeadline(Azure::Core::Context::time_point::max());
+      m_state->FetchPage = std::move(fetchPageFunc);
+      m_state->PrefetchDepth = static_cast<std::size_t>(std::max(prefetchDepth, 0));
+      m_state->NextMarker = std::move(marker);
+      m_nextMarker = m_state->NextMarker;
+      std::lock_guard<std::mutex> guard(m_state->Mutex);
+      StartFetch(m_state);
+    }
+
+    ~PagedRange() { Stop(); }
+
+    PagedRange(const PagedRange&) = delete;
+    PagedRange& operator=(const PagedRange&) = delete;
+
+    PagedRange(PagedRange&& other) noexcept
+        : m_context(std::move(other.m_context)), m_state(std::move(other.m_state)),
+          m_page(std::move(other.m_page)), m_nextMarker(std::move(other.m_nextMarker))
+    {
+    }
+
+    PagedRange& operator=(PagedRange&& other) noexcept
+    {
+      if (this != &other)
+      {
+        Stop();
+        m_context = std::move(other.m_context);
+        m_state = std::move(other.m_state);
+        m_page = std::move(other.m_page);
+        m_nextMarker = std::move(other.m_nextMarker);
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Returns an iterator to the first item not consumed yet. Items are consumed once, an
+     * iterator shouldn't be used after the range has been advanced through another one.
+     */
+    Iterator begin() { return Iterator(this); }
+    Iterator end() { return Iterator(); }
+
+    /**
+     * @brief Moves the items of the next page into page. Returns false after the last page.
+     */
+    bool NextPage(std::vector<Item>& page)
+    {
+      std::unique_lock<std::mutex> guard(m_state->Mutex);
+      // Without prefetching, a page is fetched only when asked for.
+      StartFetch(m_state, true);
+      while (m_state->Pages.empty() && !m_state->Exception
+             && !(m_state->Done && !m_state->Fetching))
+      {
+        if (m_context.CancelWhen() < std::chrono::system_clock::now())
+        {
+          throw std::runtime_error("the operation was cancelled");
+        }
+        m_state->Cv.wait_for(guard, std::chrono::milliseconds(100));
+      }
+      if (!m_state->Pages.empty())
+      {
+        page = std::move(m_state->Pages.front().first);
+        m_nextMarker = std::move(m_state->Pages.front().second);
+        m_state->Pages.pop_front();
+        StartFetch(m_state);
+        return true;
+      }
+      if (m_state->Exception)
+      {
+        // Later calls fail the same way.
+        std::rethrow_exception(m_state->Exception);
+      }
+      page.clear();
+      return false;
+    }
+
+    /**
+     * @brief Returns the marker of the first page not handed out yet, empty once all pages have
+     * been. Listing can be resumed from there with a new range or a segment call.
+     */
+    const std::string& GetNextMarker() const { return m_nextMarker; }
+
+  private:
+    struct State
+    {
+      // Child of the range's context, cancelled when the range is destroyed.
+      Azure::Core::Context Context;
+      FetchPageFunc FetchPage;
+      std::size_t PrefetchDepth = 0;
+
+      std::mutex Mutex;
+      std::condition_variable Cv;
+      // Fetched pages along with the marker of the page after each.
+      std::deque<std::pair<std::vector<Item>, std::string>> Pages;
+      std::string NextMarker;
+      bool Fetching = false;
+      bool Done = false;
+      bool Stopped = false;
+      std::exception_ptr Exception;
+    };
+
+    // Has the next page fetched in the background unless enough pages are ready or being fetched.
+    // Called with the mutex held.
+    static void StartFetch(const std::shared_ptr<State>& state, bool requested = false)
+    {
+      std::size_t depth = std::max(state->PrefetchDepth, std::size_t(requested ? 1 : 0));
+      if (state->Fetching || state->Done || state->Stopped || state->Exception
+          || state->Pages.size() >= depth)
+      {
+        return;
+      }
+      state->Fetching = true;
+      std::string marker = state->NextMarker;
+      Details::WorkStealingThreadPool::GetDefault().Submit([state, marker]() {
+        std::vector<Item> page;
+        std::string nextMarker;
+        std::exception_ptr exception;
+        try
+        {
+          page = state->FetchPage(state->Context, marker, nextMarker);
+        }
+        catch (...)
+        {
+          exception = std::current_exception();
+        }
+        std::lock_guard<std::mutex> guard(state->Mutex);
+        state->Fetching = false;
+        if (exception)
+        {
+          state->Exception = exception;
+        }
+        else
+        {
+          state->Done = nextMarker.empty();
+          state->NextMarker = nextMarker;
+          state->Pages.emplace_back(std::move(page), std::move(nextMarker));
+          StartFetch(state);
+        }
+        state->Cv.notify_all();
+      });
+    }
+
+    void Stop()
+    {
+      if (!m_state)
+      {
+        return;
+      }
+      m_state->Context.Cancel();
+      // FetchPage may refer to objects the owner of the range destroys after the range.
+      std::unique_lock<std::mutex> guard(m_state->Mutex);
+      m_state->Stopped = true;
+      m_state->Cv.wait(guard, [this]() { return !m_state->Fetching; });
+      guard.unlock();
+      m_state.reset();
+    }
+
+    Azure::Core::Context m_context;
+    std::shared_ptr<State> m_state;
+    // The page the iterators walk.
+    std::vector<Item> m_page;
+    std::string m_nextMarker;
+  };
+
+}} // namespace Azure::Storage
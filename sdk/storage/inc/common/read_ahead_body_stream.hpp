@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "context.hpp"
+#include "http/body_stream.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  // Reads [offset, offset + length) of a source that is fetched in chunks of chunkSize bytes, with
+  // up to concurrency chunks being fetched on the transfer thread pool ahead of the reader. Bytes
+  // are delivered in order. A chunk's buffer is reused for the chunk concurrency places further
+  // once it has been read, so no more than concurrency chunks are held in memory at once.
+  // A failed fetch is rethrown by the Read that reaches its chunk. Fetches still in flight when the
+  // stream is destroyed or rewound are cancelled through their context.
+  class ReadAheadBodyStream : public Azure::Core::Http::BodyStream {
+  public:
+    // Fills buffer with the length bytes of the source at offset, throws on failure.
+    using FetchFunc
+        = std::function<void(Azure::Core::Context&, int64_t offset, int64_t length, uint8_t*)>;
+
+    ReadAheadBodyStream(
+        Azure::Core::Context context,
+        int64_t offset,
+        int64_t length,
+        int64_t chunkSize,
+        int concurrency,
+        FetchFunc fetchFunc);
+
+    ~ReadAheadBodyStream() override;
+
+    ReadAheadBodyStream(const ReadAheadBodyStream&) = delete;
+    ReadAheadBodyStream& operator=(const ReadAheadBodyStream&) = delete;
+
+    int64_t Length() const override { return m_length; }
+
+    void Rewind() override;
+
+    int64_t Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count) override;
+
+  private:
+    struct State;
+
+    void Start();
+    void Stop();
+    void Fetch(int64_t chunkId);
+
+    Azure::Core::Context m_context;
+    int64_t m_offset;
+    int64_t m_length;
+    int64_t m_chunkSize;
+    int m_concurrency;
+    FetchFunc m_fetchFunc;
+
+    std::shared_ptr<State> m_state;
+    int64_t m_position = 0;
+  };
+
+}}} // namespace Azure::Storage::Details
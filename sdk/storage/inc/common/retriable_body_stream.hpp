@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "context.hpp"
+#include "http/body_stream.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  // Body of a response that is resumed with a new request when the connection fails while it is
+  // read. Retries of the pipeline end once the response head arrived, this picks up from there.
+  // Transport errors and connections closed before Length() bytes arrived are retried up to
+  // maxRetries times in a row, with an exponential, jittered delay starting at retryDelay.
+  // Any other error, from reading or from reopenFunc, is passed on.
+  class RetriableBodyStream : public Azure::Core::Http::BodyStream {
+  public:
+    // Issues a new request for the content from offset on, offset being relative to the start of
+    // this stream.
+    using ReopenFunc = std::function<std::unique_ptr<Azure::Core::Http::BodyStream>(
+        Azure::Core::Context&,
+        int64_t offset)>;
+
+    RetriableBodyStream(
+        std::unique_ptr<Azure::Core::Http::BodyStream> inner,
+        ReopenFunc reopenFunc,
+        int maxRetries,
+        std::chrono::milliseconds retryDelay = std::chrono::milliseconds(800),
+        std::chrono::milliseconds maxRetryDelay = std::chrono::seconds(30));
+
+    int64_t Length() const override { return m_length; }
+
+    // Starts over with a new request on the next read.
+    void Rewind() override;
+
+    int64_t Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count) override;
+
+  private:
+    void Backoff(Azure::Core::Context& context, int attempt);
+
+    std::unique_ptr<Azure::Core::Http::BodyStream> m_inner;
+    ReopenFunc m_reopenFunc;
+    int m_maxRetries;
+    std::chrono::milliseconds m_retryDelay;
+    std::chrono::milliseconds m_maxRetryDelay;
+    int64_t m_length;
+    int64_t m_position = 0;
+  };
+
+}}} // namespace Azure::Storage::Details
@@ -13,6 +13,7 @@
 namespace Azure { namespace Storage {
 
   class TokenCredentialPolicy;
+  class HmacSha256;
 
   struct TokenCredential
   {
@@ -47,6 +48,7 @@ namespace Azure { namespace Storage {
     {
       std::lock_guard<std::mutex> guard(m_mutex);
       m_accountKey = std::move(accountKey);
+      m_signingKey.reset();
     }
 
     std::string AccountName;
@@ -59,8 +61,13 @@ namespace Azure { namespace Storage {
       return m_accountKey;
     }
 
+    // The account key decoded and turned into an HMAC key schedule, built on first use and
+    // rebuilt after the key is rotated.
+    std::shared_ptr<const HmacSha256> GetSigningKey();
+
     std::mutex m_mutex;
     std::string m_accountKey;
+    std::shared_ptr<const HmacSha256> m_signingKey;
   };
 
   namespace Details {
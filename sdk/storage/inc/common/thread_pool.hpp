@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  /**
+   * @brief A work-stealing thread pool shared by all parallel transfers in the process.
+   *
+   * Worker threads are created lazily, only when a task is submitted and no worker is idle, and
+   * never exceed the maximum given at construction. Each worker owns a task queue. A worker serves
+   * its own queue in LIFO order and steals from the front of other queues when it runs dry.
+   */
+  class WorkStealingThreadPool {
+  public:
+    explicit WorkStealingThreadPool(std::size_t maxThreads);
+
+    ~WorkStealingThreadPool();
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    /**
+     * @brief Queues a task for execution. Tasks must not throw.
+     */
+    void Submit(std::function<void()> task);
+
+    std::size_t GetMaximumThreads() const { return m_queues.size(); }
+
+    std::size_t GetThreadCount();
+
+    /**
+     * @brief Returns the process-wide pool used by the transfer APIs.
+     */
+    static WorkStealingThreadPool& GetDefault();
+
+  private:
+    struct WorkQueue
+    {
+      std::mutex Mutex;
+      std::deque<std::function<void()>> Tasks;
+    };
+
+    void WorkerFunc(std::size_t index);
+    bool TryPop(std::size_t index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::size_t m_numPendingTasks = 0;
+    std::size_t m_numIdleThreads = 0;
+    std::size_t m_nextQueue = 0;
+    bool m_stop = false;
+  };
+
+}}} // namespace Azure::Storage::Details
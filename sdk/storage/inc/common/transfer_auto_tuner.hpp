@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  /**
+   * @brief Picks the chunk size and the number of parallel requests of a transfer from the
+   * measured throughput.
+   *
+   * Completed chunks are grouped into measurement windows. While the throughput of a window
+   * improves on the best one seen so far, the tuner alternately doubles the number of parallel
+   * requests and the chunk size. A step that doesn't improve throughput is undone and that
+   * dimension is left alone from then on. The tuner halves the number of parallel requests when
+   * the service throttles or the latency per byte inflates, then adds one back per clean window
+   * until it reaches the number it backed off from, and ramps from there. The best measured
+   * configuration is remembered per endpoint and used as the starting point of later transfers
+   * to the same endpoint.
+   */
+  class TransferAutoTuner {
+  public:
+    // endpoint is the key the tuned values are remembered under, initialChunkSize is used when
+    // nothing is remembered for the endpoint yet.
+    TransferAutoTuner(
+        std::string endpoint,
+        int64_t initialChunkSize,
+        int64_t maxChunkSize,
+        int maxConcurrency);
+
+    ~TransferAutoTuner();
+
+    TransferAutoTuner(const TransferAutoTuner&) = delete;
+    TransferAutoTuner& operator=(const TransferAutoTuner&) = delete;
+
+    int64_t GetChunkSize();
+
+    int GetConcurrency();
+
+    void OnChunkCompleted(int64_t bytes, std::chrono::steady_clock::duration latency)
+    {
+      OnChunkCompleted(bytes, latency, std::chrono::steady_clock::now());
+    }
+
+    // now is the time the chunk completed.
+    void OnChunkCompleted(
+        int64_t bytes,
+        std::chrono::steady_clock::duration latency,
+        std::chrono::steady_clock::time_point now);
+
+    // Called when the service rejects a chunk request because it is busy.
+    void OnThrottled();
+
+  private:
+    void CloseWindow(std::chrono::steady_clock::time_point now);
+    void Grow();
+    void BackOff();
+
+    std::mutex m_mutex;
+    std::string m_endpoint;
+    int64_t m_maxChunkSize;
+    int m_maxConcurrency;
+
+    int64_t m_chunkSize;
+    int m_concurrency;
+    int64_t m_bestChunkSize;
+    int m_bestConcurrency;
+    double m_bestThroughput = 0.0;
+    // Lowest average latency per byte of a window, in seconds.
+    double m_baselineLatency = 0.0;
+    bool m_ramping = true;
+    bool m_recovering = false;
+    // The number of parallel requests before the last back off.
+    int m_recoveryConcurrency = 0;
+    bool m_lastGrewChunkSize = false;
+    bool m_lastGrewConcurrency = false;
+    bool m_chunkSizeSettled = false;
+    bool m_concurrencySettled = false;
+    // Whether the best configuration was measured, only then it is remembered.
+    bool m_tuned = false;
+
+    bool m_windowStarted = false;
+    std::chrono::steady_clock::time_point m_windowStart;
+    int64_t m_windowBytes = 0;
+    int64_t m_windowChunks = 0;
+    double m_windowLatency = 0.0;
+  };
+
+}}} // namespace Azure::Storage::Details
@@ -0,0 +1,180 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "context.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace Azure { namespace Storage {
+
+  namespace Details {
+    class GovernedTransfer;
+  } // namespace Details
+
+  /**
+   * @brief Snapshot of the resources held by parallel transfers.
+   */
+  struct TransferGovernorUsage
+  {
+    /**
+     * @brief Number of transfers currently running.
+     */
+    int64_t ActiveTransfers = 0;
+
+    /**
+     * @brief Number of chunk requests currently in flight.
+     */
+    int64_t InFlightChunks = 0;
+
+    /**
+     * @brief Number of bytes of staging buffers currently held by in-flight chunks.
+     */
+    int64_t BufferBytes = 0;
+
+    /**
+     * @brief Number of chunk requests waiting to be admitted.
+     */
+    int64_t QueuedChunks = 0;
+  };
+
+  /**
+   * @brief Bounds the resources used by all parallel transfers in the process.
+   *
+   * BlobClient::DownloadToBuffer, BlobClient::DownloadToFile, BlockBlobClient::UploadFromBuffer,
+   * BlockBlobClient::UploadFromFile, BlockBlobClient::UploadFromStream and the streams returned by
+   * BlobClient::OpenRead ask the governor for admission before each chunk request. Waiting chunks
+   * are admitted in a round-robin fashion across transfers, the transfer with the fewest chunks in
+   * flight goes first. Limits are unbounded by default.
+   */
+  class TransferGovernor {
+  public:
+    /**
+     * @brief Returns the governor shared by all transfers in the process.
+     */
+    static TransferGovernor& GetDefault();
+
+    TransferGovernor() = default;
+    TransferGovernor(const TransferGovernor&) = delete;
+    TransferGovernor& operator=(const TransferGovernor&) = delete;
+
+    /**
+     * @brief Sets the maximum number of chunk requests in flight across all transfers.
+     */
+    void SetMaximumInFlightChunks(int64_t maxInFlightChunks);
+
+    /**
+     * @brief Sets the maximum number of bytes of staging buffers across all transfers. A single
+     * chunk larger than this limit is still admitted when nothing else is in flight.
+     */
+    void SetMaximumBufferBytes(int64_t maxBufferBytes);
+
+    int64_t GetMaximumInFlightChunks();
+
+    int64_t GetMaximumBufferBytes();
+
+    /**
+     * @brief Returns the resources currently in use.
+     */
+    TransferGovernorUsage GetUsage();
+
+  private:
+    struct Waiter
+    {
+      uint64_t TransferId;
+      int64_t BufferBytes;
+      bool Admitted = false;
+    };
+
+    uint64_t RegisterTransfer();
+    void UnregisterTransfer(uint64_t transferId);
+    void Acquire(Azure::Core::Context& context, uint64_t transferId, int64_t bufferBytes);
+    void Release(uint64_t transferId, int64_t bufferBytes);
+    void AdmitWaiters();
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    int64_t m_maxInFlightChunks = std::numeric_limits<int64_t>::max();
+    int64_t m_maxBufferBytes = std::numeric_limits<int64_t>::max();
+    int64_t m_inFlightChunks = 0;
+    int64_t m_bufferBytes = 0;
+    uint64_t m_nextTransferId = 0;
+    // transfer id -> number of chunks in flight
+    std::map<uint64_t, int64_t> m_transfers;
+    std::list<Waiter*> m_waiters;
+
+    friend class Details::GovernedTransfer;
+  };
+
+  namespace Details {
+
+    // Registration of one transfer with a TransferGovernor.
+    class GovernedTransfer {
+    public:
+      // Admission to run one chunk request, released on destruction.
+      class Permit {
+      public:
+        Permit(Permit&& other) noexcept
+            : m_transfer(other.m_transfer), m_bufferBytes(other.m_bufferBytes)
+        {
+          other.m_transfer = nullptr;
+        }
+
+        ~Permit() { Release(); }
+
+        void Release()
+        {
+          if (m_transfer)
+          {
+            m_transfer->m_governor.Release(m_transfer->m_transferId, m_bufferBytes);
+            m_transfer = nullptr;
+          }
+        }
+
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+        Permit& operator=(Permit&&) = delete;
+
+      private:
+        Permit(GovernedTransfer* transfer, int64_t bufferBytes)
+            : m_transfer(transfer), m_bufferBytes(bufferBytes)
+        {
+        }
+
+        GovernedTransfer* m_transfer;
+        int64_t m_bufferBytes;
+
+        friend class GovernedTransfer;
+      };
+
+      explicit GovernedTransfer(TransferGovernor& governor = TransferGovernor::GetDefault())
+          : m_governor(governor), m_transferId(governor.RegisterTransfer())
+      {
+      }
+
+      ~GovernedTransfer() { m_governor.UnregisterTransfer(m_transferId); }
+
+      GovernedTransfer(const GovernedTransfer&) = delete;
+      GovernedTransfer& operator=(const GovernedTransfer&) = delete;
+
+      // Blocks until the chunk is admitted, throws if context is cancelled while waiting.
+      Permit Acquire(Azure::Core::Context& context, int64_t bufferBytes)
+      {
+        m_governor.Acquire(context, m_transferId, bufferBytes);
+        return Permit(this, bufferBytes);
+      }
+
+    private:
+      TransferGovernor& m_governor;
+      uint64_t m_transferId;
+    };
+
+  } // namespace Details
+
+}} // namespace Azure::Storage
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  // On-disk record of the chunks of a transfer that are done, so that a transfer started again
+  // after a failure can skip them. The journal belongs to the transfer described by guard, which
+  // should cover everything that decides what a chunk id refers to: source and destination, their
+  // versions, offsets and the chunk size. A journal written for another guard is started over.
+  // Every chunk is appended to the file as soon as it is marked, a record cut off by a crash is
+  // ignored when the journal is loaded.
+  class TransferJournal {
+  public:
+    // Opens the journal at path, or creates it if it doesn't exist. Throws if it can't be written.
+    // guard must fit on one line.
+    TransferJournal(std::string path, const std::string& guard);
+
+    TransferJournal(const TransferJournal&) = delete;
+    TransferJournal& operator=(const TransferJournal&) = delete;
+
+    // Chunks recorded by earlier runs of the transfer, chunks marked since aren't included.
+    const std::set<int64_t>& GetCompletedChunks() const { return m_completedChunks; }
+
+    bool IsCompleted(int64_t chunkId) const { return m_completedChunks.count(chunkId) != 0; }
+
+    // Replaces the recorded chunks, for chunks found to be lost since they were recorded.
+    void SetCompletedChunks(std::set<int64_t> completedChunks);
+
+    // Records chunkId as done. Can be called from several threads at once, and while others call
+    // IsCompleted.
+    void MarkCompleted(int64_t chunkId);
+
+    // Deletes the journal once the transfer succeeded.
+    void Remove();
+
+  private:
+    void Rewrite();
+
+    std::string m_path;
+    std::string m_guard;
+    std::set<int64_t> m_completedChunks;
+    std::mutex m_mutex;
+    std::ofstream m_stream;
+  };
+
+}}} // namespace Azure::Storage::Details
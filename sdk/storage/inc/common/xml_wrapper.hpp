@@ -3,7 +3,13 @@
 
 #pragma once
 
+#include "context.hpp"
+#include "http/body_stream.hpp"
+
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <string>
 
 struct _xmlTextReader;
@@ -22,6 +28,8 @@ namespace Azure { namespace Storage {
     End,
   };
 
+  // Nodes returned by XmlReader::Read point into the reader's memory, Name and Value are only
+  // valid until the next call to Read.
   struct XmlNode
   {
     explicit XmlNode(XmlNodeType type, const char* name = nullptr, const char* value = nullptr)
@@ -33,14 +41,44 @@ namespace Azure { namespace Storage {
     const char* Value;
   };
 
+  // FNV-1a hash of an element or attribute name, for dispatching on names with a switch whose
+  // case labels are computed at compile time, as in case XmlNameHash("Name"). Different names
+  // may hash the same, a match has to be confirmed by comparing the names.
+  constexpr uint32_t XmlNameHash(const char* name)
+  {
+    uint32_t hash = 2166136261u;
+    for (; *name != '\0'; ++name)
+    {
+      hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+    }
+    return hash;
+  }
+
   class XmlReader {
   public:
     explicit XmlReader(const char* data, std::size_t length);
+    // Parses the document as it is read from stream, a few KB at a time, so that nodes come out
+    // while the rest of the body is still being downloaded. A failure to read from stream is
+    // thrown from Read.
+    explicit XmlReader(Azure::Core::Context context, Azure::Core::Http::BodyStream& stream);
     ~XmlReader();
 
+    XmlReader(const XmlReader&) = delete;
+    XmlReader& operator=(const XmlReader&) = delete;
+
     XmlNode Read();
 
   private:
+    struct StreamInput
+    {
+      Azure::Core::Context Context;
+      Azure::Core::Http::BodyStream* Stream = nullptr;
+      std::exception_ptr Exception;
+    };
+
+    [[noreturn]] void ThrowParseError();
+
+    std::unique_ptr<StreamInput> m_input;
     _xmlTextReader* m_reader = nullptr;
     bool m_readingAttributes = false;
   };
@@ -59,4 +97,35 @@ namespace Azure { namespace Storage {
     _xmlTextWriter* m_writer = nullptr;
   };
 
+  // A document of a root element holding a list of elements with text, as in
+  // <BlockList><Latest>id</Latest>...</BlockList>, that is serialized piece by piece as it is
+  // read instead of being built in memory first. element is called with the index of an element
+  // and returns its name and text, which have to stay valid while the stream is in use. The length
+  // is computed up front, so that the stream can be sent with a Content-Length.
+  class XmlListBodyStream : public Azure::Core::Http::BodyStream {
+  public:
+    explicit XmlListBodyStream(
+        std::string rootName,
+        std::size_t numElements,
+        std::function<XmlNode(std::size_t index)> element);
+
+    int64_t Length() const override { return m_length; }
+
+    void Rewind() override;
+
+    int64_t Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count) override;
+
+  private:
+    bool NextPiece();
+
+    std::string m_rootName;
+    std::size_t m_numElements;
+    std::function<XmlNode(std::size_t index)> m_element;
+    int64_t m_length = 0;
+    // Pieces are the prologue with the root start tag, one per element, and the root end tag.
+    std::size_t m_nextPiece = 0;
+    std::string m_piece;
+    std::size_t m_pieceOffset = 0;
+  };
+
 }} // namespace Azure::Storage
@@ -166,6 +166,12 @@ namespace Azure { namespace Storage { namespace DataLake {
      *        if the directory does not exist.
      */
     Azure::Core::Nullable<std::string> Directory;
+
+    /**
+     * @brief The number of pages ListAllPaths fetches ahead of the caller. Not used by
+     *        ListPaths.
+     */
+    int PrefetchDepth = 1;
   };
 
   /**
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "common/paged_range.hpp"
 #include "common/storage_credential.hpp"
 #include "common/storage_url_builder.hpp"
 #include "datalake/service_client.hpp"
@@ -129,6 +130,19 @@ namespace Azure { namespace Storage { namespace DataLake {
         bool recursive,
         const ListPathsOptions& options = ListPathsOptions()) const;
 
+    /**
+     * @brief List all the paths in this file system, from options.Continuation on. Pages are
+     *        requested as the range is walked, up to options.PrefetchDepth of them ahead of the
+     *        caller.
+     * @param recursive If "true", all paths are listed; otherwise, only paths at the root of the
+     *                  filesystem are listed.
+     * @param options Optional parameters to list the paths in file system.
+     * @return A PagedRange of the paths.
+     */
+    PagedRange<Path> ListAllPaths(
+        bool recursive,
+        const ListPathsOptions& options = ListPathsOptions()) const;
+
   private:
     UrlBuilder m_dfsUri;
     UrlBuilder m_blobUri;
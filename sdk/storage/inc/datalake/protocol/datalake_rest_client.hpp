@@ -11,11 +11,13 @@
 #include "json.hpp"
 #include "nullable.hpp"
 
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <stdexcept>
+#include <streambuf>
 #include <string>
 #include <vector>
 
@@ -194,6 +196,153 @@ namespace Azure { namespace Storage { namespace DataLake {
     }
   };
 
+  namespace Details {
+    // Hands a body to the JSON parser as it is downloaded, a few KB at a time.
+    class JsonBodyStreamBuffer : public std::streambuf {
+    public:
+      explicit JsonBodyStreamBuffer(
+          Azure::Core::Context context,
+          Azure::Core::Http::BodyStream& stream)
+          : m_context(std::move(context)), m_stream(&stream)
+      {
+      }
+
+    protected:
+      int_type underflow() override
+      {
+        int64_t bytesRead = m_stream->Read(
+            m_context,
+            reinterpret_cast<uint8_t*>(m_buffer),
+            static_cast<int64_t>(sizeof(m_buffer)));
+        if (bytesRead == 0)
+        {
+          return traits_type::eof();
+        }
+        setg(m_buffer, m_buffer, m_buffer + bytesRead);
+        return traits_type::to_int_type(*gptr());
+      }
+
+    private:
+      Azure::Core::Context m_context;
+      Azure::Core::Http::BodyStream* m_stream;
+      char m_buffer[16 * 1024];
+    };
+
+    // SAX events of a document like {"paths": [{"name": "a", ...}, ...]}, which fill the items
+    // of the list named listName one field at a time, without building a DOM. setField gets every
+    // value of an item as text: strings as they are, other values as they are written in the
+    // document. Values nested deeper in an item and anything outside of the list are skipped.
+    template <class Item> class JsonListSaxHandler {
+    public:
+      using SetField = void (*)(Item& item, const std::string& key, std::string& value);
+
+      explicit JsonListSaxHandler(const char* listName, std::vector<Item>& items, SetField setField)
+          : m_listName(listName), m_items(items), m_setField(setField)
+      {
+      }
+
+      bool null() { return true; }
+      bool boolean(bool value) { return Value(value ? "true" : "false"); }
+      bool number_integer(nlohmann::json::number_integer_t value)
+      {
+        return Value(std::to_string(value));
+      }
+      bool number_unsigned(nlohmann::json::number_unsigned_t value)
+      {
+        return Value(std::to_string(value));
+      }
+      bool number_float(nlohmann::json::number_float_t, const std::string& text)
+      {
+        return Value(text);
+      }
+      bool string(std::string& value) { return Value(std::move(value)); }
+      bool binary(nlohmann::json::binary_t&) { return true; }
+
+      bool start_object(std::size_t)
+      {
+        ++m_depth;
+        if (m_inList && m_depth == 3)
+        {
+          m_items.emplace_back();
+        }
+        return true;
+      }
+      bool end_object()
+      {
+        --m_depth;
+        return true;
+      }
+      bool start_array(std::size_t)
+      {
+        ++m_depth;
+        if (m_depth == 2)
+        {
+          m_inList = m_key == m_listName;
+        }
+        return true;
+      }
+      bool end_array()
+      {
+        if (m_depth == 2)
+        {
+          m_inList = false;
+        }
+        --m_depth;
+        return true;
+      }
+      bool key(std::string& key)
+      {
+        if (m_depth == 1 || m_depth == 3)
+        {
+          m_key = std::move(key);
+        }
+        return true;
+      }
+
+      bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e)
+      {
+        throw std::runtime_error(std::string("failed to parse json: ") + e.what());
+      }
+
+    private:
+      bool Value(std::string value)
+      {
+        if (m_inList && m_depth == 3)
+        {
+          m_setField(m_items.back(), m_key, value);
+        }
+        return true;
+      }
+
+      const char* m_listName;
+      std::vector<Item>& m_items;
+      SetField m_setField;
+      int m_depth = 0;
+      bool m_inList = false;
+      std::string m_key;
+    };
+
+    // Parses a list response as it is read from stream, an empty body is an empty list.
+    template <class Item>
+    std::vector<Item> ParseJsonList(
+        Azure::Core::Context context,
+        Azure::Core::Http::BodyStream& stream,
+        const char* listName,
+        typename JsonListSaxHandler<Item>::SetField setField)
+    {
+      std::vector<Item> items;
+      JsonBodyStreamBuffer buffer(std::move(context), stream);
+      if (buffer.sgetc() == std::char_traits<char>::eof())
+      {
+        return items;
+      }
+      std::istream input(&buffer);
+      JsonListSaxHandler<Item> handler(listName, items, setField);
+      nlohmann::json::sax_parse(input, &handler);
+      return items;
+    }
+  } // namespace Details
+
   struct Path
   {
     std::string Name;
@@ -205,24 +354,40 @@ namespace Azure { namespace Storage { namespace DataLake {
     std::string Group;
     std::string Permissions;
 
-    static Path CreateFromJson(const nlohmann::json& node)
+    static void SetFromJsonField(Path& result, const std::string& key, std::string& value)
     {
-      Path result;
-      result.Name = node["name"].get<std::string>();
-      if (node.contains("isDirectory"))
+      if (key == "name")
       {
-        result.IsDirectory = (node["isDirectory"].get<std::string>() == "true");
+        result.Name = std::move(value);
       }
-      result.LastModified = node["lastModified"].get<std::string>();
-      result.Etag = node["etag"].get<std::string>();
-      if (node.contains("contentLength"))
+      else if (key == "isDirectory")
       {
-        result.ContentLength = std::stoll(node["contentLength"].get<std::string>());
+        result.IsDirectory = (value == "true");
+      }
+      else if (key == "lastModified")
+      {
+        result.LastModified = std::move(value);
+      }
+      else if (key == "etag")
+      {
+        result.Etag = std::move(value);
+      }
+      else if (key == "contentLength")
+      {
+        result.ContentLength = std::stoll(value);
+      }
+      else if (key == "owner")
+      {
+        result.Owner = std::move(value);
+      }
+      else if (key == "group")
+      {
+        result.Group = std::move(value);
+      }
+      else if (key == "permissions")
+      {
+        result.Permissions = std::move(value);
       }
-      result.Owner = node["owner"].get<std::string>();
-      result.Group = node["group"].get<std::string>();
-      result.Permissions = node["permissions"].get<std::string>();
-      return result;
     }
   };
 
@@ -230,13 +395,13 @@ namespace Azure { namespace Storage { namespace DataLake {
   {
     std::vector<Path> Paths;
 
-    static PathList CreateFromJson(const nlohmann::json& node)
+    static PathList CreateFromJsonStream(
+        Azure::Core::Context context,
+        Azure::Core::Http::BodyStream& stream)
     {
       PathList result;
-      for (const auto& element : node["paths"])
-      {
-        result.Paths.emplace_back(Path::CreateFromJson(element));
-      }
+      result.Paths = Details::ParseJsonList<Path>(
+          std::move(context), stream, "paths", &Path::SetFromJsonField);
       return result;
     }
   };
@@ -247,13 +412,20 @@ namespace Azure { namespace Storage { namespace DataLake {
     std::string LastModified;
     std::string Etag;
 
-    static FileSystem CreateFromJson(const nlohmann::json& node)
+    static void SetFromJsonField(FileSystem& result, const std::string& key, std::string& value)
     {
-      FileSystem result;
-      result.Name = node["name"].get<std::string>();
-      result.LastModified = node["lastModified"].get<std::string>();
-      result.Etag = node["etag"].get<std::string>();
-      return result;
+      if (key == "name")
+      {
+        result.Name = std::move(value);
+      }
+      else if (key == "lastModified")
+      {
+        result.LastModified = std::move(value);
+      }
+      else if (key == "etag")
+      {
+        result.Etag = std::move(value);
+      }
     }
   };
 
@@ -261,13 +433,13 @@ namespace Azure { namespace Storage { namespace DataLake {
   {
     std::vector<FileSystem> Filesystems;
 
-    static FileSystemList CreateFromJson(const nlohmann::json& node)
+    static FileSystemList CreateFromJsonStream(
+        Azure::Core::Context context,
+        Azure::Core::Http::BodyStream& stream)
     {
       FileSystemList result;
-      for (const auto& element : node["filesystems"])
-      {
-        result.Filesystems.emplace_back(FileSystem::CreateFromJson(element));
-      }
+      result.Filesystems = Details::ParseJsonList<FileSystem>(
+          std::move(context), stream, "filesystems", &FileSystem::SetFromJsonField);
       return result;
     }
   };
@@ -921,12 +1093,9 @@ namespace Azure { namespace Storage { namespace DataLake {
         {
           // OK
           auto context = Azure::Core::Context();
-          auto bodyBuffer
-              = Azure::Core::Http::BodyStream::ReadToEnd(context, *response.GetBodyStream());
-          ServiceListFileSystemsResponse result = bodyBuffer.empty()
-              ? ServiceListFileSystemsResponse()
-              : ServiceListFileSystemsResponse::ServiceListFileSystemsResponseFromFileSystemList(
-                  FileSystemList::CreateFromJson(nlohmann::json::parse(bodyBuffer)));
+          ServiceListFileSystemsResponse result
+              = ServiceListFileSystemsResponse::ServiceListFileSystemsResponseFromFileSystemList(
+                  FileSystemList::CreateFromJsonStream(context, *response.GetBodyStream()));
           result.Date = response.GetHeaders().at(Details::c_HeaderDate);
           result.RequestId = response.GetHeaders().at(Details::c_HeaderXMsRequestId);
           result.Version = response.GetHeaders().at(Details::c_HeaderXMsVersion);
@@ -1337,12 +1506,9 @@ namespace Azure { namespace Storage { namespace DataLake {
         {
           // Ok
           auto context = Azure::Core::Context();
-          auto bodyBuffer
-              = Azure::Core::Http::BodyStream::ReadToEnd(context, *response.GetBodyStream());
-          FileSystemListPathsResponse result = bodyBuffer.empty()
-              ? FileSystemListPathsResponse()
-              : FileSystemListPathsResponse::FileSystemListPathsResponseFromPathList(
-                  PathList::CreateFromJson(nlohmann::json::parse(bodyBuffer)));
+          FileSystemListPathsResponse result
+              = FileSystemListPathsResponse::FileSystemListPathsResponseFromPathList(
+                  PathList::CreateFromJsonStream(context, *response.GetBodyStream()));
           result.Date = response.GetHeaders().at(Details::c_HeaderDate);
           result.RequestId = response.GetHeaders().at(Details::c_HeaderXMsRequestId);
           result.Version = response.GetHeaders().at(Details::c_HeaderXMsVersion);
@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/base64.hpp"
+#include "samples_common.hpp"
+
+#ifndef _WIN32
+#include <openssl/bio.h>
+#include <openssl/buffer.h>
+#include <openssl/evp.h>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Measures Base64 throughput for the input sizes the SDK deals with: 32 byte signatures, 64 byte
+ * block IDs and whole blocks. On other platforms than Windows it compares against the OpenSSL BIO
+ * chain the SDK used before.
+ */
+
+namespace {
+
+#ifndef _WIN32
+  std::string BioBase64Encode(const std::string& text)
+  {
+    BIO* bio = BIO_new(BIO_s_mem());
+    bio = BIO_push(BIO_new(BIO_f_base64()), bio);
+    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
+    BIO_write(bio, text.data(), static_cast<int>(text.length()));
+    (void)BIO_flush(bio);
+    BUF_MEM* bufferPtr;
+    BIO_get_mem_ptr(bio, &bufferPtr);
+    std::string encoded(bufferPtr->data, bufferPtr->length);
+    BIO_free_all(bio);
+    return encoded;
+  }
+
+  std::string BioBase64Decode(const std::string& text)
+  {
+    std::string decoded(text.length() / 4 * 3, '\0');
+    BIO* bio = BIO_new_mem_buf(text.data(), -1);
+    bio = BIO_push(BIO_new(BIO_f_base64()), bio);
+    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
+    int decodedLength = BIO_read(bio, &decoded[0], static_cast<int>(text.length()));
+    BIO_free_all(bio);
+    decoded.resize(decodedLength);
+    return decoded;
+  }
+#endif
+
+  void Measure(const std::string& name, std::size_t bytesPerCall, const std::function<void()>& func)
+  {
+    // Roughly 256MiB of input per measurement, at least 1000 calls.
+    const std::size_t calls = std::max<std::size_t>(256 * 1024 * 1024 / bytesPerCall, 1000);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < calls; ++i)
+    {
+      func();
+    }
+    double seconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf(
+        "%-28s %10.2f MiB/s  %10.1f ns/call\n",
+        name.data(),
+        static_cast<double>(bytesPerCall * calls) / 1024.0 / 1024.0 / seconds,
+        seconds * 1e9 / static_cast<double>(calls));
+  }
+
+} // namespace
+
+SAMPLE(Base64Benchmark, Base64Benchmark)
+void Base64Benchmark()
+{
+  using namespace Azure::Storage;
+
+  std::mt19937_64 random(0);
+  for (std::size_t size : {std::size_t(32), std::size_t(64), std::size_t(4 * 1024 * 1024)})
+  {
+    std::string text(size, '\0');
+    for (auto& c : text)
+    {
+      c = static_cast<char>(random());
+    }
+    const std::string encoded = Base64Encode(text);
+#ifndef _WIN32
+    if (BioBase64Encode(text) != encoded || BioBase64Decode(encoded) != text)
+    {
+      throw std::runtime_error("Base64 implementations don't agree");
+    }
+#endif
+
+    printf("%zu bytes\n", size);
+    std::string sink;
+    Measure("  Base64Encode", size, [&]() { sink = Base64Encode(text); });
+    std::vector<char> output(Base64EncodedLength(size));
+    Measure("  Base64Encode to buffer", size, [&]() {
+      Base64Encode(reinterpret_cast<const uint8_t*>(text.data()), size, output.data());
+    });
+#ifndef _WIN32
+    Measure("  OpenSSL BIO encode", size, [&]() { sink = BioBase64Encode(text); });
+#endif
+    Measure("  Base64Decode", size, [&]() { sink = Base64Decode(encoded); });
+    Measure("  Base64Decode to buffer", size, [&]() {
+      Base64Decode(encoded.data(), encoded.length(), reinterpret_cast<uint8_t*>(output.data()));
+    });
+#ifndef _WIN32
+    Measure("  OpenSSL BIO decode", size, [&]() { sink = BioBase64Decode(encoded); });
+#endif
+  }
+}
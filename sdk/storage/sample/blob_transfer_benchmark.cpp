@@ -0,0 +1,342 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include "blobs/blob.hpp"
+#include "samples_common.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Measures throughput of the parallel transfer APIs. The benchmark runs against whatever endpoint
+ * AZURE_STORAGE_CONNECTION_STRING points to, so a local stand-in service such as Azurite can be
+ * used with a connection string like
+ * "DefaultEndpointsProtocol=http;AccountName=devstoreaccount1;AccountKey=<key>;
+ * BlobEndpoint=http://127.0.0.1:10000/devstoreaccount1;".
+ *
+ * Blobs are uploaded to a new container with a random name, which is deleted at the end. The
+ * chunk count and latencies cover the requests that move chunks, staged blocks and ranged
+ * downloads. The following environment variables control the workload:
+ *   AZURE_STORAGE_BENCHMARK_BLOB_COUNT          number of blobs, defaults to 4
+ *   AZURE_STORAGE_BENCHMARK_BLOB_SIZE           size of each blob in bytes, defaults to 64MiB
+ *   AZURE_STORAGE_BENCHMARK_CONCURRENCY         Concurrency option, defaults to 4
+ *   AZURE_STORAGE_BENCHMARK_CHUNK_SIZE          ChunkSize option, unset by default
+ *   AZURE_STORAGE_BENCHMARK_INITIAL_CHUNK_SIZE  InitialChunkSize option, unset by default
+ *   AZURE_STORAGE_BENCHMARK_AUTO_TUNE           AutoTune option if not 0, defaults to 0
+ *   AZURE_STORAGE_BENCHMARK_MEMORY_MAP_FILE     MemoryMapFile option if not 0, defaults to 0
+ */
+
+namespace {
+
+  Azure::Core::Nullable<int64_t> GetEnvInt64(const char* name)
+  {
+    const char* value = std::getenv(name);
+    if (value == nullptr || value[0] == '\0')
+    {
+      return Azure::Core::Nullable<int64_t>();
+    }
+    return std::stoll(value);
+  }
+
+  int64_t GetEnvInt64(const char* name, int64_t defaultValue)
+  {
+    auto value = GetEnvInt64(name);
+    return value.HasValue() ? value.GetValue() : defaultValue;
+  }
+
+  class LatencyRecorder {
+  public:
+    void Add(std::chrono::steady_clock::duration latency)
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_samples.emplace_back(
+          std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(latency).count());
+    }
+
+    // Returns the requested percentiles in milliseconds and clears all recorded samples.
+    std::vector<double> TakePercentiles(const std::vector<double>& percentiles)
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      std::vector<double> ret;
+      std::sort(m_samples.begin(), m_samples.end());
+      for (double p : percentiles)
+      {
+        if (m_samples.empty())
+        {
+          ret.emplace_back(0.0);
+          continue;
+        }
+        auto index = static_cast<std::size_t>(p / 100.0 * static_cast<double>(m_samples.size()));
+        ret.emplace_back(m_samples[std::min(index, m_samples.size() - 1)]);
+      }
+      m_samples.clear();
+      return ret;
+    }
+
+    std::size_t Count()
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      return m_samples.size();
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::vector<double> m_samples;
+  };
+
+  // Wraps a response body so that a chunk is considered finished when its body has been consumed
+  // and released, not when the response headers arrive.
+  class TimedBodyStream : public Azure::Core::Http::BodyStream {
+  public:
+    TimedBodyStream(
+        std::unique_ptr<Azure::Core::Http::BodyStream> inner,
+        std::shared_ptr<LatencyRecorder> recorder,
+        std::chrono::steady_clock::time_point start)
+        : m_inner(std::move(inner)), m_recorder(std::move(recorder)), m_start(start)
+    {
+    }
+
+    ~TimedBodyStream() override { m_recorder->Add(std::chrono::steady_clock::now() - m_start); }
+
+    int64_t Length() const override { return m_inner->Length(); }
+
+    void Rewind() override { m_inner->Rewind(); }
+
+    int64_t Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count) override
+    {
+      return m_inner->Read(context, buffer, count);
+    }
+
+  private:
+    std::unique_ptr<Azure::Core::Http::BodyStream> m_inner;
+    std::shared_ptr<LatencyRecorder> m_recorder;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  // Staged blocks and ranged downloads, not the calls around them like getting the properties of
+  // a blob or committing its block list.
+  bool IsChunkRequest(const Azure::Core::Http::Request& request)
+  {
+    bool isChunk = false;
+    if (request.GetMethod() == Azure::Core::Http::HttpMethod::Put)
+    {
+      request.ForEachQueryParameter([&isChunk](const std::string& key, const std::string& value) {
+        isChunk = isChunk || (key == "comp" && value == "block");
+      });
+    }
+    else if (request.GetMethod() == Azure::Core::Http::HttpMethod::Get)
+    {
+      request.ForEachHeader([&isChunk](const std::string& name, const std::string&) {
+        isChunk = isChunk || name == "x-ms-range";
+      });
+    }
+    return isChunk;
+  }
+
+  class ChunkLatencyPolicy : public Azure::Core::Http::HttpPolicy {
+  public:
+    explicit ChunkLatencyPolicy(std::shared_ptr<LatencyRecorder> recorder)
+        : m_recorder(std::move(recorder))
+    {
+    }
+
+    HttpPolicy* Clone() const override { return new ChunkLatencyPolicy(m_recorder); }
+
+    std::unique_ptr<Azure::Core::Http::Response> Send(
+        Azure::Core::Context& ctx,
+        Azure::Core::Http::Request& request,
+        Azure::Core::Http::NextHttpPolicy nextHttpPolicy) const override
+    {
+      if (!IsChunkRequest(request))
+      {
+        return nextHttpPolicy.Send(ctx, request);
+      }
+      auto start = std::chrono::steady_clock::now();
+      auto response = nextHttpPolicy.Send(ctx, request);
+      auto body = response->GetBodyStream();
+      if (body)
+      {
+        response->SetBodyStream(
+            std::make_unique<TimedBodyStream>(std::move(body), m_recorder, start));
+      }
+      else
+      {
+        m_recorder->Add(std::chrono::steady_clock::now() - start);
+      }
+      return response;
+    }
+
+  private:
+    std::shared_ptr<LatencyRecorder> m_recorder;
+  };
+
+  void RunPhase(
+      const std::string& name,
+      int64_t totalBytes,
+      LatencyRecorder& recorder,
+      const std::function<void()>& func)
+  {
+    recorder.TakePercentiles({});
+    std::clock_t cpuStart = std::clock();
+    auto wallStart = std::chrono::steady_clock::now();
+    func();
+    auto wallSeconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    std::size_t numChunks = recorder.Count();
+    auto percentiles = recorder.TakePercentiles({50.0, 99.0});
+    double mbps = static_cast<double>(totalBytes) / 1024.0 / 1024.0 / std::max(wallSeconds, 1e-9);
+    printf(
+        "%-16s %10.2f MiB/s  %6zu chunks  p50 %8.2f ms  p99 %8.2f ms  wall %7.2f s  cpu %7.2f s\n",
+        name.data(),
+        mbps,
+        numChunks,
+        percentiles[0],
+        percentiles[1],
+        wallSeconds,
+        cpuSeconds);
+  }
+
+  // Deletes the benchmark container along with its blobs, also when the benchmark fails.
+  struct ContainerDeleter
+  {
+    Azure::Storage::Blobs::BlobContainerClient& Client;
+
+    ~ContainerDeleter()
+    {
+      try
+      {
+        Client.Delete();
+      }
+      catch (std::exception& e)
+      {
+        std::cout << e.what() << std::endl;
+      }
+    }
+  };
+
+} // namespace
+
+SAMPLE(BlobTransferBenchmark, BlobTransferBenchmark)
+void BlobTransferBenchmark()
+{
+  using namespace Azure::Storage::Blobs;
+
+  const int64_t blobCount = GetEnvInt64("AZURE_STORAGE_BENCHMARK_BLOB_COUNT", 4);
+  const int64_t blobSize = GetEnvInt64("AZURE_STORAGE_BENCHMARK_BLOB_SIZE", 64 * 1024 * 1024);
+  const int concurrency = static_cast<int>(GetEnvInt64("AZURE_STORAGE_BENCHMARK_CONCURRENCY", 4));
+  const auto chunkSize = GetEnvInt64("AZURE_STORAGE_BENCHMARK_CHUNK_SIZE");
+  const auto initialChunkSize = GetEnvInt64("AZURE_STORAGE_BENCHMARK_INITIAL_CHUNK_SIZE");
+  const bool autoTune = GetEnvInt64("AZURE_STORAGE_BENCHMARK_AUTO_TUNE", 0) != 0;
+  const bool memoryMapFile = GetEnvInt64("AZURE_STORAGE_BENCHMARK_MEMORY_MAP_FILE", 0) != 0;
+
+  printf(
+      "blobs %lld, size %lld bytes, concurrency %d, chunk size %s, initial chunk size %s, auto "
+      "tune %s\n",
+      static_cast<long long>(blobCount),
+      static_cast<long long>(blobSize),
+      concurrency,
+      chunkSize.HasValue() ? std::to_string(chunkSize.GetValue()).data() : "default",
+      initialChunkSize.HasValue() ? std::to_string(initialChunkSize.GetValue()).data()
+                                  : "default",
+      autoTune ? "on" : "off");
+
+  auto recorder = std::make_shared<LatencyRecorder>();
+  BlobContainerClientOptions clientOptions;
+  clientOptions.PerRetryPolicies.emplace_back(std::make_unique<ChunkLatencyPolicy>(recorder));
+
+  std::string containerName = "benchmark-" + std::to_string(std::random_device()());
+  auto containerClient = BlobContainerClient::CreateFromConnectionString(
+      GetConnectionString(), containerName, clientOptions);
+  containerClient.Create();
+  ContainerDeleter containerDeleter{containerClient};
+
+  std::vector<uint8_t> content(static_cast<std::size_t>(blobSize));
+  for (std::size_t i = 0; i < content.size(); ++i)
+  {
+    content[i] = static_cast<uint8_t>(i * 2654435761ULL >> 24);
+  }
+  std::vector<std::string> blobNames;
+  for (int64_t i = 0; i < blobCount; ++i)
+  {
+    blobNames.emplace_back("benchmark-blob-" + std::to_string(i));
+  }
+  const int64_t totalBytes = blobCount * blobSize;
+
+  UploadBlobOptions uploadOptions;
+  uploadOptions.Concurrency = concurrency;
+  uploadOptions.ChunkSize = chunkSize;
+  uploadOptions.AutoTune = autoTune;
+  uploadOptions.MemoryMapFile = memoryMapFile;
+
+  DownloadBlobToBufferOptions downloadOptions;
+  downloadOptions.Concurrency = concurrency;
+  downloadOptions.ChunkSize = chunkSize;
+  downloadOptions.InitialChunkSize = initialChunkSize;
+  downloadOptions.AutoTune = autoTune;
+
+  RunPhase("UploadFromBuffer", totalBytes, *recorder, [&]() {
+    for (const auto& blobName : blobNames)
+    {
+      containerClient.GetBlockBlobClient(blobName).UploadFromBuffer(
+          content.data(), content.size(), uploadOptions);
+    }
+  });
+
+  std::vector<uint8_t> downloadBuffer(content.size());
+  RunPhase("DownloadToBuffer", totalBytes, *recorder, [&]() {
+    for (const auto& blobName : blobNames)
+    {
+      containerClient.GetBlobClient(blobName).DownloadToBuffer(
+          downloadBuffer.data(), downloadBuffer.size(), downloadOptions);
+    }
+  });
+  if (downloadBuffer != content)
+  {
+    throw std::runtime_error("downloaded content doesn't match uploaded content");
+  }
+
+  std::string sourceFile = "benchmark-source-file";
+  std::string destinationFile = "benchmark-destination-file";
+  {
+    FILE* fout = std::fopen(sourceFile.data(), "wb");
+    if (!fout)
+    {
+      throw std::runtime_error("failed to open file");
+    }
+    std::fwrite(content.data(), 1, content.size(), fout);
+    std::fclose(fout);
+  }
+
+  RunPhase("UploadFromFile", totalBytes, *recorder, [&]() {
+    for (const auto& blobName : blobNames)
+    {
+      containerClient.GetBlockBlobClient(blobName).UploadFromFile(sourceFile, uploadOptions);
+    }
+  });
+
+  RunPhase("DownloadToFile", totalBytes, *recorder, [&]() {
+    for (const auto& blobName : blobNames)
+    {
+      containerClient.GetBlobClient(blobName).DownloadToFile(destinationFile, downloadOptions);
+    }
+  });
+
+  std::remove(sourceFile.data());
+  std::remove(destinationFile.data());
+}
@@ -4,6 +4,7 @@
 #include "blobs/append_blob_client.hpp"
 
 #include "common/constants.hpp"
+#include "common/hashing_body_stream.hpp"
 #include "common/storage_common.hpp"
 
 namespace Azure { namespace Storage { namespace Blobs {
@@ -86,6 +87,14 @@ namespace Azure { namespace Storage { namespace Blobs {
     protocolLayerOptions.IfUnmodifiedSince = options.Conditions.IfUnmodifiedSince;
     protocolLayerOptions.IfMatch = options.Conditions.IfMatch;
     protocolLayerOptions.IfNoneMatch = options.Conditions.IfNoneMatch;
+    if (options.ValidateContentHash)
+    {
+      HashingBodyStream hashingStream(&content, true, true);
+      auto response = BlobRestClient::AppendBlob::AppendBlock(
+          options.Context, *m_pipeline, m_blobUrl.ToString(), hashingStream, protocolLayerOptions);
+      hashingStream.Verify(response.ContentMD5, response.ContentCRC64);
+      return response;
+    }
     return BlobRestClient::AppendBlob::AppendBlock(
         options.Context, *m_pipeline, m_blobUrl.ToString(), content, protocolLayerOptions);
   }
@@ -0,0 +1,438 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "blobs/blob_batch_client.hpp"
+
+#include "common/common_headers_request_policy.hpp"
+#include "common/concurrent_transfer.hpp"
+#include "common/shared_key_policy.hpp"
+#include "common/storage_common.hpp"
+#include "common/storage_error.hpp"
+#include "http/curl/curl.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+namespace Azure { namespace Storage { namespace Blobs {
+
+  namespace {
+    // Last policy of the pipeline that signs the operations of a batch. The signed requests are
+    // written into the batch body instead of being sent.
+    class SubRequestSinkPolicy : public Azure::Core::Http::HttpPolicy {
+    public:
+      HttpPolicy* Clone() const override { return new SubRequestSinkPolicy(); }
+
+      std::unique_ptr<Azure::Core::Http::Response> Send(
+          Azure::Core::Context&,
+          Azure::Core::Http::Request&,
+          Azure::Core::Http::NextHttpPolicy) const override
+      {
+        return nullptr;
+      }
+    };
+
+    std::string CreateBoundary()
+    {
+      thread_local std::mt19937_64 random(std::random_device{}());
+      uint64_t high = random();
+      uint64_t low = random();
+      char boundary[64];
+      std::snprintf(
+          boundary,
+          sizeof(boundary),
+          "batch_%08x-%04x-%04x-%04x-%012llx",
+          static_cast<unsigned int>(high >> 32),
+          static_cast<unsigned int>((high >> 16) & 0xffff),
+          static_cast<unsigned int>(high & 0xffff),
+          static_cast<unsigned int>(low >> 48),
+          static_cast<unsigned long long>(low & 0xffffffffffffULL));
+      return boundary;
+    }
+
+    // An operation of a batch goes without x-ms-version, the one of the batch request applies.
+    Azure::Core::Http::Request CreateSubRequest(const Azure::Core::Http::Request& request)
+    {
+      Azure::Core::Http::Request subRequest(request.GetMethod(), request.GetEncodedUrl());
+      for (const auto& header : request.GetHeaders())
+      {
+        if (header.first != "x-ms-version")
+        {
+          subRequest.AddHeader(header.first, header.second);
+        }
+      }
+      return subRequest;
+    }
+
+    std::string ToLower(std::string s)
+    {
+      std::transform(s.begin(), s.end(), s.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      });
+      return s;
+    }
+
+    std::string Trim(const std::string& s, std::size_t begin, std::size_t end)
+    {
+      while (begin < end && (s[begin] == ' ' || s[begin] == '\t'))
+      {
+        ++begin;
+      }
+      while (end > begin && (s[end - 1] == ' ' || s[end - 1] == '\t' || s[end - 1] == '\r'))
+      {
+        --end;
+      }
+      return s.substr(begin, end - begin);
+    }
+
+    // Parses the header lines in [begin, end) of body, names are turned to lower case.
+    std::map<std::string, std::string> ParseHeaders(
+        const std::string& body,
+        std::size_t begin,
+        std::size_t end)
+    {
+      std::map<std::string, std::string> headers;
+      while (begin < end)
+      {
+        std::size_t lineEnd = std::min(body.find('\n', begin), end);
+        std::size_t colon = body.find(':', begin);
+        if (colon < lineEnd)
+        {
+          headers[ToLower(Trim(body, begin, colon))] = Trim(body, colon + 1, lineEnd);
+        }
+        begin = lineEnd + 1;
+      }
+      return headers;
+    }
+
+    // Returns the position after the empty line that ends the header lines starting at begin.
+    std::size_t FindHeadersEnd(const std::string& body, std::size_t begin, std::size_t end)
+    {
+      std::size_t pos = body.find("\r\n\r\n", begin);
+      return pos < end ? pos + 4 : end;
+    }
+
+    // Reads the responses to the operations of a batch out of a multipart/mixed body. Every part
+    // holds an HTTP response, the Content-ID of the part is the index of the operation.
+    std::vector<BlobBatchItemResult> ParseBatchResponse(
+        const std::string& body,
+        const std::string& boundary,
+        std::size_t numOperations)
+    {
+      std::vector<BlobBatchItemResult> results(numOperations);
+      std::vector<bool> received(numOperations, false);
+      const std::string delimiter = "--" + boundary;
+
+      std::size_t pos = body.find(delimiter);
+      while (pos != std::string::npos)
+      {
+        pos += delimiter.length();
+        if (body.compare(pos, 2, "--") == 0)
+        {
+          break;
+        }
+        pos = std::min(body.find('\n', pos), body.length());
+        pos = std::min(pos + 1, body.length());
+        std::size_t partEnd = std::min(body.find(delimiter, pos), body.length());
+
+        std::size_t responseBegin = FindHeadersEnd(body, pos, partEnd);
+        auto partHeaders = ParseHeaders(body, pos, responseBegin);
+        std::size_t statusLineEnd = std::min(body.find('\n', responseBegin), partEnd);
+        std::size_t responseHeadersEnd = FindHeadersEnd(body, statusLineEnd, partEnd);
+        auto responseHeaders = ParseHeaders(body, statusLineEnd + 1, responseHeadersEnd);
+
+        // HTTP/1.1 202 Accepted
+        std::string statusLine = Trim(body, responseBegin, statusLineEnd);
+        std::size_t codeBegin = statusLine.find(' ');
+        if (statusLine.compare(0, 5, "HTTP/") != 0 || codeBegin == std::string::npos)
+        {
+          throw std::runtime_error("unexpected response in blob batch: " + statusLine);
+        }
+        std::size_t codeEnd = std::min(statusLine.find(' ', codeBegin + 1), statusLine.length());
+        BlobBatchItemResult result;
+        result.StatusCode = static_cast<Azure::Core::Http::HttpStatusCode>(
+            std::stoi(statusLine.substr(codeBegin + 1, codeEnd - codeBegin - 1)));
+        result.ReasonPhrase
+            = Trim(statusLine, std::min(codeEnd + 1, statusLine.length()), statusLine.length());
+        auto ite = responseHeaders.find("x-ms-error-code");
+        if (ite != responseHeaders.end())
+        {
+          result.ErrorCode = ite->second;
+        }
+        ite = responseHeaders.find("x-ms-request-id");
+        if (ite != responseHeaders.end())
+        {
+          result.RequestId = ite->second;
+        }
+
+        ite = partHeaders.find("content-id");
+        if (ite == partHeaders.end())
+        {
+          // The service answers with a single part without Content-ID when it rejects the batch
+          // as a whole, because the batch request is malformed or can't be authorized, say.
+          StorageError error(
+              std::to_string(static_cast<int>(result.StatusCode)) + " " + result.ReasonPhrase
+              + "\nRequest ID: " + result.RequestId);
+          error.StatusCode = result.StatusCode;
+          error.ReasonPhrase = result.ReasonPhrase;
+          error.RequestId = result.RequestId;
+          error.ErrorCode = result.ErrorCode;
+          error.Message = result.ReasonPhrase;
+          throw error;
+        }
+        std::size_t index = static_cast<std::size_t>(std::stoull(ite->second));
+        if (index >= numOperations || received[index])
+        {
+          throw std::runtime_error("unexpected Content-ID in blob batch response: " + ite->second);
+        }
+        results[index] = std::move(result);
+        received[index] = true;
+
+        pos = partEnd == body.length() ? std::string::npos : partEnd;
+      }
+
+      if (std::find(received.begin(), received.end(), false) != received.end())
+      {
+        throw std::runtime_error("blob batch response misses the results of some operations");
+      }
+      return results;
+    }
+  } // namespace
+
+  constexpr std::size_t BlobBatch::MaximumSize;
+
+  void BlobBatch::AddOperation(Operation operation)
+  {
+    if (m_operations.size() >= MaximumSize)
+    {
+      throw std::runtime_error(
+          "a blob batch can't have more than " + std::to_string(MaximumSize) + " operations");
+    }
+    m_operations.emplace_back(std::move(operation));
+  }
+
+  std::size_t BlobBatch::DeleteBlob(
+      const std::string& containerName,
+      const std::string& blobName,
+      const DeleteBlobOptions& options)
+  {
+    Operation operation;
+    operation.Type = OperationType::Delete;
+    operation.ContainerName = containerName;
+    operation.BlobName = blobName;
+    operation.DeleteOptions = options;
+    AddOperation(std::move(operation));
+    return m_operations.size() - 1;
+  }
+
+  std::size_t BlobBatch::SetBlobAccessTier(
+      const std::string& containerName,
+      const std::string& blobName,
+      AccessTier tier,
+      const SetAccessTierOptions& options)
+  {
+    Operation operation;
+    operation.Type = OperationType::SetAccessTier;
+    operation.ContainerName = containerName;
+    operation.BlobName = blobName;
+    operation.Tier = tier;
+    operation.TierOptions = options;
+    AddOperation(std::move(operation));
+    return m_operations.size() - 1;
+  }
+
+  BlobBatchClient BlobBatchClient::CreateFromConnectionString(
+      const std::string& connectionString,
+      const BlobBatchClientOptions& options)
+  {
+    auto parsedConnectionString = Details::ParseConnectionString(connectionString);
+    auto serviceUri = std::move(parsedConnectionString.BlobServiceUri);
+
+    if (parsedConnectionString.KeyCredential)
+    {
+      return BlobBatchClient(serviceUri.ToString(), parsedConnectionString.KeyCredential, options);
+    }
+    else
+    {
+      return BlobBatchClient(serviceUri.ToString(), options);
+    }
+  }
+
+  BlobBatchClient::BlobBatchClient(
+      const std::string& serviceUri,
+      std::shared_ptr<SharedKeyCredential> credential,
+      const BlobBatchClientOptions& options)
+      : m_serviceUrl(serviceUri)
+  {
+    std::vector<std::unique_ptr<Azure::Core::Http::HttpPolicy>> policies;
+    for (const auto& p : options.PerOperationPolicies)
+    {
+      policies.emplace_back(std::unique_ptr<Azure::Core::Http::HttpPolicy>(p->Clone()));
+    }
+    // TODO: Retry policy goes here
+    for (const auto& p : options.PerRetryPolicies)
+    {
+      policies.emplace_back(std::unique_ptr<Azure::Core::Http::HttpPolicy>(p->Clone()));
+    }
+    policies.emplace_back(std::make_unique<CommonHeadersRequestPolicy>());
+    policies.emplace_back(std::make_unique<SharedKeyPolicy>(credential));
+    policies.emplace_back(std::make_unique<Azure::Core::Http::TransportPolicy>(
+        std::make_shared<Azure::Core::Http::CurlTransport>()));
+    m_pipeline = std::make_shared<Azure::Core::Http::HttpPipeline>(policies);
+
+    std::vector<std::unique_ptr<Azure::Core::Http::HttpPolicy>> subRequestPolicies;
+    subRequestPolicies.emplace_back(std::make_unique<CommonHeadersRequestPolicy>());
+    subRequestPolicies.emplace_back(std::make_unique<SharedKeyPolicy>(credential));
+    subRequestPolicies.emplace_back(std::make_unique<SubRequestSinkPolicy>());
+    m_subRequestPipeline = std::make_shared<Azure::Core::Http::HttpPipeline>(subRequestPolicies);
+  }
+
+  BlobBatchClient::BlobBatchClient(
+      const std::string& serviceUri,
+      const BlobBatchClientOptions& options)
+      : m_serviceUrl(serviceUri)
+  {
+    std::vector<std::unique_ptr<Azure::Core::Http::HttpPolicy>> policies;
+    for (const auto& p : options.PerOperationPolicies)
+    {
+      policies.emplace_back(std::unique_ptr<Azure::Core::Http::HttpPolicy>(p->Clone()));
+    }
+    // TODO: Retry policy goes here
+    for (const auto& p : options.PerRetryPolicies)
+    {
+      policies.emplace_back(std::unique_ptr<Azure::Core::Http::HttpPolicy>(p->Clone()));
+    }
+    policies.emplace_back(std::make_unique<CommonHeadersRequestPolicy>());
+    policies.emplace_back(std::make_unique<Azure::Core::Http::TransportPolicy>(
+        std::make_shared<Azure::Core::Http::CurlTransport>()));
+    m_pipeline = std::make_shared<Azure::Core::Http::HttpPipeline>(policies);
+
+    // Operations carry the SAS token of serviceUri in their URLs.
+    std::vector<std::unique_ptr<Azure::Core::Http::HttpPolicy>> subRequestPolicies;
+    subRequestPolicies.emplace_back(std::make_unique<CommonHeadersRequestPolicy>());
+    subRequestPolicies.emplace_back(std::make_unique<SubRequestSinkPolicy>());
+    m_subRequestPipeline = std::make_shared<Azure::Core::Http::HttpPipeline>(subRequestPolicies);
+  }
+
+  SubmitBlobBatchResult BlobBatchClient::SubmitBatch(
+      const BlobBatch& batch,
+      const SubmitBlobBatchOptions& options) const
+  {
+    if (batch.Size() == 0)
+    {
+      throw std::runtime_error("a blob batch must have at least one operation");
+    }
+
+    const std::string boundary = CreateBoundary();
+    std::string body;
+    Azure::Core::Context context = options.Context;
+    for (std::size_t i = 0; i < batch.m_operations.size(); ++i)
+    {
+      const auto& operation = batch.m_operations[i];
+      auto blobUri = m_serviceUrl;
+      blobUri.AppendPath(operation.ContainerName, true);
+      blobUri.AppendPath(operation.BlobName, true);
+
+      BodyStreamPointer pRequestBody;
+      std::unique_ptr<Azure::Core::Http::Request> request;
+      if (operation.Type == BlobBatch::OperationType::Delete)
+      {
+        BlobRestClient::Blob::DeleteOptions protocolLayerOptions;
+        protocolLayerOptions.DeleteSnapshots = operation.DeleteOptions.DeleteSnapshots;
+        protocolLayerOptions.LeaseId = operation.DeleteOptions.Conditions.LeaseId;
+        protocolLayerOptions.IfModifiedSince = operation.DeleteOptions.Conditions.IfModifiedSince;
+        protocolLayerOptions.IfUnmodifiedSince
+            = operation.DeleteOptions.Conditions.IfUnmodifiedSince;
+        protocolLayerOptions.IfMatch = operation.DeleteOptions.Conditions.IfMatch;
+        protocolLayerOptions.IfNoneMatch = operation.DeleteOptions.Conditions.IfNoneMatch;
+        request = std::make_unique<Azure::Core::Http::Request>(
+            CreateSubRequest(BlobRestClient::Blob::DeleteConstructRequest(
+                blobUri.ToString(), pRequestBody, protocolLayerOptions)));
+      }
+      else
+      {
+        BlobRestClient::Blob::SetAccessTierOptions protocolLayerOptions;
+        protocolLayerOptions.Tier = operation.Tier;
+        protocolLayerOptions.RehydratePriority = operation.TierOptions.RehydratePriority;
+        request = std::make_unique<Azure::Core::Http::Request>(
+            CreateSubRequest(BlobRestClient::Blob::SetAccessTierConstructRequest(
+                blobUri.ToString(), pRequestBody, protocolLayerOptions)));
+      }
+      m_subRequestPipeline->Send(context, *request);
+
+      body += "--" + boundary + "\r\n";
+      body += "Content-Type: application/http\r\n";
+      body += "Content-Transfer-Encoding: binary\r\n";
+      body += "Content-ID: " + std::to_string(i) + "\r\n\r\n";
+      body += request->GetHTTPMessagePreBody();
+    }
+    body += "--" + boundary + "--\r\n";
+
+    Azure::Core::Http::MemoryBodyStream bodyStream(
+        reinterpret_cast<const uint8_t*>(body.data()), static_cast<int64_t>(body.length()));
+    Azure::Core::Http::Request request(
+        Azure::Core::Http::HttpMethod::Post, m_serviceUrl.ToString(), &bodyStream);
+    request.AddQueryParameter("comp", "batch");
+    request.AddHeader("Content-Type", "multipart/mixed; boundary=" + boundary);
+    request.AddHeader("Content-Length", std::to_string(body.length()));
+    request.AddHeader("x-ms-version", "2019-07-07");
+    auto pResponse = m_pipeline->Send(context, request);
+
+    Azure::Core::Http::Response& httpResponse = *pResponse;
+    if (httpResponse.GetStatusCode() != Azure::Core::Http::HttpStatusCode::Accepted)
+    {
+      throw StorageError::CreateFromResponse(std::move(pResponse));
+    }
+    const auto& headers = httpResponse.GetHeaders();
+    SubmitBlobBatchResult result;
+    result.RequestId = headers.at("x-ms-request-id");
+    result.Version = headers.at("x-ms-version");
+    result.Date = headers.at("Date");
+
+    const std::string& contentType = headers.at("Content-Type");
+    std::size_t boundaryBegin = contentType.find("boundary=");
+    if (boundaryBegin == std::string::npos)
+    {
+      throw std::runtime_error("unexpected blob batch response type: " + contentType);
+    }
+    boundaryBegin += 9;
+    std::size_t boundaryEnd = std::min(contentType.find(';', boundaryBegin), contentType.length());
+    std::string responseBoundary = contentType.substr(boundaryBegin, boundaryEnd - boundaryBegin);
+    if (responseBoundary.length() >= 2 && responseBoundary.front() == '"'
+        && responseBoundary.back() == '"')
+    {
+      responseBoundary = responseBoundary.substr(1, responseBoundary.length() - 2);
+    }
+
+    auto responseBodyStream = httpResponse.GetBodyStream();
+    auto responseBody = Azure::Core::Http::BodyStream::ReadToEnd(context, *responseBodyStream);
+    result.Results = ParseBatchResponse(
+        std::string(responseBody.begin(), responseBody.end()),
+        responseBoundary,
+        batch.Size());
+    return result;
+  }
+
+  std::vector<SubmitBlobBatchResult> BlobBatchClient::SubmitBatches(
+      const std::vector<BlobBatch>& batches,
+      const SubmitBlobBatchesOptions& options) const
+  {
+    std::vector<SubmitBlobBatchResult> results(batches.size());
+    Details::ConcurrentTransfer(
+        options.Context,
+        0,
+        static_cast<int64_t>(batches.size()),
+        1,
+        options.Concurrency,
+        [&](Azure::Core::Context& context, int64_t, int64_t, int64_t batchId, int64_t) {
+          SubmitBlobBatchOptions batchOptions;
+          batchOptions.Context = context;
+          results[static_cast<std::size_t>(batchId)]
+              = SubmitBatch(batches[static_cast<std::size_t>(batchId)], batchOptions);
+        });
+    return results;
+  }
+
+}}} // namespace Azure::Storage::Blobs
@@ -9,13 +9,36 @@
 #include "common/common_headers_request_policy.hpp"
 #include "common/concurrent_transfer.hpp"
 #include "common/constants.hpp"
+#include "common/crypt.hpp"
 #include "common/file_io.hpp"
+#include "common/hashing_body_stream.hpp"
+#include "common/read_ahead_body_stream.hpp"
+#include "common/retriable_body_stream.hpp"
 #include "common/shared_key_policy.hpp"
 #include "common/storage_common.hpp"
+#include "common/transfer_auto_tuner.hpp"
+#include "common/transfer_governor.hpp"
+#include "common/transfer_journal.hpp"
 #include "http/curl/curl.hpp"
 
+#include <limits>
+#include <set>
+
 namespace Azure { namespace Storage { namespace Blobs {
 
+  namespace {
+    // The service only returns checksums of ranges up to this size.
+    constexpr int64_t c_maximumChecksumRangeSize = 4 * 1024 * 1024;
+
+    void VerifyCrc64(const Azure::Core::Nullable<std::string>& expected, const Crc64& crc64)
+    {
+      if (!expected.HasValue() || Base64Decode(expected.GetValue()) != crc64.Digest())
+      {
+        throw std::runtime_error("CRC64 of the downloaded range doesn't match");
+      }
+    }
+  } // namespace
+
   BlobClient BlobClient::CreateFromConnectionString(
       const std::string& connectionString,
       const std::string& containerName,
@@ -137,14 +160,56 @@ namespace Azure { namespace Storage { namespace Blobs {
           options.Offset.GetValue(),
           std::numeric_limits<std::remove_reference_t<decltype(options.Offset.GetValue())>>::max());
     }
+    protocolLayerOptions.RangeGetContentMD5 = options.RangeGetContentMD5;
+    protocolLayerOptions.RangeGetContentCRC64 = options.RangeGetContentCRC64;
     protocolLayerOptions.LeaseId = options.Conditions.LeaseId;
     protocolLayerOptions.IfModifiedSince = options.Conditions.IfModifiedSince;
     protocolLayerOptions.IfUnmodifiedSince = options.Conditions.IfUnmodifiedSince;
     protocolLayerOptions.IfMatch = options.Conditions.IfMatch;
     protocolLayerOptions.IfNoneMatch = options.Conditions.IfNoneMatch;
 
-    return BlobRestClient::Blob::Download(
+    auto response = BlobRestClient::Blob::Download(
         options.Context, *m_pipeline, m_blobUrl.ToString(), protocolLayerOptions);
+    if (options.MaximumBodyRetries > 0)
+    {
+      // The rest of the content is requested from the version of the blob this response is from.
+      BlobClient blobClient = *this;
+      int64_t offset = options.Offset.HasValue() ? options.Offset.GetValue() : 0;
+      Azure::Core::Nullable<int64_t> length = options.Length;
+      if (!options.Offset.HasValue())
+      {
+        length.Reset();
+      }
+      Azure::Core::Nullable<std::string> leaseId = options.Conditions.LeaseId;
+      std::string eTag = response.ETag;
+      response.BodyStream = std::make_unique<Details::RetriableBodyStream>(
+          std::move(response.BodyStream),
+          [blobClient, offset, length, leaseId, eTag](
+              Azure::Core::Context& context, int64_t position) {
+            DownloadBlobOptions resumeOptions;
+            resumeOptions.Context = context;
+            resumeOptions.Offset = offset + position;
+            if (length.HasValue())
+            {
+              resumeOptions.Length = length.GetValue() - position;
+            }
+            resumeOptions.Conditions.LeaseId = leaseId;
+            resumeOptions.Conditions.IfMatch = eTag;
+            resumeOptions.MaximumBodyRetries = 0;
+            return std::move(blobClient.Download(resumeOptions).BodyStream);
+          },
+          options.MaximumBodyRetries);
+    }
+    if (options.ValidateContentHash)
+    {
+      auto hashingStream = std::make_unique<HashingBodyStream>(
+          std::move(response.BodyStream),
+          response.ContentMD5.HasValue(),
+          response.ContentCRC64.HasValue());
+      hashingStream->VerifyOnCompletion(response.ContentMD5, response.ContentCRC64);
+      response.BodyStream = std::move(hashingStream);
+    }
+    return response;
   }
 
   BlobDownloadInfo BlobClient::DownloadToBuffer(
@@ -171,12 +236,41 @@ namespace Azure { namespace Storage { namespace Blobs {
     DownloadBlobOptions firstChunkOptions;
     firstChunkOptions.Context = options.Context;
     firstChunkOptions.Offset = options.Offset;
+    if (options.TransactionalCRC64)
+    {
+      // Checksums are only returned for ranges.
+      firstChunkLength = std::min(firstChunkLength, c_maximumChecksumRangeSize);
+      firstChunkOptions.Offset = firstChunkOffset;
+      firstChunkOptions.RangeGetContentCRC64 = true;
+    }
     if (firstChunkOptions.Offset.HasValue())
     {
       firstChunkOptions.Length = firstChunkLength;
     }
+    auto downloadFirstChunk = [&]() {
+      try
+      {
+        return Download(firstChunkOptions);
+      }
+      catch (StorageError& e)
+      {
+        // An empty blob has no range to download, nor a checksum to verify.
+        if (options.Offset.HasValue() || !firstChunkOptions.RangeGetContentCRC64.HasValue()
+            || e.StatusCode != Azure::Core::Http::HttpStatusCode::RangeNotSatisfiable)
+        {
+          throw;
+        }
+      }
+      firstChunkOptions.Offset.Reset();
+      firstChunkOptions.Length.Reset();
+      firstChunkOptions.RangeGetContentCRC64.Reset();
+      return Download(firstChunkOptions);
+    };
 
-    auto firstChunk = Download(firstChunkOptions);
+    Details::GovernedTransfer governedTransfer;
+    auto firstChunkPermit = governedTransfer.Acquire(firstChunkOptions.Context, 0);
+
+    auto firstChunk = downloadFirstChunk();
 
     int64_t blobSize;
     int64_t blobRangeSize;
@@ -209,7 +303,14 @@ namespace Azure { namespace Storage { namespace Blobs {
     {
       throw std::runtime_error("error when reading body stream");
     }
+    if (firstChunkOptions.RangeGetContentCRC64.HasValue())
+    {
+      Crc64 crc64;
+      crc64.Update(buffer, static_cast<std::size_t>(firstChunkLength));
+      VerifyCrc64(firstChunk.ContentCRC64, crc64);
+    }
     firstChunk.BodyStream.reset();
+    firstChunkPermit.Release();
 
     auto returnTypeConverter = [](BlobDownloadResponse& response) {
       BlobDownloadInfo ret;
@@ -224,32 +325,42 @@ namespace Azure { namespace Storage { namespace Blobs {
     };
     BlobDownloadInfo ret = returnTypeConverter(firstChunk);
 
+    int64_t remainingOffset = firstChunkOffset + firstChunkLength;
+    int64_t remainingSize = blobRangeSize - firstChunkLength;
+
     // Keep downloading the remaining in parallel
-    auto downloadChunkFunc
-        = [&](int64_t offset, int64_t length, int64_t chunkId, int64_t numChunks) {
-            DownloadBlobOptions chunkOptions;
-            chunkOptions.Context = options.Context;
-            chunkOptions.Offset = offset;
-            chunkOptions.Length = length;
-            auto chunk = Download(chunkOptions);
-            int64_t bytesRead = Azure::Core::Http::BodyStream::ReadToCount(
-                chunkOptions.Context,
-                *chunk.BodyStream,
-                buffer + (offset - firstChunkOffset),
-                chunkOptions.Length.GetValue());
-            if (bytesRead != chunkOptions.Length.GetValue())
-            {
-              throw std::runtime_error("error when reading body stream");
-            }
+    auto downloadChunkFunc = [&](Azure::Core::Context& context, int64_t offset, int64_t length) {
+      DownloadBlobOptions chunkOptions;
+      chunkOptions.Context = context;
+      chunkOptions.Offset = offset;
+      chunkOptions.Length = length;
+      if (options.TransactionalCRC64)
+      {
+        chunkOptions.RangeGetContentCRC64 = true;
+      }
+      auto chunk = Download(chunkOptions);
+      int64_t bytesRead = Azure::Core::Http::BodyStream::ReadToCount(
+          chunkOptions.Context,
+          *chunk.BodyStream,
+          buffer + (offset - firstChunkOffset),
+          chunkOptions.Length.GetValue());
+      if (bytesRead != chunkOptions.Length.GetValue())
+      {
+        throw std::runtime_error("error when reading body stream");
+      }
+      if (options.TransactionalCRC64)
+      {
+        Crc64 crc64;
+        crc64.Update(buffer + (offset - firstChunkOffset), static_cast<std::size_t>(length));
+        VerifyCrc64(chunk.ContentCRC64, crc64);
+      }
 
-            if (chunkId == numChunks - 1)
-            {
-              ret = returnTypeConverter(chunk);
-            }
-          };
+      if (offset + length == remainingOffset + remainingSize)
+      {
+        ret = returnTypeConverter(chunk);
+      }
+    };
 
-    int64_t remainingOffset = firstChunkOffset + firstChunkLength;
-    int64_t remainingSize = blobRangeSize - firstChunkLength;
     int64_t chunkSize;
     if (options.ChunkSize.HasValue())
     {
@@ -262,9 +373,51 @@ namespace Azure { namespace Storage { namespace Blobs {
       chunkSize = (std::max(chunkSize, int64_t(1)) + c_grainSize - 1) / c_grainSize * c_grainSize;
       chunkSize = std::min(chunkSize, c_defaultChunkSize);
     }
+    if (options.TransactionalCRC64)
+    {
+      chunkSize = std::min(chunkSize, c_maximumChecksumRangeSize);
+    }
 
-    Details::ConcurrentTransfer(
-        remainingOffset, remainingSize, chunkSize, options.Concurrency, downloadChunkFunc);
+    if (options.AutoTune)
+    {
+      // Upper bound of the tuned chunk size when ChunkSize isn't set.
+      constexpr int64_t c_maximumAutoTuneChunkSize = 64 * 1024 * 1024;
+      int64_t maxChunkSize = c_maximumAutoTuneChunkSize;
+      if (options.ChunkSize.HasValue())
+      {
+        maxChunkSize = options.ChunkSize.GetValue();
+      }
+      if (options.TransactionalCRC64)
+      {
+        maxChunkSize = std::min(maxChunkSize, c_maximumChecksumRangeSize);
+      }
+      Details::TransferAutoTuner tuner(
+          m_blobUrl.GetHost() + "/download",
+          std::min(c_defaultChunkSize, maxChunkSize),
+          maxChunkSize,
+          options.Concurrency);
+      Details::AdaptiveConcurrentTransfer(
+          options.Context,
+          remainingOffset,
+          remainingSize,
+          std::numeric_limits<int64_t>::max(),
+          tuner,
+          [&](Azure::Core::Context& context, int64_t offset, int64_t length, int64_t) {
+            downloadChunkFunc(context, offset, length);
+          });
+    }
+    else
+    {
+      Details::ConcurrentTransfer(
+          options.Context,
+          remainingOffset,
+          remainingSize,
+          chunkSize,
+          options.Concurrency,
+          [&](Azure::Core::Context& context, int64_t offset, int64_t length, int64_t, int64_t) {
+            downloadChunkFunc(context, offset, length);
+          });
+    }
     ret.ContentLength = blobRangeSize;
     return ret;
   }
@@ -292,14 +445,43 @@ namespace Azure { namespace Storage { namespace Blobs {
     DownloadBlobOptions firstChunkOptions;
     firstChunkOptions.Context = options.Context;
     firstChunkOptions.Offset = options.Offset;
+    if (options.TransactionalCRC64)
+    {
+      // Checksums are only returned for ranges.
+      firstChunkLength = std::min(firstChunkLength, c_maximumChecksumRangeSize);
+      firstChunkOptions.Offset = firstChunkOffset;
+      firstChunkOptions.RangeGetContentCRC64 = true;
+    }
     if (firstChunkOptions.Offset.HasValue())
     {
       firstChunkOptions.Length = firstChunkLength;
     }
+    auto downloadFirstChunk = [&]() {
+      try
+      {
+        return Download(firstChunkOptions);
+      }
+      catch (StorageError& e)
+      {
+        // An empty blob has no range to download, nor a checksum to verify.
+        if (options.Offset.HasValue() || !firstChunkOptions.RangeGetContentCRC64.HasValue()
+            || e.StatusCode != Azure::Core::Http::HttpStatusCode::RangeNotSatisfiable)
+        {
+          throw;
+        }
+      }
+      firstChunkOptions.Offset.Reset();
+      firstChunkOptions.Length.Reset();
+      firstChunkOptions.RangeGetContentCRC64.Reset();
+      return Download(firstChunkOptions);
+    };
 
-    Details::FileWriter fileWriter(file);
+    constexpr int64_t c_stagingBufferSize = 4 * 1024 * 1024;
+    Details::GovernedTransfer governedTransfer;
+    auto firstChunkPermit = governedTransfer.Acquire(
+        firstChunkOptions.Context, std::min(firstChunkLength, c_stagingBufferSize));
 
-    auto firstChunk = Download(firstChunkOptions);
+    auto firstChunk = downloadFirstChunk();
 
     int64_t blobSize;
     int64_t blobRangeSize;
@@ -319,32 +501,119 @@ namespace Azure { namespace Storage { namespace Blobs {
       blobRangeSize = blobSize;
     }
     firstChunkLength = std::min(firstChunkLength, blobRangeSize);
+    int64_t remainingOffset = firstChunkOffset + firstChunkLength;
+    int64_t remainingSize = blobRangeSize - firstChunkLength;
+
+    int64_t chunkSize;
+    if (options.ChunkSize.HasValue())
+    {
+      chunkSize = options.ChunkSize.GetValue();
+    }
+    else
+    {
+      int64_t c_grainSize = 4 * 1024;
+      chunkSize = remainingSize / options.Concurrency;
+      chunkSize = (std::max(chunkSize, int64_t(1)) + c_grainSize - 1) / c_grainSize * c_grainSize;
+      chunkSize = std::min(chunkSize, c_defaultChunkSize);
+    }
+    if (options.TransactionalCRC64)
+    {
+      chunkSize = std::min(chunkSize, c_maximumChecksumRangeSize);
+    }
 
-    auto bodyStreamToFile = [](Azure::Core::Http::BodyStream& stream,
-                               Details::FileWriter& fileWriter,
-                               int64_t offset,
-                               int64_t length,
-                               Azure::Core::Context& context) {
-      constexpr std::size_t bufferSize = 4 * 1024 * 1024;
-      std::vector<uint8_t> buffer(bufferSize);
+    // Chunks written by an earlier attempt are kept if the blob is still the same version and
+    // they are still in the file. The first chunk is downloaded again anyway to learn the version.
+    std::unique_ptr<Details::TransferJournal> journal;
+    std::string eTag = firstChunk.ETag;
+    if (options.JournalFile.HasValue())
+    {
+      journal = std::make_unique<Details::TransferJournal>(
+          options.JournalFile.GetValue(),
+          "download " + m_blobUrl.GetHost() + "/" + m_blobUrl.GetPath() + " " + file + " " + eTag
+              + " " + std::to_string(firstChunkOffset) + " " + std::to_string(blobRangeSize) + " "
+              + std::to_string(firstChunkLength) + " " + std::to_string(chunkSize));
+      if (!journal->GetCompletedChunks().empty())
+      {
+        int64_t fileSize = -1;
+        try
+        {
+          fileSize = Details::FileReader(file).GetFileSize();
+        }
+        catch (std::runtime_error&)
+        {
+        }
+        std::set<int64_t> completedChunks;
+        for (int64_t chunkId : journal->GetCompletedChunks())
+        {
+          if (std::min(firstChunkLength + (chunkId + 1) * chunkSize, blobRangeSize) <= fileSize)
+          {
+            completedChunks.insert(chunkId);
+          }
+        }
+        if (completedChunks != journal->GetCompletedChunks())
+        {
+          journal->SetCompletedChunks(std::move(completedChunks));
+        }
+      }
+    }
+
+    Details::FileWriter fileWriter(
+        file, options.DirectIo, !journal || journal->GetCompletedChunks().empty());
+    if (options.PreallocateFile)
+    {
+      fileWriter.Preallocate(blobRangeSize);
+    }
+
+    // Workers receive into pooled buffers and hand them to the write stage, so the next buffer can
+    // be received while the previous one is written. Two buffers per worker keep both sides busy,
+    // workers wait for a buffer when the disk falls behind.
+    Details::AlignedBufferPool bufferPool(
+        std::min(blobRangeSize, c_stagingBufferSize),
+        std::max(static_cast<int64_t>(options.Concurrency), int64_t(1)) * 2);
+    Details::FileWriteStage writeStage(fileWriter, &bufferPool, options.DropCacheAfterWrite);
+
+    auto bodyStreamToFile = [&bufferPool, &writeStage](
+                                Azure::Core::Http::BodyStream& stream,
+                                int64_t offset,
+                                int64_t length,
+                                Azure::Core::Context& context,
+                                Crc64* crc64) {
       while (length > 0)
       {
-        int64_t readSize = std::min(static_cast<int64_t>(bufferSize), length);
+        auto buffer = bufferPool.Acquire(context);
+        int64_t readSize = std::min(buffer.Size(), length);
         int64_t bytesRead
-            = Azure::Core::Http::BodyStream::ReadToCount(context, stream, buffer.data(), readSize);
+            = Azure::Core::Http::BodyStream::ReadToCount(context, stream, buffer.Data(), readSize);
         if (bytesRead != readSize)
         {
           throw std::runtime_error("error when reading body stream");
         }
-        fileWriter.Write(buffer.data(), bytesRead, offset);
+        if (crc64)
+        {
+          crc64->Update(buffer.Data(), static_cast<std::size_t>(bytesRead));
+        }
+        writeStage.Write(std::move(buffer), bytesRead, offset);
         length -= bytesRead;
         offset += bytesRead;
       }
     };
 
-    bodyStreamToFile(
-        *firstChunk.BodyStream, fileWriter, 0, firstChunkLength, firstChunkOptions.Context);
+    {
+      Crc64 crc64;
+      bool verifyCrc64 = firstChunkOptions.RangeGetContentCRC64.HasValue();
+      bodyStreamToFile(
+          *firstChunk.BodyStream,
+          0,
+          firstChunkLength,
+          firstChunkOptions.Context,
+          verifyCrc64 ? &crc64 : nullptr);
+      if (verifyCrc64)
+      {
+        VerifyCrc64(firstChunk.ContentCRC64, crc64);
+      }
+    }
     firstChunk.BodyStream.reset();
+    firstChunkPermit.Release();
 
     auto returnTypeConverter = [](BlobDownloadResponse& response) {
       BlobDownloadInfo ret;
@@ -360,43 +629,97 @@ namespace Azure { namespace Storage { namespace Blobs {
     BlobDownloadInfo ret = returnTypeConverter(firstChunk);
 
     // Keep downloading the remaining in parallel
-    auto downloadChunkFunc
-        = [&](int64_t offset, int64_t length, int64_t chunkId, int64_t numChunks) {
-            DownloadBlobOptions chunkOptions;
-            chunkOptions.Context = options.Context;
-            chunkOptions.Offset = offset;
-            chunkOptions.Length = length;
-            auto chunk = Download(chunkOptions);
-            bodyStreamToFile(
-                *chunk.BodyStream,
-                fileWriter,
-                offset - firstChunkOffset,
-                chunkOptions.Length.GetValue(),
-                chunkOptions.Context);
-
-            if (chunkId == numChunks - 1)
-            {
-              ret = returnTypeConverter(chunk);
-            }
-          };
+    auto downloadChunkFunc = [&](Azure::Core::Context& context,
+                                 int64_t offset,
+                                 int64_t length,
+                                 int64_t chunkId) {
+      if (journal && journal->IsCompleted(chunkId))
+      {
+        return;
+      }
+      DownloadBlobOptions chunkOptions;
+      chunkOptions.Context = context;
+      chunkOptions.Offset = offset;
+      chunkOptions.Length = length;
+      if (journal)
+      {
+        chunkOptions.Conditions.IfMatch = eTag;
+      }
+      if (options.TransactionalCRC64)
+      {
+        chunkOptions.RangeGetContentCRC64 = true;
+      }
+      auto chunk = Download(chunkOptions);
+      Crc64 crc64;
+      bodyStreamToFile(
+          *chunk.BodyStream,
+          offset - firstChunkOffset,
+          chunkOptions.Length.GetValue(),
+          chunkOptions.Context,
+          options.TransactionalCRC64 ? &crc64 : nullptr);
+      if (options.TransactionalCRC64)
+      {
+        VerifyCrc64(chunk.ContentCRC64, crc64);
+      }
+      if (journal)
+      {
+        // Only chunks that made it to the file may be recorded.
+        writeStage.WhenWritten([&journal, chunkId]() { journal->MarkCompleted(chunkId); });
+      }
 
-    int64_t remainingOffset = firstChunkOffset + firstChunkLength;
-    int64_t remainingSize = blobRangeSize - firstChunkLength;
-    int64_t chunkSize;
-    if (options.ChunkSize.HasValue())
+      if (offset + length == remainingOffset + remainingSize)
+      {
+        ret = returnTypeConverter(chunk);
+      }
+    };
+
+    if (options.AutoTune && !journal)
     {
-      chunkSize = options.ChunkSize.GetValue();
+      // Upper bound of the tuned chunk size when ChunkSize isn't set.
+      constexpr int64_t c_maximumAutoTuneChunkSize = 64 * 1024 * 1024;
+      int64_t maxChunkSize = c_maximumAutoTuneChunkSize;
+      if (options.ChunkSize.HasValue())
+      {
+        maxChunkSize = options.ChunkSize.GetValue();
+      }
+      if (options.TransactionalCRC64)
+      {
+        maxChunkSize = std::min(maxChunkSize, c_maximumChecksumRangeSize);
+      }
+      Details::TransferAutoTuner tuner(
+          m_blobUrl.GetHost() + "/download",
+          std::min(c_defaultChunkSize, maxChunkSize),
+          maxChunkSize,
+          options.Concurrency);
+      Details::AdaptiveConcurrentTransfer(
+          options.Context,
+          remainingOffset,
+          remainingSize,
+          std::numeric_limits<int64_t>::max(),
+          tuner,
+          downloadChunkFunc,
+          c_stagingBufferSize);
     }
     else
     {
-      int64_t c_grainSize = 4 * 1024;
-      chunkSize = remainingSize / options.Concurrency;
-      chunkSize = (std::max(chunkSize, int64_t(1)) + c_grainSize - 1) / c_grainSize * c_grainSize;
-      chunkSize = std::min(chunkSize, c_defaultChunkSize);
+      Details::ConcurrentTransfer(
+          options.Context,
+          remainingOffset,
+          remainingSize,
+          chunkSize,
+          options.Concurrency,
+          [&](Azure::Core::Context& context,
+              int64_t offset,
+              int64_t length,
+              int64_t chunkId,
+              int64_t) { downloadChunkFunc(context, offset, length, chunkId); },
+          std::min(chunkSize, c_stagingBufferSize));
+    }
+    writeStage.Flush();
+    if (journal)
+    {
+      journal->Remove();
     }
-
-    Details::ConcurrentTransfer(
-        remainingOffset, remainingSize, chunkSize, options.Concurrency, downloadChunkFunc);
     ret.ContentLength = blobRangeSize;
     return ret;
   }
@@ -488,6 +811,55 @@ namespace Azure { namespace Storage { namespace Blobs {
         options.Context, *m_pipeline, m_blobUrl.ToString(), protocolLayerOptions);
   }
 
+  std::unique_ptr<Azure::Core::Http::BodyStream> BlobClient::OpenRead(
+      const OpenReadBlobOptions& options) const
+  {
+    GetBlobPropertiesOptions getPropertiesOptions;
+    getPropertiesOptions.Context = options.Context;
+    getPropertiesOptions.Conditions = options.Conditions;
+    auto properties = GetProperties(getPropertiesOptions);
+
+    int64_t offset = options.Offset.HasValue() ? options.Offset.GetValue() : 0;
+    int64_t length = std::max(properties.ContentLength - offset, int64_t(0));
+    if (options.Length.HasValue())
+    {
+      length = std::min(length, options.Length.GetValue());
+    }
+
+    // Chunks are fetched with If-Match, so they all come from the version of the blob seen
+    // above. A blob modified since fails the fetch with 412.
+    BlobClient blobClient = *this;
+    std::string eTag = properties.ETag;
+    Azure::Core::Nullable<std::string> leaseId = options.Conditions.LeaseId;
+    auto fetchChunkFunc = [blobClient, eTag, leaseId](
+                              Azure::Core::Context& context,
+                              int64_t chunkOffset,
+                              int64_t chunkLength,
+                              uint8_t* buffer) {
+      DownloadBlobOptions chunkOptions;
+      chunkOptions.Context = context;
+      chunkOptions.Offset = chunkOffset;
+      chunkOptions.Length = chunkLength;
+      chunkOptions.Conditions.IfMatch = eTag;
+      chunkOptions.Conditions.LeaseId = leaseId;
+      auto chunk = blobClient.Download(chunkOptions);
+      int64_t bytesRead = Azure::Core::Http::BodyStream::ReadToCount(
+          context, *chunk.BodyStream, buffer, chunkLength);
+      if (bytesRead != chunkLength)
+      {
+        throw std::runtime_error("error when reading body stream");
+      }
+    };
+
+    return std::make_unique<Details::ReadAheadBodyStream>(
+        options.Context,
+        offset,
+        length,
+        options.ChunkSize,
+        options.Concurrency,
+        std::move(fetchChunkFunc));
+  }
+
   BlobSnapshotInfo BlobClient::CreateSnapshot(const CreateSnapshotOptions& options) const
   {
     BlobRestClient::Blob::CreateSnapshotOptions protocolLayerOptions;
@@ -7,12 +7,80 @@
 #include "blobs/block_blob_client.hpp"
 #include "blobs/page_blob_client.hpp"
 #include "common/common_headers_request_policy.hpp"
+#include "common/concurrent_transfer.hpp"
 #include "common/shared_key_policy.hpp"
 #include "common/storage_common.hpp"
 #include "http/curl/curl.hpp"
 
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+
 namespace Azure { namespace Storage { namespace Blobs {
 
+  namespace {
+    // A piece of a parallel listing. The pieces are disjoint and kept in name order, each is
+    // either a range of blob names starting with Prefix that is still to be listed, or blobs that
+    // are known already.
+    struct ListingSegment
+    {
+      bool IsRange = false;
+      std::string Prefix;
+      // Where listing the range goes on, so that a page that failed is the only one requested
+      // again. Empty before the first page.
+      std::string Marker;
+      bool Done = false;
+      // Blobs listed but not handed out yet.
+      std::deque<std::vector<BlobItem>> Pages;
+    };
+
+    ListingSegment RangeSegment(std::string prefix)
+    {
+      ListingSegment segment;
+      segment.IsRange = true;
+      segment.Prefix = std::move(prefix);
+      return segment;
+    }
+
+    ListingSegment BlobsSegment(std::vector<BlobItem> blobs)
+    {
+      ListingSegment segment;
+      segment.Done = true;
+      segment.Pages.emplace_back(std::move(blobs));
+      return segment;
+    }
+
+    // Splits a page of a delimiter listing into segments in name order: runs of blobs and the
+    // ranges of the virtual directories between them.
+    std::vector<ListingSegment> SplitDelimitedPage(BlobsFlatSegment& page)
+    {
+      std::vector<ListingSegment> segments;
+      std::vector<BlobItem> blobs;
+      auto blob = page.Items.begin();
+      for (auto& blobPrefix : page.BlobPrefixes)
+      {
+        while (blob != page.Items.end() && blob->Name < blobPrefix)
+        {
+          blobs.emplace_back(std::move(*blob++));
+        }
+        if (!blobs.empty())
+        {
+          segments.emplace_back(BlobsSegment(std::move(blobs)));
+          blobs.clear();
+        }
+        segments.emplace_back(RangeSegment(std::move(blobPrefix)));
+      }
+      std::move(blob, page.Items.end(), std::back_inserter(blobs));
+      if (!blobs.empty())
+      {
+        segments.emplace_back(BlobsSegment(std::move(blobs)));
+      }
+      return segments;
+    }
+  } // namespace
+
   BlobContainerClient BlobContainerClient::CreateFromConnectionString(
       const std::string& connectionString,
       const std::string& containerName,
@@ -165,6 +233,13 @@ namespace Azure { namespace Storage { namespace Blobs {
   }
 
   BlobsFlatSegment BlobContainerClient::ListBlobsFlat(const ListBlobsOptions& options) const
+  {
+    return ListBlobsFlat(nullptr, options);
+  }
+
+  BlobsFlatSegment BlobContainerClient::ListBlobsFlat(
+      const std::function<void(BlobItem& blob)>& blobReceived,
+      const ListBlobsOptions& options) const
   {
     BlobRestClient::Container::ListBlobsOptions protocolLayerOptions;
     protocolLayerOptions.Prefix = options.Prefix;
@@ -173,7 +248,245 @@ namespace Azure { namespace Storage { namespace Blobs {
     protocolLayerOptions.MaxResults = options.MaxResults;
     protocolLayerOptions.Include = options.Include;
     return BlobRestClient::Container::ListBlobs(
-        options.Context, *m_pipeline, m_containerUrl.ToString(), protocolLayerOptions);
+        options.Context,
+        *m_pipeline,
+        m_containerUrl.ToString(),
+        protocolLayerOptions,
+        blobReceived);
+  }
+
+  PagedRange<BlobItem> BlobContainerClient::ListBlobs(const ListBlobsOptions& options) const
+  {
+    BlobContainerClient containerClient = *this;
+    ListBlobsOptions segmentOptions;
+    segmentOptions.Prefix = options.Prefix;
+    segmentOptions.Delimiter = options.Delimiter;
+    segmentOptions.MaxResults = options.MaxResults;
+    segmentOptions.Include = options.Include;
+    return PagedRange<BlobItem>(
+        options.Context,
+        options.Marker.HasValue() ? options.Marker.GetValue() : std::string(),
+        options.PrefetchDepth,
+        [containerClient, segmentOptions](
+            Azure::Core::Context& context, const std::string& marker, std::string& nextMarker) {
+          ListBlobsOptions pageOptions = segmentOptions;
+          pageOptions.Context = context;
+          if (!marker.empty())
+          {
+            pageOptions.Marker = marker;
+          }
+          auto segment = containerClient.ListBlobsFlat(pageOptions);
+          nextMarker = std::move(segment.NextMarker);
+          return std::move(segment.Items);
+        });
+  }
+
+  void BlobContainerClient::ListBlobsParallel(
+      const std::function<void(std::vector<BlobItem>& blobs)>& blobsReceived,
+      const ListBlobsParallelOptions& options) const
+  {
+    const std::string prefix
+        = options.Prefix.HasValue() ? options.Prefix.GetValue() : std::string();
+    const int concurrency = std::max(options.Concurrency, 1);
+    ListBlobsOptions segmentOptions;
+    segmentOptions.MaxResults = options.MaxResults;
+    segmentOptions.Include = options.Include;
+
+    // Guards the segments and serializes calls to blobsReceived.
+    std::mutex mutex;
+    std::vector<ListingSegment> segments;
+
+    if (options.PartitionAlphabet.HasValue())
+    {
+      std::string alphabet = options.PartitionAlphabet.GetValue();
+      if (alphabet.empty())
+      {
+        throw std::runtime_error("the partition alphabet is empty");
+      }
+      std::sort(alphabet.begin(), alphabet.end(), [](char lhs, char rhs) {
+        return static_cast<unsigned char>(lhs) < static_cast<unsigned char>(rhs);
+      });
+      alphabet.erase(std::unique(alphabet.begin(), alphabet.end()), alphabet.end());
+
+      // A blob named like the prefix itself, and its snapshots, come before all ranges.
+      if (!prefix.empty())
+      {
+        ListBlobsOptions pageOptions = segmentOptions;
+        pageOptions.Context = options.Context;
+        pageOptions.Prefix = prefix;
+        pageOptions.MaxResults = 1;
+        std::vector<BlobItem> blobs;
+        while (true)
+        {
+          auto page = ListBlobsFlat(pageOptions);
+          if (page.Items.empty() || page.Items[0].Name != prefix)
+          {
+            break;
+          }
+          blobs.emplace_back(std::move(page.Items[0]));
+          if (page.NextMarker.empty())
+          {
+            break;
+          }
+          pageOptions.Marker = std::move(page.NextMarker);
+        }
+        if (!blobs.empty())
+        {
+          segments.emplace_back(BlobsSegment(std::move(blobs)));
+        }
+      }
+      for (char c : alphabet)
+      {
+        segments.emplace_back(RangeSegment(prefix + c));
+      }
+    }
+    else
+    {
+      // Splits ranges level by level with delimiter listings, which also bring the blobs right
+      // under every level.
+      segments.emplace_back(RangeSegment(prefix));
+      for (int depth = 0; depth < options.PartitionDepth; ++depth)
+      {
+        std::vector<std::size_t> rangeIds;
+        for (std::size_t i = 0; i < segments.size(); ++i)
+        {
+          if (segments[i].IsRange)
+          {
+            rangeIds.emplace_back(i);
+          }
+        }
+        if (rangeIds.empty() || rangeIds.size() >= static_cast<std::size_t>(concurrency) * 4)
+        {
+          break;
+        }
+
+        std::vector<std::vector<ListingSegment>> found(rangeIds.size());
+        Details::ConcurrentTransfer(
+            options.Context,
+            0,
+            static_cast<int64_t>(rangeIds.size()),
+            1,
+            concurrency,
+            [&](Azure::Core::Context& context, int64_t id, int64_t, int64_t, int64_t) {
+              ListingSegment& range = segments[rangeIds[static_cast<std::size_t>(id)]];
+              while (!range.Done)
+              {
+                ListBlobsOptions pageOptions = segmentOptions;
+                pageOptions.Context = context;
+                pageOptions.Prefix = range.Prefix;
+                pageOptions.Delimiter = options.Delimiter;
+                if (!range.Marker.empty())
+                {
+                  pageOptions.Marker = range.Marker;
+                }
+                auto page = ListBlobsFlat(pageOptions);
+                auto pageSegments = SplitDelimitedPage(page);
+
+                std::lock_guard<std::mutex> guard(mutex);
+                range.Marker = std::move(page.NextMarker);
+                range.Done = range.Marker.empty();
+                for (auto& segment : pageSegments)
+                {
+                  if (!options.Sorted && !segment.IsRange)
+                  {
+                    blobsReceived(segment.Pages.front());
+                  }
+                  else
+                  {
+                    found[static_cast<std::size_t>(id)].emplace_back(std::move(segment));
+                  }
+                }
+              }
+            });
+
+        std::vector<ListingSegment> nextSegments;
+        auto rangeId = rangeIds.begin();
+        for (std::size_t i = 0; i < segments.size(); ++i)
+        {
+          if (rangeId != rangeIds.end() && *rangeId == i)
+          {
+            auto& rangeFound = found[static_cast<std::size_t>(rangeId - rangeIds.begin())];
+            std::move(rangeFound.begin(), rangeFound.end(), std::back_inserter(nextSegments));
+            ++rangeId;
+          }
+          else
+          {
+            nextSegments.emplace_back(std::move(segments[i]));
+          }
+        }
+        segments = std::move(nextSegments);
+      }
+    }
+
+    // Hands out the pages of the segments in order, up to the first range still being listed.
+    // Called with the mutex held.
+    std::size_t nextSegmentId = 0;
+    auto handOutInOrder = [&]() {
+      for (; nextSegmentId < segments.size(); ++nextSegmentId)
+      {
+        auto& segment = segments[nextSegmentId];
+        for (; !segment.Pages.empty(); segment.Pages.pop_front())
+        {
+          blobsReceived(segment.Pages.front());
+        }
+        if (!segment.Done)
+        {
+          break;
+        }
+      }
+    };
+
+    std::vector<std::size_t> rangeIds;
+    for (std::size_t i = 0; i < segments.size(); ++i)
+    {
+      if (segments[i].IsRange)
+      {
+        rangeIds.emplace_back(i);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      handOutInOrder();
+    }
+    Details::ConcurrentTransfer(
+        options.Context,
+        0,
+        static_cast<int64_t>(rangeIds.size()),
+        1,
+        concurrency,
+        [&](Azure::Core::Context& context, int64_t id, int64_t, int64_t, int64_t) {
+          ListingSegment& range = segments[rangeIds[static_cast<std::size_t>(id)]];
+          while (!range.Done)
+          {
+            ListBlobsOptions pageOptions = segmentOptions;
+            pageOptions.Context = context;
+            pageOptions.Prefix = range.Prefix;
+            if (!range.Marker.empty())
+            {
+              pageOptions.Marker = range.Marker;
+            }
+            auto page = ListBlobsFlat(pageOptions);
+
+            std::lock_guard<std::mutex> guard(mutex);
+            range.Marker = std::move(page.NextMarker);
+            range.Done = range.Marker.empty();
+            if (!options.Sorted)
+            {
+              if (!page.Items.empty())
+              {
+                blobsReceived(page.Items);
+              }
+            }
+            else
+            {
+              if (!page.Items.empty())
+              {
+                range.Pages.emplace_back(std::move(page.Items));
+              }
+              handOutInOrder();
+            }
+          }
+        });
   }
 
 }}} // namespace Azure::Storage::Blobs
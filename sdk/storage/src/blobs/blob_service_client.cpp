@@ -106,6 +106,13 @@ namespace Azure { namespace Storage { namespace Blobs {
 
   ListContainersSegment BlobServiceClient::ListBlobContainersSegment(
       const ListBlobContainersOptions& options) const
+  {
+    return ListBlobContainersSegment(nullptr, options);
+  }
+
+  ListContainersSegment BlobServiceClient::ListBlobContainersSegment(
+      const std::function<void(BlobContainerItem& container)>& containerReceived,
+      const ListBlobContainersOptions& options) const
   {
     BlobRestClient::Service::ListBlobContainersOptions protocolLayerOptions;
     protocolLayerOptions.Prefix = options.Prefix;
@@ -113,7 +120,37 @@ namespace Azure { namespace Storage { namespace Blobs {
     protocolLayerOptions.MaxResults = options.MaxResults;
     protocolLayerOptions.IncludeMetadata = options.Include;
     return BlobRestClient::Service::ListBlobContainers(
-        options.Context, *m_pipeline, m_serviceUrl.ToString(), protocolLayerOptions);
+        options.Context,
+        *m_pipeline,
+        m_serviceUrl.ToString(),
+        protocolLayerOptions,
+        containerReceived);
+  }
+
+  PagedRange<BlobContainerItem> BlobServiceClient::ListBlobContainers(
+      const ListBlobContainersOptions& options) const
+  {
+    BlobServiceClient serviceClient = *this;
+    ListBlobContainersOptions segmentOptions;
+    segmentOptions.Prefix = options.Prefix;
+    segmentOptions.MaxResults = options.MaxResults;
+    segmentOptions.Include = options.Include;
+    return PagedRange<BlobContainerItem>(
+        options.Context,
+        options.Marker.HasValue() ? options.Marker.GetValue() : std::string(),
+        options.PrefetchDepth,
+        [serviceClient, segmentOptions](
+            Azure::Core::Context& context, const std::string& marker, std::string& nextMarker) {
+          ListBlobContainersOptions pageOptions = segmentOptions;
+          pageOptions.Context = context;
+          if (!marker.empty())
+          {
+            pageOptions.Marker = marker;
+          }
+          auto segment = serviceClient.ListBlobContainersSegment(pageOptions);
+          nextMarker = std::move(segment.NextMarker);
+          return std::move(segment.Items);
+        });
   }
 
   UserDelegationKey BlobServiceClient::GetUserDelegationKey(
@@ -7,10 +7,52 @@
 #include "common/constants.hpp"
 #include "common/crypt.hpp"
 #include "common/file_io.hpp"
+#include "common/hashing_body_stream.hpp"
 #include "common/storage_common.hpp"
+#include "common/transfer_auto_tuner.hpp"
+#include "common/transfer_journal.hpp"
+
+#include <map>
+#include <set>
+#include <stdexcept>
 
 namespace Azure { namespace Storage { namespace Blobs {
 
+  namespace {
+    // Reads content to the end and rewinds it.
+    std::string Crc64Of(const Azure::Core::Context& context, Azure::Core::Http::BodyStream& content)
+    {
+      Azure::Core::Context readContext = context;
+      std::vector<uint8_t> buffer(64 * 1024);
+      Crc64 crc64;
+      while (true)
+      {
+        int64_t bytesRead = content.Read(readContext, buffer.data(), buffer.size());
+        if (bytesRead == 0)
+        {
+          break;
+        }
+        crc64.Update(buffer.data(), static_cast<std::size_t>(bytesRead));
+      }
+      content.Rewind();
+      return crc64.Digest();
+    }
+
+    // The index of a block zero-padded to a fixed number of digits, so that all IDs of a blob have
+    // the same length. Compact IDs have enough digits for the 50000 blocks a blob can have.
+    std::string BlockIdOf(int64_t id, bool compact)
+    {
+      const std::size_t blockIdLength = compact ? 6 : 64;
+      std::string blockId = std::to_string(id);
+      if (blockId.length() > blockIdLength)
+      {
+        throw std::runtime_error("too many blocks for compact block IDs");
+      }
+      blockId = std::string(blockIdLength - blockId.length(), '0') + blockId;
+      return Base64Encode(blockId);
+    }
+  } // namespace
+
   BlockBlobClient BlockBlobClient::CreateFromConnectionString(
       const std::string& connectionString,
       const std::string& containerName,
@@ -76,6 +118,14 @@ namespace Azure { namespace Storage { namespace Blobs {
     protocolLayerOptions.IfUnmodifiedSince = options.Conditions.IfUnmodifiedSince;
     protocolLayerOptions.IfMatch = options.Conditions.IfMatch;
     protocolLayerOptions.IfNoneMatch = options.Conditions.IfNoneMatch;
+    if (options.ValidateContentHash)
+    {
+      HashingBodyStream hashingStream(&content, true, true);
+      auto response = BlobRestClient::BlockBlob::Upload(
+          options.Context, *m_pipeline, m_blobUrl.ToString(), hashingStream, protocolLayerOptions);
+      hashingStream.Verify(response.ContentMD5, response.ContentCRC64);
+      return response;
+    }
     return BlobRestClient::BlockBlob::Upload(
         options.Context, *m_pipeline, m_blobUrl.ToString(), content, protocolLayerOptions);
   }
@@ -87,6 +137,7 @@ namespace Azure { namespace Storage { namespace Blobs {
   {
     constexpr int64_t c_defaultBlockSize = 8 * 1024 * 1024;
     constexpr int64_t c_maximumNumberBlocks = 50000;
+    constexpr int64_t c_maximumBlockSize = 100 * 1024 * 1024;
     constexpr int64_t c_grainSize = 4 * 1024;
 
     int64_t chunkSize = c_defaultBlockSize;
@@ -102,25 +153,57 @@ namespace Azure { namespace Storage { namespace Blobs {
     }
 
     std::vector<std::pair<BlockType, std::string>> blockIds;
-    auto getBlockId = [](int64_t id) {
-      constexpr std::size_t c_blockIdLength = 64;
-      std::string blockId = std::to_string(id);
-      blockId = std::string(c_blockIdLength - blockId.length(), '0') + blockId;
-      return Base64Encode(blockId);
-    };
+    auto getBlockId = [&options](int64_t id) { return BlockIdOf(id, options.CompactBlockIds); };
 
-    auto uploadBlockFunc = [&](int64_t offset, int64_t length, int64_t chunkId, int64_t numChunks) {
+    auto uploadBlockFunc = [&](Azure::Core::Context& context,
+                               int64_t offset,
+                               int64_t length,
+                               int64_t chunkId) {
       Azure::Core::Http::MemoryBodyStream contentStream(buffer + offset, length);
       StageBlockOptions chunkOptions;
-      chunkOptions.Context = options.Context;
-      auto blockInfo = StageBlock(getBlockId(chunkId), contentStream, chunkOptions);
-      if (chunkId == numChunks - 1)
+      chunkOptions.Context = context;
+      if (options.TransactionalCRC64)
       {
-        blockIds.resize(static_cast<std::size_t>(numChunks));
+        Crc64 crc64;
+        crc64.Update(buffer + offset, static_cast<std::size_t>(length));
+        chunkOptions.ContentCRC64 = Base64Encode(crc64.Digest());
       }
+      auto blockInfo = StageBlock(getBlockId(chunkId), contentStream, chunkOptions);
     };
 
-    Details::ConcurrentTransfer(0, bufferSize, chunkSize, options.Concurrency, uploadBlockFunc);
+    int64_t numBlocks;
+    if (options.AutoTune)
+    {
+      int64_t maxBlockSize = c_maximumBlockSize;
+      if (options.ChunkSize.HasValue())
+      {
+        maxBlockSize = options.ChunkSize.GetValue();
+      }
+      Details::TransferAutoTuner tuner(
+          m_blobUrl.GetHost() + "/upload",
+          std::min(c_defaultBlockSize, maxBlockSize),
+          maxBlockSize,
+          options.Concurrency);
+      numBlocks = Details::AdaptiveConcurrentTransfer(
+          options.Context, 0, bufferSize, c_maximumNumberBlocks, tuner, uploadBlockFunc);
+    }
+    else
+    {
+      numBlocks = (static_cast<int64_t>(bufferSize) + chunkSize - 1) / chunkSize;
+      Details::ConcurrentTransfer(
+          options.Context,
+          0,
+          bufferSize,
+          chunkSize,
+          options.Concurrency,
+          [&](Azure::Core::Context& context,
+              int64_t offset,
+              int64_t length,
+              int64_t chunkId,
+              int64_t) { uploadBlockFunc(context, offset, length, chunkId); });
+    }
+
+    blockIds.resize(static_cast<std::size_t>(numBlocks));
 
     for (std::size_t i = 0; i < blockIds.size(); ++i)
     {
@@ -144,9 +227,23 @@ namespace Azure { namespace Storage { namespace Blobs {
   {
     constexpr int64_t c_defaultBlockSize = 8 * 1024 * 1024;
     constexpr int64_t c_maximumNumberBlocks = 50000;
+    constexpr int64_t c_maximumBlockSize = 100 * 1024 * 1024;
     constexpr int64_t c_grainSize = 4 * 1024;
 
     Details::FileReader fileReader(file);
+    // With MemoryMapFile, blocks are sent straight from a mapping of the file where possible,
+    // which saves copying every byte into the transport's buffer.
+    std::unique_ptr<Details::MemoryMappedFile> mappedFile;
+    if (options.MemoryMapFile && fileReader.GetFileSize() > 0)
+    {
+      try
+      {
+        mappedFile = std::make_unique<Details::MemoryMappedFile>(fileReader);
+      }
+      catch (std::runtime_error&)
+      {
+      }
+    }
 
     int64_t chunkSize = c_defaultBlockSize;
     if (options.ChunkSize.HasValue())
@@ -162,27 +259,188 @@ namespace Azure { namespace Storage { namespace Blobs {
     }
 
     std::vector<std::pair<BlockType, std::string>> blockIds;
-    auto getBlockId = [](int64_t id) {
-      constexpr std::size_t c_blockIdLength = 64;
-      std::string blockId = std::to_string(id);
-      blockId = std::string(c_blockIdLength - blockId.length(), '0') + blockId;
-      return Base64Encode(blockId);
-    };
+    auto getBlockId = [&options](int64_t id) { return BlockIdOf(id, options.CompactBlockIds); };
 
-    auto uploadBlockFunc = [&](int64_t offset, int64_t length, int64_t chunkId, int64_t numChunks) {
-      Azure::Core::Http::FileBodyStream contentStream(fileReader.GetHandle(), offset, length);
+    // Blocks staged by an earlier attempt are skipped if they are still uncommitted on the blob.
+    // The block list, and so the chunks, have to be the same as back then.
+    std::unique_ptr<Details::TransferJournal> journal;
+    if (options.JournalFile.HasValue())
+    {
+      journal = std::make_unique<Details::TransferJournal>(
+          options.JournalFile.GetValue(),
+          "upload " + m_blobUrl.GetHost() + "/" + m_blobUrl.GetPath() + " " + file + " "
+              + std::to_string(fileReader.GetFileSize()) + " "
+              + std::to_string(fileReader.GetLastModifiedTime()) + " "
+              + std::to_string(chunkSize) + (options.CompactBlockIds ? " compact" : ""));
+      if (!journal->GetCompletedChunks().empty())
+      {
+        std::map<std::string, int64_t> stagedBlocks;
+        try
+        {
+          GetBlockListOptions getBlockListOptions;
+          getBlockListOptions.Context = options.Context;
+          getBlockListOptions.ListType = BlockListTypeOption::Uncommitted;
+          for (auto& block : GetBlockList(getBlockListOptions).UncommittedBlocks)
+          {
+            stagedBlocks.emplace(std::move(block.Name), block.Size);
+          }
+        }
+        catch (StorageError& e)
+        {
+          // Blocks of a blob that was never committed are listed, so it was deleted since.
+          if (e.StatusCode != Azure::Core::Http::HttpStatusCode::NotFound)
+          {
+            throw;
+          }
+        }
+        std::set<int64_t> completedChunks;
+        for (int64_t chunkId : journal->GetCompletedChunks())
+        {
+          int64_t length = std::min(chunkSize, fileReader.GetFileSize() - chunkId * chunkSize);
+          auto stagedBlock = stagedBlocks.find(getBlockId(chunkId));
+          if (stagedBlock != stagedBlocks.end() && stagedBlock->second == length)
+          {
+            completedChunks.insert(chunkId);
+          }
+        }
+        if (completedChunks != journal->GetCompletedChunks())
+        {
+          journal->SetCompletedChunks(std::move(completedChunks));
+        }
+      }
+    }
+
+    auto uploadBlockFunc = [&](Azure::Core::Context& context,
+                               int64_t offset,
+                               int64_t length,
+                               int64_t chunkId) {
+      if (journal && journal->IsCompleted(chunkId))
+      {
+        return;
+      }
       StageBlockOptions chunkOptions;
-      chunkOptions.Context = options.Context;
-      auto blockInfo = StageBlock(getBlockId(chunkId), contentStream, chunkOptions);
-      if (chunkId == numChunks - 1)
+      chunkOptions.Context = context;
+      if (mappedFile)
       {
-        blockIds.resize(static_cast<std::size_t>(numChunks));
+        Azure::Core::Http::MemoryBodyStream contentStream(mappedFile->Data() + offset, length);
+        if (options.TransactionalCRC64)
+        {
+          Crc64 crc64;
+          crc64.Update(mappedFile->Data() + offset, static_cast<std::size_t>(length));
+          chunkOptions.ContentCRC64 = Base64Encode(crc64.Digest());
+        }
+        StageBlock(getBlockId(chunkId), contentStream, chunkOptions);
+      }
+      else
+      {
+        Azure::Core::Http::FileBodyStream contentStream(fileReader.GetHandle(), offset, length);
+        if (options.TransactionalCRC64)
+        {
+          // The checksum goes into a header, so the block is read once more to compute it.
+          chunkOptions.ContentCRC64 = Base64Encode(Crc64Of(context, contentStream));
+        }
+        StageBlock(getBlockId(chunkId), contentStream, chunkOptions);
+      }
+      if (journal)
+      {
+        journal->MarkCompleted(chunkId);
       }
     };
 
-    Details::ConcurrentTransfer(
-        0, fileReader.GetFileSize(), chunkSize, options.Concurrency, uploadBlockFunc);
+    int64_t numBlocks;
+    if (options.AutoTune && !journal)
+    {
+      int64_t maxBlockSize = c_maximumBlockSize;
+      if (options.ChunkSize.HasValue())
+      {
+        maxBlockSize = options.ChunkSize.GetValue();
+      }
+      Details::TransferAutoTuner tuner(
+          m_blobUrl.GetHost() + "/upload",
+          std::min(c_defaultBlockSize, maxBlockSize),
+          maxBlockSize,
+          options.Concurrency);
+      numBlocks = Details::AdaptiveConcurrentTransfer(
+          options.Context,
+          0,
+          fileReader.GetFileSize(),
+          c_maximumNumberBlocks,
+          tuner,
+          uploadBlockFunc);
+    }
+    else
+    {
+      numBlocks = (fileReader.GetFileSize() + chunkSize - 1) / chunkSize;
+      Details::ConcurrentTransfer(
+          options.Context,
+          0,
+          fileReader.GetFileSize(),
+          chunkSize,
+          options.Concurrency,
+          [&](Azure::Core::Context& context,
+              int64_t offset,
+              int64_t length,
+              int64_t chunkId,
+              int64_t) { uploadBlockFunc(context, offset, length, chunkId); });
+    }
+
+    blockIds.resize(static_cast<std::size_t>(numBlocks));
 
+    for (std::size_t i = 0; i < blockIds.size(); ++i)
+    {
+      blockIds[i].first = BlockType::Uncommitted;
+      blockIds[i].second = getBlockId(static_cast<int64_t>(i));
+    }
+    CommitBlockListOptions commitBlockListOptions;
+    commitBlockListOptions.Context = options.Context;
+    commitBlockListOptions.HttpHeaders = options.HttpHeaders;
+    commitBlockListOptions.Metadata = options.Metadata;
+    commitBlockListOptions.Tier = options.Tier;
+    auto commitBlockListResponse = CommitBlockList(blockIds, commitBlockListOptions);
+    if (journal)
+    {
+      journal->Remove();
+    }
+    commitBlockListResponse.ContentCRC64.Reset();
+    commitBlockListResponse.ContentMD5.Reset();
+    return commitBlockListResponse;
+  }
+
+  BlobContentInfo BlockBlobClient::UploadFromStream(
+      Azure::Core::Http::BodyStream& content,
+      const UploadBlobOptions& options) const
+  {
+    constexpr int64_t c_defaultBlockSize = 8 * 1024 * 1024;
+    constexpr int64_t c_maximumNumberBlocks = 50000;
+
+    int64_t chunkSize = c_defaultBlockSize;
+    if (options.ChunkSize.HasValue())
+    {
+      chunkSize = options.ChunkSize.GetValue();
+    }
+
+    auto getBlockId = [&options](int64_t id) { return BlockIdOf(id, options.CompactBlockIds); };
+
+    int64_t numBlocks = Details::StreamingConcurrentTransfer(
+        options.Context,
+        content,
+        chunkSize,
+        options.Concurrency,
+        c_maximumNumberBlocks,
+        [&](Azure::Core::Context& context, const uint8_t* data, int64_t length, int64_t chunkId) {
+          Azure::Core::Http::MemoryBodyStream contentStream(data, length);
+          StageBlockOptions chunkOptions;
+          chunkOptions.Context = context;
+          if (options.TransactionalCRC64)
+          {
+            Crc64 crc64;
+            crc64.Update(data, static_cast<std::size_t>(length));
+            chunkOptions.ContentCRC64 = Base64Encode(crc64.Digest());
+          }
+          StageBlock(getBlockId(chunkId), contentStream, chunkOptions);
+        });
+
+    std::vector<std::pair<BlockType, std::string>> blockIds(static_cast<std::size_t>(numBlocks));
     for (std::size_t i = 0; i < blockIds.size(); ++i)
     {
       blockIds[i].first = BlockType::Uncommitted;
@@ -209,6 +467,14 @@ namespace Azure { namespace Storage { namespace Blobs {
     protocolLayerOptions.ContentMD5 = options.ContentMD5;
     protocolLayerOptions.ContentCRC64 = options.ContentCRC64;
     protocolLayerOptions.LeaseId = options.Conditions.LeaseId;
+    if (options.ValidateContentHash)
+    {
+      HashingBodyStream hashingStream(&content, true, true);
+      auto response = BlobRestClient::BlockBlob::StageBlock(
+          options.Context, *m_pipeline, m_blobUrl.ToString(), hashingStream, protocolLayerOptions);
+      hashingStream.Verify(response.ContentMD5, response.ContentCRC64);
+      return response;
+    }
     return BlobRestClient::BlockBlob::StageBlock(
         options.Context, *m_pipeline, m_blobUrl.ToString(), content, protocolLayerOptions);
   }
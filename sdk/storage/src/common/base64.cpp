@@ -0,0 +1,397 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/base64.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define AZURE_STORAGE_BASE64_SIMD
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AZURE_STORAGE_TARGET_SSSE3
+#define AZURE_STORAGE_TARGET_AVX2
+#else
+#define AZURE_STORAGE_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define AZURE_STORAGE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#include <immintrin.h>
+#endif
+
+#include <stdexcept>
+
+namespace Azure { namespace Storage {
+
+  namespace {
+    const char c_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    constexpr uint8_t c_invalid = 0xff;
+
+    enum class SimdLevel
+    {
+      None,
+      Ssse3,
+      Avx2,
+    };
+
+    struct Base64Tables
+    {
+      uint8_t Decode[256];
+      SimdLevel Simd = SimdLevel::None;
+
+      Base64Tables()
+      {
+        for (int i = 0; i < 256; ++i)
+        {
+          Decode[i] = c_invalid;
+        }
+        for (int i = 0; i < 64; ++i)
+        {
+          Decode[static_cast<uint8_t>(c_alphabet[i])] = static_cast<uint8_t>(i);
+        }
+#if defined(AZURE_STORAGE_BASE64_SIMD)
+#ifdef _MSC_VER
+        int cpuInfo[4];
+        __cpuid(cpuInfo, 1);
+        bool hasSsse3 = (cpuInfo[2] & (1 << 9)) != 0;
+        // AVX2 also needs the OS to save the YMM registers.
+        bool hasOsYmm = (cpuInfo[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+        __cpuidex(cpuInfo, 7, 0);
+        bool hasAvx2 = hasOsYmm && (cpuInfo[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        bool hasSsse3 = __builtin_cpu_supports("ssse3");
+        bool hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+        Simd = hasAvx2 ? SimdLevel::Avx2 : hasSsse3 ? SimdLevel::Ssse3 : SimdLevel::None;
+#endif
+      }
+    };
+
+    const Base64Tables& GetBase64Tables()
+    {
+      static const Base64Tables tables;
+      return tables;
+    }
+
+    // Returns the number of bytes consumed, always a multiple of 3.
+    std::size_t EncodeScalar(const uint8_t* data, std::size_t length, char* output)
+    {
+      std::size_t i = 0;
+      for (; i + 3 <= length; i += 3)
+      {
+        uint32_t triple = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        *output++ = c_alphabet[(triple >> 18) & 0x3f];
+        *output++ = c_alphabet[(triple >> 12) & 0x3f];
+        *output++ = c_alphabet[(triple >> 6) & 0x3f];
+        *output++ = c_alphabet[triple & 0x3f];
+      }
+      return i;
+    }
+
+    // Decodes whole quads without padding, returns false on an invalid character.
+    bool DecodeScalar(const uint8_t* text, std::size_t length, uint8_t* output)
+    {
+      const uint8_t* table = GetBase64Tables().Decode;
+      for (std::size_t i = 0; i < length; i += 4)
+      {
+        uint8_t a = table[text[i]];
+        uint8_t b = table[text[i + 1]];
+        uint8_t c = table[text[i + 2]];
+        uint8_t d = table[text[i + 3]];
+        if ((a | b | c | d) == c_invalid)
+        {
+          return false;
+        }
+        uint32_t triple = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d;
+        *output++ = static_cast<uint8_t>(triple >> 16);
+        *output++ = static_cast<uint8_t>(triple >> 8);
+        *output++ = static_cast<uint8_t>(triple);
+      }
+      return true;
+    }
+
+#if defined(AZURE_STORAGE_BASE64_SIMD)
+    // The SIMD code follows the pshufb based approach of Wojciech Mula and Daniel Lemire. Every
+    // 32-bit lane holds three input bytes on the way in and four 6-bit values on the way out.
+
+    AZURE_STORAGE_TARGET_SSSE3 __m128i EncodeSplit(__m128i in)
+    {
+      // Bytes [b a c b] of each triple, so that the multiplications below can move all four 6-bit
+      // fields into separate bytes.
+      in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+      __m128i ac = _mm_mulhi_epu16(
+          _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+      __m128i bd = _mm_mullo_epi16(
+          _mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+      return _mm_or_si128(ac, bd);
+    }
+
+    AZURE_STORAGE_TARGET_SSSE3 __m128i EncodeLookup(__m128i indices)
+    {
+      // Maps 0-25 to 13, 26-51 to 0, 52-61 to 1-10, 62 to 11 and 63 to 12, then adds the offset
+      // from that slot to the character.
+      __m128i slot = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      slot = _mm_or_si128(
+          slot,
+          _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+      const __m128i offsets = _mm_setr_epi8(
+          'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+          '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, slot));
+    }
+
+    AZURE_STORAGE_TARGET_SSSE3 std::size_t
+    EncodeSsse3(const uint8_t* data, std::size_t length, char* output)
+    {
+      std::size_t i = 0;
+      // Loads 16 bytes and uses 12 of them.
+      for (; i + 16 <= length; i += 12, output += 16)
+      {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), EncodeLookup(EncodeSplit(in)));
+      }
+      return i + EncodeScalar(data + i, length - i, output);
+    }
+
+    AZURE_STORAGE_TARGET_AVX2 std::size_t
+    EncodeAvx2(const uint8_t* data, std::size_t length, char* output)
+    {
+      const __m256i shuffle = _mm256_setr_epi8(
+          1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+          1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+      const __m256i offsets = _mm256_setr_epi8(
+          'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+          '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+          'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+          '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      std::size_t i = 0;
+      // Each lane loads 16 bytes and uses 12 of them, the second lane starts 12 bytes in.
+      for (; i + 28 <= length; i += 24, output += 32)
+      {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 12)),
+            1);
+        in = _mm256_shuffle_epi8(in, shuffle);
+        __m256i ac = _mm256_mulhi_epu16(
+            _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        __m256i bd = _mm256_mullo_epi16(
+            _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(ac, bd);
+        __m256i slot = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        slot = _mm256_or_si256(
+            slot,
+            _mm256_and_si256(
+                _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        __m256i result = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, slot));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), result);
+      }
+      // Legacy SSE instructions are slow while the upper halves of the registers are dirty.
+      _mm256_zeroupper();
+      return i + EncodeSsse3(data + i, length - i, output);
+    }
+
+    // Per high nibble of a character, a bit that is set in the low nibble entry of every character
+    // with that high nibble that isn't in the alphabet.
+    AZURE_STORAGE_TARGET_SSSE3 __m128i DecodeLookupLow()
+    {
+      return _mm_setr_epi8(
+          0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b,
+          0x1b, 0x1a);
+    }
+
+    AZURE_STORAGE_TARGET_SSSE3 __m128i DecodeLookupHigh()
+    {
+      return _mm_setr_epi8(
+          0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+          0x10, 0x10);
+    }
+
+    // Offset from a character to its value by high nibble, slot 1 is '/' which shares its high
+    // nibble with '+'.
+    AZURE_STORAGE_TARGET_SSSE3 __m128i DecodeLookupRoll()
+    {
+      return _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    }
+
+    // Returns the number of characters consumed, stops early at an invalid character or padding.
+    AZURE_STORAGE_TARGET_SSSE3 std::size_t
+    DecodeSsse3(const uint8_t* text, std::size_t length, uint8_t* output)
+    {
+      std::size_t i = 0;
+      // Stores 16 bytes and uses 12 of them, the input left over guarantees the room.
+      for (; i + 24 <= length; i += 16, output += 12)
+      {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i high = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+        __m128i low = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+        __m128i invalid = _mm_and_si128(
+            _mm_shuffle_epi8(DecodeLookupLow(), low), _mm_shuffle_epi8(DecodeLookupHigh(), high));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xffff)
+        {
+          break;
+        }
+        __m128i roll = _mm_shuffle_epi8(
+            DecodeLookupRoll(), _mm_add_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('/')), high));
+        __m128i values = _mm_add_epi8(in, roll);
+        __m128i packed = _mm_madd_epi16(
+            _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+        packed = _mm_shuffle_epi8(
+            packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), packed);
+      }
+      return i;
+    }
+
+    AZURE_STORAGE_TARGET_AVX2 std::size_t
+    DecodeAvx2(const uint8_t* text, std::size_t length, uint8_t* output)
+    {
+      const __m256i lookupLow = _mm256_broadcastsi128_si256(DecodeLookupLow());
+      const __m256i lookupHigh = _mm256_broadcastsi128_si256(DecodeLookupHigh());
+      const __m256i lookupRoll = _mm256_broadcastsi128_si256(DecodeLookupRoll());
+      const __m256i shuffle = _mm256_setr_epi8(
+          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+      std::size_t i = 0;
+      // Stores 32 bytes and uses 24 of them, the input left over guarantees the room.
+      for (; i + 48 <= length; i += 32, output += 24)
+      {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        __m256i high = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+        __m256i low = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+        __m256i invalid = _mm256_and_si256(
+            _mm256_shuffle_epi8(lookupLow, low), _mm256_shuffle_epi8(lookupHigh, high));
+        if (!_mm256_testz_si256(invalid, invalid))
+        {
+          break;
+        }
+        __m256i roll = _mm256_shuffle_epi8(
+            lookupRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('/')), high));
+        __m256i values = _mm256_add_epi8(in, roll);
+        __m256i packed = _mm256_madd_epi16(
+            _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)),
+            _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, shuffle);
+        // Moves the 12 bytes of the second lane right after those of the first.
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), packed);
+      }
+      _mm256_zeroupper();
+      return i + DecodeSsse3(text + i, length - i, output);
+    }
+#endif
+
+    [[noreturn]] void ThrowInvalidBase64()
+    {
+      throw std::runtime_error("invalid Base64 string");
+    }
+  } // namespace
+
+  void Base64Encode(const uint8_t* data, std::size_t length, char* output)
+  {
+    std::size_t i = 0;
+#if defined(AZURE_STORAGE_BASE64_SIMD)
+    switch (GetBase64Tables().Simd)
+    {
+      case SimdLevel::Avx2:
+        i = EncodeAvx2(data, length, output);
+        break;
+      case SimdLevel::Ssse3:
+        i = EncodeSsse3(data, length, output);
+        break;
+      case SimdLevel::None:
+        i = EncodeScalar(data, length, output);
+        break;
+    }
+#else
+    i = EncodeScalar(data, length, output);
+#endif
+    output += i / 3 * 4;
+    if (length - i == 1)
+    {
+      output[0] = c_alphabet[data[i] >> 2];
+      output[1] = c_alphabet[(data[i] & 0x03) << 4];
+      output[2] = '=';
+      output[3] = '=';
+    }
+    else if (length - i == 2)
+    {
+      output[0] = c_alphabet[data[i] >> 2];
+      output[1] = c_alphabet[((data[i] & 0x03) << 4) | (data[i + 1] >> 4)];
+      output[2] = c_alphabet[(data[i + 1] & 0x0f) << 2];
+      output[3] = '=';
+    }
+  }
+
+  std::size_t Base64Decode(const char* text, std::size_t length, uint8_t* output)
+  {
+    if (length % 4 != 0)
+    {
+      ThrowInvalidBase64();
+    }
+    if (length == 0)
+    {
+      return 0;
+    }
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(text);
+    // The last quad is the only one that may be padded.
+    std::size_t bodyLength = length - 4;
+
+    std::size_t i = 0;
+#if defined(AZURE_STORAGE_BASE64_SIMD)
+    switch (GetBase64Tables().Simd)
+    {
+      case SimdLevel::Avx2:
+        i = DecodeAvx2(input, bodyLength, output);
+        break;
+      case SimdLevel::Ssse3:
+        i = DecodeSsse3(input, bodyLength, output);
+        break;
+      case SimdLevel::None:
+        break;
+    }
+#endif
+    if (!DecodeScalar(input + i, bodyLength - i, output + i / 4 * 3))
+    {
+      ThrowInvalidBase64();
+    }
+    output += bodyLength / 4 * 3;
+    input += bodyLength;
+
+    const uint8_t* table = GetBase64Tables().Decode;
+    std::size_t padding = input[3] != '=' ? 0 : input[2] != '=' ? 1 : 2;
+    uint8_t a = table[input[0]];
+    uint8_t b = table[input[1]];
+    uint8_t c = padding < 2 ? table[input[2]] : 0;
+    uint8_t d = padding < 1 ? table[input[3]] : 0;
+    if ((a | b | c | d) == c_invalid)
+    {
+      ThrowInvalidBase64();
+    }
+    uint32_t triple = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d;
+    output[0] = static_cast<uint8_t>(triple >> 16);
+    if (padding < 2)
+    {
+      output[1] = static_cast<uint8_t>(triple >> 8);
+    }
+    if (padding < 1)
+    {
+      output[2] = static_cast<uint8_t>(triple);
+    }
+    return bodyLength / 4 * 3 + 3 - padding;
+  }
+
+  std::string Base64Encode(const std::string& text)
+  {
+    std::string encoded(Base64EncodedLength(text.length()), '\0');
+    Base64Encode(reinterpret_cast<const uint8_t*>(text.data()), text.length(), &encoded[0]);
+    return encoded;
+  }
+
+  std::string Base64Decode(const std::string& text)
+  {
+    std::string decoded(Base64DecodedMaxLength(text.length()), '\0');
+    decoded.resize(
+        Base64Decode(text.data(), text.length(), reinterpret_cast<uint8_t*>(&decoded[0])));
+    return decoded;
+  }
+
+}} // namespace Azure::Storage
@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/buffer_pool.hpp"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  namespace {
+    uint8_t* AlignedAlloc(std::size_t size, std::size_t alignment)
+    {
+#ifdef _WIN32
+      void* ptr = _aligned_malloc(size, alignment);
+#else
+      void* ptr = nullptr;
+      if (posix_memalign(&ptr, alignment, size) != 0)
+      {
+        ptr = nullptr;
+      }
+#endif
+      if (ptr == nullptr)
+      {
+        throw std::bad_alloc();
+      }
+      return static_cast<uint8_t*>(ptr);
+    }
+
+    void AlignedFree(uint8_t* ptr)
+    {
+#ifdef _WIN32
+      _aligned_free(ptr);
+#else
+      free(ptr);
+#endif
+    }
+  } // namespace
+
+  constexpr std::size_t AlignedBufferPool::DefaultAlignment;
+
+  AlignedBufferPool::AlignedBufferPool(
+      int64_t bufferSize,
+      int64_t maxBuffers,
+      std::size_t alignment)
+      : m_maxBuffers(std::max(maxBuffers, int64_t(1))), m_alignment(alignment)
+  {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment % sizeof(void*) != 0)
+    {
+      throw std::invalid_argument("alignment must be a power of two multiple of pointer size");
+    }
+    int64_t align = static_cast<int64_t>(alignment);
+    m_bufferSize = (std::max(bufferSize, int64_t(1)) + align - 1) / align * align;
+  }
+
+  AlignedBufferPool::~AlignedBufferPool()
+  {
+    for (auto buffer : m_allBuffers)
+    {
+      AlignedFree(buffer);
+    }
+  }
+
+  AlignedBufferPool::Buffer AlignedBufferPool::Acquire(Azure::Core::Context& context)
+  {
+    std::unique_lock<std::mutex> guard(m_mutex);
+    while (true)
+    {
+      if (!m_freeBuffers.empty())
+      {
+        std::size_t index = m_freeBuffers.back();
+        m_freeBuffers.pop_back();
+        return Buffer(this, m_allBuffers[index], index);
+      }
+      if (static_cast<int64_t>(m_allBuffers.size()) < m_maxBuffers)
+      {
+        // Reserve the slot first so push_back can't throw after the allocation succeeded.
+        m_allBuffers.reserve(m_allBuffers.size() + 1);
+        m_freeBuffers.reserve(m_allBuffers.size() + 1);
+        uint8_t* data = AlignedAlloc(static_cast<std::size_t>(m_bufferSize), m_alignment);
+        m_allBuffers.push_back(data);
+        return Buffer(this, data, m_allBuffers.size() - 1);
+      }
+      if (context.CancelWhen() < std::chrono::system_clock::now())
+      {
+        throw std::runtime_error("the operation was cancelled");
+      }
+      m_cv.wait_for(guard, std::chrono::milliseconds(100));
+    }
+  }
+
+  int64_t AlignedBufferPool::GetAllocatedBuffers()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return static_cast<int64_t>(m_allBuffers.size());
+  }
+
+  std::vector<uint8_t*> AlignedBufferPool::AllocateAll()
+  {
+    std::unique_lock<std::mutex> guard(m_mutex);
+    m_allBuffers.reserve(static_cast<std::size_t>(m_maxBuffers));
+    m_freeBuffers.reserve(static_cast<std::size_t>(m_maxBuffers));
+    while (static_cast<int64_t>(m_allBuffers.size()) < m_maxBuffers)
+    {
+      m_allBuffers.push_back(AlignedAlloc(static_cast<std::size_t>(m_bufferSize), m_alignment));
+      m_freeBuffers.push_back(m_allBuffers.size() - 1);
+    }
+    std::vector<uint8_t*> ret = m_allBuffers;
+    guard.unlock();
+    m_cv.notify_all();
+    return ret;
+  }
+
+  void AlignedBufferPool::Release(std::size_t index)
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_freeBuffers.push_back(index);
+    }
+    m_cv.notify_one();
+  }
+
+}}} // namespace Azure::Storage::Details
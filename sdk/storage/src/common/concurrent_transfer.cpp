@@ -0,0 +1,549 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/concurrent_transfer.hpp"
+
+#include "common/buffer_pool.hpp"
+#include "common/storage_error.hpp"
+#include "common/thread_pool.hpp"
+#include "common/transfer_auto_tuner.hpp"
+#include "common/transfer_governor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  namespace {
+    constexpr int c_maxChunkRetries = 3;
+    constexpr std::chrono::milliseconds c_chunkRetryDelay(1000);
+    constexpr std::chrono::milliseconds c_maxChunkRetryDelay(30000);
+
+    // Failures a chunk is tried again for: the connection failed or stalled, or the service timed
+    // out, was busy or had a transient problem. Everything else, like a failed precondition or a
+    // cancelled operation, fails the transfer right away.
+    bool IsRetriableChunkFailure(const std::exception_ptr& exception)
+    {
+      try
+      {
+        std::rethrow_exception(exception);
+      }
+      catch (Azure::Core::Http::TransportException&)
+      {
+        return true;
+      }
+      catch (Azure::Core::Http::CouldNotResolveHostException&)
+      {
+        return true;
+      }
+      catch (StorageError& e)
+      {
+        switch (e.StatusCode)
+        {
+          case Azure::Core::Http::HttpStatusCode::RequestTimeout:
+          case Azure::Core::Http::HttpStatusCode::InternalServerError:
+          case Azure::Core::Http::HttpStatusCode::BadGateway:
+          case Azure::Core::Http::HttpStatusCode::ServiceUnavailable:
+          case Azure::Core::Http::HttpStatusCode::GatewayTimeout:
+            return true;
+          default:
+            return false;
+        }
+      }
+      catch (...)
+      {
+        return false;
+      }
+    }
+
+    // Waits before retry number attempt (from 0). The delay is drawn uniformly from [0, d] with d
+    // doubling every attempt, so that chunks that failed together, when the service throttled the
+    // transfer for example, don't come back together. Throws once context is cancelled.
+    void ChunkRetryBackoff(Azure::Core::Context& context, int attempt)
+    {
+      thread_local std::mt19937_64 random(std::random_device{}());
+      int64_t maxDelay = std::min(
+          c_chunkRetryDelay.count() << std::min(attempt, 16), c_maxChunkRetryDelay.count());
+      auto end = std::chrono::steady_clock::now()
+          + std::chrono::milliseconds(
+                     std::uniform_int_distribution<int64_t>(0, maxDelay)(random));
+      while (true)
+      {
+        if (context.CancelWhen() < std::chrono::system_clock::now())
+        {
+          throw std::runtime_error("the operation was cancelled");
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now >= end)
+        {
+          break;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            end - now, std::chrono::milliseconds(100)));
+      }
+    }
+
+    // Runs attemptFunc until it succeeds or fails for good. onFailure sees every failed attempt.
+    void TransferChunk(
+        Azure::Core::Context& context,
+        const std::function<void()>& attemptFunc,
+        const std::function<void(const std::exception_ptr&)>& onFailure = nullptr)
+    {
+      for (int attempt = 0;; ++attempt)
+      {
+        std::exception_ptr exception;
+        try
+        {
+          attemptFunc();
+          return;
+        }
+        catch (...)
+        {
+          exception = std::current_exception();
+        }
+        if (onFailure)
+        {
+          onFailure(exception);
+        }
+        if (attempt >= c_maxChunkRetries || !IsRetriableChunkFailure(exception))
+        {
+          std::rethrow_exception(exception);
+        }
+        ChunkRetryBackoff(context, attempt);
+      }
+    }
+
+    struct TransferState
+    {
+      // Child of the caller's context, cancelled when the transfer fails so that the chunks in
+      // flight stop too.
+      Azure::Core::Context Context;
+      int64_t Offset = 0;
+      int64_t Length = 0;
+      int64_t ChunkSize = 0;
+      int64_t NumChunks = 0;
+      int64_t ChunkBufferSize = 0;
+      std::function<void(Azure::Core::Context&, int64_t, int64_t, int64_t, int64_t)> TransferFunc;
+      GovernedTransfer* Governor = nullptr;
+
+      std::atomic<int64_t> NextChunkId{0};
+      std::atomic<bool> Failed{false};
+
+      std::mutex Mutex;
+      std::condition_variable Cv;
+      int NumActiveWorkers = 0;
+      // Set once the calling thread stops waiting for new workers. Tasks that get scheduled after
+      // this must not touch TransferFunc or Governor anymore, they may reference the caller's
+      // stack.
+      bool Closed = false;
+      std::exception_ptr Exception;
+    };
+
+    void TransferWorker(TransferState& state)
+    {
+      Azure::Core::Context context = state.Context;
+      while (!state.Failed)
+      {
+        if (context.CancelWhen() < std::chrono::system_clock::now())
+        {
+          if (state.Failed.exchange(true) == false)
+          {
+            state.Exception
+                = std::make_exception_ptr(std::runtime_error("the operation was cancelled"));
+          }
+          break;
+        }
+        int64_t chunkId = state.NextChunkId.fetch_add(1);
+        if (chunkId >= state.NumChunks)
+        {
+          break;
+        }
+        int64_t chunkOffset = state.Offset + state.ChunkSize * chunkId;
+        int64_t chunkLength = std::min(state.Length - state.ChunkSize * chunkId, state.ChunkSize);
+        try
+        {
+          TransferChunk(context, [&]() {
+            auto permit = state.Governor->Acquire(context, state.ChunkBufferSize);
+            state.TransferFunc(context, chunkOffset, chunkLength, chunkId, state.NumChunks);
+          });
+        }
+        catch (...)
+        {
+          if (state.Failed.exchange(true) == false)
+          {
+            state.Exception = std::current_exception();
+            state.Context.Cancel();
+          }
+          break;
+        }
+      }
+    }
+
+    struct AdaptiveTransferState
+    {
+      // Cancelled when the transfer fails.
+      Azure::Core::Context Context;
+      int64_t End = 0;
+      int64_t MaxNumChunks = 0;
+      int64_t ChunkBufferSize = 0;
+      std::function<void(Azure::Core::Context&, int64_t, int64_t, int64_t)> TransferFunc;
+      TransferAutoTuner* Tuner = nullptr;
+      GovernedTransfer* Governor = nullptr;
+
+      std::mutex Mutex;
+      std::condition_variable Cv;
+      int64_t NextOffset = 0;
+      int64_t NextChunkId = 0;
+      bool Failed = false;
+      // The calling thread counts as an active worker.
+      int NumActiveWorkers = 0;
+      int NumPendingHelpers = 0;
+      bool Closed = false;
+      std::exception_ptr Exception;
+    };
+
+    void AdaptiveTransferWorker(const std::shared_ptr<AdaptiveTransferState>& state, bool isHelper);
+
+    void SubmitAdaptiveHelper(const std::shared_ptr<AdaptiveTransferState>& state)
+    {
+      WorkStealingThreadPool::GetDefault().Submit([state]() {
+        {
+          std::lock_guard<std::mutex> guard(state->Mutex);
+          --state->NumPendingHelpers;
+          if (state->Closed)
+          {
+            return;
+          }
+          ++state->NumActiveWorkers;
+        }
+        AdaptiveTransferWorker(state, true);
+        {
+          std::lock_guard<std::mutex> guard(state->Mutex);
+          --state->NumActiveWorkers;
+        }
+        state->Cv.notify_all();
+      });
+    }
+
+    void AdaptiveTransferWorker(const std::shared_ptr<AdaptiveTransferState>& state, bool isHelper)
+    {
+      Azure::Core::Context context = state->Context;
+      TransferAutoTuner& tuner = *state->Tuner;
+      while (true)
+      {
+        int64_t chunkOffset;
+        int64_t chunkLength;
+        int64_t chunkId;
+        {
+          std::lock_guard<std::mutex> guard(state->Mutex);
+          if (state->Failed || state->NextOffset == state->End)
+          {
+            break;
+          }
+          if (context.CancelWhen() < std::chrono::system_clock::now())
+          {
+            state->Failed = true;
+            state->Exception
+                = std::make_exception_ptr(std::runtime_error("the operation was cancelled"));
+            break;
+          }
+          int concurrency = tuner.GetConcurrency();
+          // Helpers retire when the tuner lowers concurrency, the calling thread always stays.
+          if (isHelper && state->NumActiveWorkers > concurrency)
+          {
+            break;
+          }
+
+          int64_t remaining = state->End - state->NextOffset;
+          int64_t remainingChunks = state->MaxNumChunks - state->NextChunkId;
+          int64_t chunkSize = tuner.GetChunkSize();
+          chunkLength = std::max(chunkSize, (remaining + remainingChunks - 1) / remainingChunks);
+          chunkLength = std::min(chunkLength, remaining);
+          chunkOffset = state->NextOffset;
+          chunkId = state->NextChunkId++;
+          state->NextOffset += chunkLength;
+
+          int64_t chunksLeft = (state->End - state->NextOffset + chunkSize - 1) / chunkSize;
+          while (state->NumActiveWorkers + state->NumPendingHelpers < concurrency
+                 && state->NumPendingHelpers < chunksLeft)
+          {
+            ++state->NumPendingHelpers;
+            SubmitAdaptiveHelper(state);
+          }
+        }
+
+        std::exception_ptr exception;
+        try
+        {
+          TransferChunk(
+              context,
+              [&]() {
+                auto permit = state->Governor->Acquire(context, state->ChunkBufferSize);
+                auto start = std::chrono::steady_clock::now();
+                state->TransferFunc(context, chunkOffset, chunkLength, chunkId);
+                tuner.OnChunkCompleted(chunkLength, std::chrono::steady_clock::now() - start);
+              },
+              [&tuner](const std::exception_ptr& attemptException) {
+                try
+                {
+                  std::rethrow_exception(attemptException);
+                }
+                catch (StorageError& e)
+                {
+                  if (e.StatusCode == Azure::Core::Http::HttpStatusCode::ServiceUnavailable
+                      || e.StatusCode == Azure::Core::Http::HttpStatusCode::InternalServerError)
+                  {
+                    tuner.OnThrottled();
+                  }
+                }
+                catch (...)
+                {
+                }
+              });
+        }
+        catch (...)
+        {
+          exception = std::current_exception();
+        }
+        if (exception)
+        {
+          std::lock_guard<std::mutex> guard(state->Mutex);
+          if (!state->Failed)
+          {
+            state->Failed = true;
+            state->Exception = exception;
+            state->Context.Cancel();
+          }
+          break;
+        }
+      }
+    }
+    struct StreamingTransferState
+    {
+      // Cancelled when the transfer fails.
+      Azure::Core::Context Context;
+      std::function<void(Azure::Core::Context&, const uint8_t*, int64_t, int64_t)> TransferFunc;
+      GovernedTransfer* Governor = nullptr;
+      int64_t ChunkBufferSize = 0;
+
+      std::mutex Mutex;
+      std::condition_variable Cv;
+      int NumInFlightChunks = 0;
+      std::atomic<bool> Failed{false};
+      std::exception_ptr Exception;
+    };
+
+    void Fail(StreamingTransferState& state, std::exception_ptr exception)
+    {
+      std::lock_guard<std::mutex> guard(state.Mutex);
+      if (!state.Failed)
+      {
+        state.Exception = std::move(exception);
+        state.Failed = true;
+        state.Context.Cancel();
+      }
+    }
+  } // namespace
+
+  void ConcurrentTransfer(
+      Azure::Core::Context context,
+      int64_t offset,
+      int64_t length,
+      int64_t chunkSize,
+      int concurrency,
+      std::function<void(Azure::Core::Context&, int64_t, int64_t, int64_t, int64_t)> transferFunc,
+      int64_t chunkBufferSize)
+  {
+    GovernedTransfer governor;
+    auto state = std::make_shared<TransferState>();
+    state->Governor = &governor;
+    state->Context = context.WithDeadline(Azure::Core::Context::time_point::max());
+    state->Offset = offset;
+    state->Length = length;
+    state->ChunkSize = chunkSize;
+    state->NumChunks = (length + chunkSize - 1) / chunkSize;
+    state->ChunkBufferSize = chunkBufferSize;
+    state->TransferFunc = std::move(transferFunc);
+
+    int64_t numHelpers = std::min(static_cast<int64_t>(concurrency) - 1, state->NumChunks - 1);
+    auto& threadPool = WorkStealingThreadPool::GetDefault();
+    for (int64_t i = 0; i < numHelpers; ++i)
+    {
+      threadPool.Submit([state]() {
+        {
+          std::lock_guard<std::mutex> guard(state->Mutex);
+          if (state->Closed)
+          {
+            return;
+          }
+          ++state->NumActiveWorkers;
+        }
+        TransferWorker(*state);
+        {
+          std::lock_guard<std::mutex> guard(state->Mutex);
+          --state->NumActiveWorkers;
+        }
+        state->Cv.notify_all();
+      });
+    }
+
+    TransferWorker(*state);
+
+    {
+      std::unique_lock<std::mutex> guard(state->Mutex);
+      state->Closed = true;
+      state->Cv.wait(guard, [&state]() { return state->NumActiveWorkers == 0; });
+    }
+
+    if (state->Exception)
+    {
+      std::rethrow_exception(state->Exception);
+    }
+  }
+
+  int64_t AdaptiveConcurrentTransfer(
+      Azure::Core::Context context,
+      int64_t offset,
+      int64_t length,
+      int64_t maxNumChunks,
+      TransferAutoTuner& tuner,
+      std::function<void(Azure::Core::Context&, int64_t, int64_t, int64_t)> transferFunc,
+      int64_t chunkBufferSize)
+  {
+    GovernedTransfer governor;
+    auto state = std::make_shared<AdaptiveTransferState>();
+    state->Governor = &governor;
+    state->Tuner = &tuner;
+    state->Context = context.WithDeadline(Azure::Core::Context::time_point::max());
+    state->NextOffset = offset;
+    state->End = offset + length;
+    state->MaxNumChunks = std::max(maxNumChunks, int64_t(1));
+    state->ChunkBufferSize = chunkBufferSize;
+    state->TransferFunc = std::move(transferFunc);
+    state->NumActiveWorkers = 1;
+
+    AdaptiveTransferWorker(state, false);
+
+    int64_t numChunks;
+    {
+      std::unique_lock<std::mutex> guard(state->Mutex);
+      --state->NumActiveWorkers;
+      state->Closed = true;
+      state->Cv.wait(guard, [&state]() { return state->NumActiveWorkers == 0; });
+      numChunks = state->NextChunkId;
+    }
+
+    if (state->Exception)
+    {
+      std::rethrow_exception(state->Exception);
+    }
+    return numChunks;
+  }
+
+  int64_t StreamingConcurrentTransfer(
+      Azure::Core::Context context,
+      Azure::Core::Http::BodyStream& content,
+      int64_t chunkSize,
+      int concurrency,
+      int64_t maxNumChunks,
+      std::function<void(Azure::Core::Context&, const uint8_t*, int64_t, int64_t)> transferFunc)
+  {
+    concurrency = std::max(concurrency, 1);
+    AlignedBufferPool bufferPool(chunkSize, concurrency);
+    GovernedTransfer governor;
+    auto state = std::make_shared<StreamingTransferState>();
+    state->Context = context.WithDeadline(Azure::Core::Context::time_point::max());
+    state->TransferFunc = std::move(transferFunc);
+    state->Governor = &governor;
+    state->ChunkBufferSize = chunkSize;
+
+    auto& threadPool = WorkStealingThreadPool::GetDefault();
+    int64_t numChunks = 0;
+    try
+    {
+      bool endOfStream = false;
+      while (!endOfStream && !state->Failed)
+      {
+        if (context.CancelWhen() < std::chrono::system_clock::now())
+        {
+          throw std::runtime_error("the operation was cancelled");
+        }
+        // Blocks while all buffers are in flight.
+        auto buffer = std::make_shared<AlignedBufferPool::Buffer>(bufferPool.Acquire(context));
+        int64_t length = 0;
+        while (length < chunkSize)
+        {
+          int64_t bytesRead = content.Read(context, buffer->Data() + length, chunkSize - length);
+          if (bytesRead == 0)
+          {
+            endOfStream = true;
+            break;
+          }
+          length += bytesRead;
+        }
+        if (length == 0)
+        {
+          break;
+        }
+        if (numChunks == maxNumChunks)
+        {
+          throw std::runtime_error("the content has more chunks than allowed");
+        }
+
+        int64_t chunkId = numChunks++;
+        {
+          std::lock_guard<std::mutex> guard(state->Mutex);
+          ++state->NumInFlightChunks;
+        }
+        threadPool.Submit([state, buffer, length, chunkId]() mutable {
+          if (!state->Failed)
+          {
+            try
+            {
+              Azure::Core::Context chunkContext = state->Context;
+              TransferChunk(chunkContext, [&]() {
+                auto permit = state->Governor->Acquire(chunkContext, state->ChunkBufferSize);
+                state->TransferFunc(chunkContext, buffer->Data(), length, chunkId);
+              });
+            }
+            catch (...)
+            {
+              Fail(*state, std::current_exception());
+            }
+          }
+          // Back to the pool before the caller can return and destroy it.
+          buffer.reset();
+          {
+            std::lock_guard<std::mutex> guard(state->Mutex);
+            --state->NumInFlightChunks;
+          }
+          state->Cv.notify_all();
+        });
+      }
+    }
+    catch (...)
+    {
+      Fail(*state, std::current_exception());
+    }
+
+    {
+      std::unique_lock<std::mutex> guard(state->Mutex);
+      state->Cv.wait(guard, [&state]() { return state->NumInFlightChunks == 0; });
+    }
+
+    if (state->Exception)
+    {
+      std::rethrow_exception(state->Exception);
+    }
+    return numChunks;
+  }
+
+}}} // namespace Azure::Storage::Details
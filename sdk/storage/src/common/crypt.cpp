@@ -9,12 +9,25 @@
 #include <Windows.h>
 #include <bcrypt.h>
 #else
-#include <openssl/bio.h>
-#include <openssl/buffer.h>
 #include <openssl/evp.h>
 #include <openssl/hmac.h>
 #endif
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define AZURE_STORAGE_CRC64_PCLMUL
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AZURE_STORAGE_TARGET_PCLMUL
+#else
+#define AZURE_STORAGE_TARGET_PCLMUL __attribute__((target("pclmul")))
+#endif
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 
 namespace Azure { namespace Storage {
@@ -111,41 +124,152 @@ namespace Azure { namespace Storage {
     return hash;
   }
 
-  std::string Base64Encode(const std::string& text)
-  {
-    std::string encoded;
-    // According to RFC 4648, the encoded length should be ceiling(n / 3) * 4
-    DWORD encodedLength = static_cast<DWORD>((text.length() + 2) / 3 * 4);
-    encoded.resize(encodedLength);
-
-    CryptBinaryToStringA(
-        reinterpret_cast<const BYTE*>(text.data()),
-        static_cast<DWORD>(text.length()),
-        CRYPT_STRING_BASE64 | CRYPT_STRING_NOCRLF,
-        static_cast<LPSTR>(&encoded[0]),
-        &encodedLength);
-
-    return encoded;
-  }
+  namespace {
+    struct HashAlgorithmProvider
+    {
+      BCRYPT_ALG_HANDLE Handle;
+      std::size_t ContextSize;
+      std::size_t HashLength;
+
+      explicit HashAlgorithmProvider(LPCWSTR algorithm)
+      {
+        NTSTATUS status = BCryptOpenAlgorithmProvider(&Handle, algorithm, nullptr, 0);
+        if (!BCRYPT_SUCCESS(status))
+        {
+          throw std::runtime_error("BCryptOpenAlgorithmProvider failed");
+        }
+        DWORD objectLength = 0;
+        DWORD dataLength = 0;
+        status = BCryptGetProperty(
+            Handle,
+            BCRYPT_OBJECT_LENGTH,
+            reinterpret_cast<PBYTE>(&objectLength),
+            sizeof(objectLength),
+            &dataLength,
+            0);
+        if (!BCRYPT_SUCCESS(status))
+        {
+          throw std::runtime_error("BCryptGetProperty failed");
+        }
+        ContextSize = objectLength;
+        DWORD hashLength = 0;
+        status = BCryptGetProperty(
+            Handle,
+            BCRYPT_HASH_LENGTH,
+            reinterpret_cast<PBYTE>(&hashLength),
+            sizeof(hashLength),
+            &dataLength,
+            0);
+        if (!BCRYPT_SUCCESS(status))
+        {
+          throw std::runtime_error("BCryptGetProperty failed");
+        }
+        HashLength = hashLength;
+      }
+
+      ~HashAlgorithmProvider() { BCryptCloseAlgorithmProvider(Handle, 0); }
+    };
 
-  std::string Base64Decode(const std::string& text)
+    struct DigestContext
+    {
+      BCRYPT_HASH_HANDLE Handle;
+      std::string HashObject;
+      std::size_t HashLength;
+    };
+
+    void* CreateDigestContext(const HashAlgorithmProvider& provider)
+    {
+      auto context = new DigestContext();
+      context->HashObject.resize(provider.ContextSize);
+      context->HashLength = provider.HashLength;
+      NTSTATUS status = BCryptCreateHash(
+          provider.Handle,
+          &context->Handle,
+          reinterpret_cast<PUCHAR>(&context->HashObject[0]),
+          static_cast<ULONG>(context->HashObject.size()),
+          nullptr,
+          0,
+          0);
+      if (!BCRYPT_SUCCESS(status))
+      {
+        delete context;
+        throw std::runtime_error("BCryptCreateHash failed");
+      }
+      return context;
+    }
+
+    void DestroyDigestContext(void* digestContext)
+    {
+      auto context = static_cast<DigestContext*>(digestContext);
+      BCryptDestroyHash(context->Handle);
+      delete context;
+    }
+
+    void UpdateDigest(void* digestContext, const uint8_t* data, std::size_t length)
+    {
+      auto context = static_cast<DigestContext*>(digestContext);
+      while (length > 0)
+      {
+        ULONG bytesToHash = static_cast<ULONG>(std::min<std::size_t>(length, ULONG(-1)));
+        NTSTATUS status
+            = BCryptHashData(context->Handle, const_cast<PUCHAR>(data), bytesToHash, 0);
+        if (!BCRYPT_SUCCESS(status))
+        {
+          throw std::runtime_error("BCryptHashData failed");
+        }
+        data += bytesToHash;
+        length -= bytesToHash;
+      }
+    }
+
+    std::string FinishDigest(void* digestContext)
+    {
+      auto context = static_cast<DigestContext*>(digestContext);
+      std::string hash;
+      hash.resize(context->HashLength);
+      NTSTATUS status = BCryptFinishHash(
+          context->Handle,
+          reinterpret_cast<PUCHAR>(&hash[0]),
+          static_cast<ULONG>(hash.length()),
+          0);
+      if (!BCRYPT_SUCCESS(status))
+      {
+        throw std::runtime_error("BCryptFinishHash failed");
+      }
+      return hash;
+    }
+
+    void* DuplicateDigestContext(void* digestContext)
+    {
+      auto source = static_cast<DigestContext*>(digestContext);
+      auto context = new DigestContext();
+      context->HashObject.resize(source->HashObject.size());
+      context->HashLength = source->HashLength;
+      NTSTATUS status = BCryptDuplicateHash(
+          source->Handle,
+          &context->Handle,
+          reinterpret_cast<PUCHAR>(&context->HashObject[0]),
+          static_cast<ULONG>(context->HashObject.size()),
+          0);
+      if (!BCRYPT_SUCCESS(status))
+      {
+        delete context;
+        throw std::runtime_error("BCryptDuplicateHash failed");
+      }
+      return context;
+    }
+
+    void* CreateSha256Context()
+    {
+      static HashAlgorithmProvider AlgorithmProvider(BCRYPT_SHA256_ALGORITHM);
+      return CreateDigestContext(AlgorithmProvider);
+    }
+  } // namespace
+
+  Md5::Md5()
   {
-    std::string decoded;
-    // According to RFC 4648, the encoded length should be ceiling(n / 3) * 4, so we can infer an
-    // upper bound here
-    DWORD decodedLength = DWORD(text.length() / 4 * 3);
-    decoded.resize(decodedLength);
-
-    CryptStringToBinaryA(
-        text.data(),
-        static_cast<DWORD>(text.length()),
-        CRYPT_STRING_BASE64 | CRYPT_STRING_STRICT,
-        reinterpret_cast<BYTE*>(&decoded[0]),
-        &decodedLength,
-        nullptr,
-        nullptr);
-    decoded.resize(decodedLength);
-    return decoded;
+    static HashAlgorithmProvider AlgorithmProvider(BCRYPT_MD5_ALGORITHM);
+    m_context = CreateDigestContext(AlgorithmProvider);
   }
 
 #else
@@ -166,38 +290,350 @@ namespace Azure { namespace Storage {
     return std::string(hash, hashLength);
   }
 
-  std::string Base64Encode(const std::string& text)
+  namespace {
+    void* CreateDigestContext(const EVP_MD* algorithm)
+    {
+      EVP_MD_CTX* context = EVP_MD_CTX_create();
+      if (context == nullptr)
+      {
+        throw std::bad_alloc();
+      }
+      if (EVP_DigestInit_ex(context, algorithm, nullptr) != 1)
+      {
+        EVP_MD_CTX_destroy(context);
+        throw std::runtime_error("EVP_DigestInit_ex failed");
+      }
+      return context;
+    }
+
+    void DestroyDigestContext(void* context)
+    {
+      EVP_MD_CTX_destroy(static_cast<EVP_MD_CTX*>(context));
+    }
+
+    void UpdateDigest(void* context, const uint8_t* data, std::size_t length)
+    {
+      if (EVP_DigestUpdate(static_cast<EVP_MD_CTX*>(context), data, length) != 1)
+      {
+        throw std::runtime_error("EVP_DigestUpdate failed");
+      }
+    }
+
+    std::string FinishDigest(void* context)
+    {
+      unsigned char hash[EVP_MAX_MD_SIZE];
+      unsigned int hashLength = 0;
+      if (EVP_DigestFinal_ex(static_cast<EVP_MD_CTX*>(context), hash, &hashLength) != 1)
+      {
+        throw std::runtime_error("EVP_DigestFinal_ex failed");
+      }
+      return std::string(reinterpret_cast<char*>(hash), hashLength);
+    }
+
+    void* DuplicateDigestContext(void* source)
+    {
+      EVP_MD_CTX* context = EVP_MD_CTX_create();
+      if (context == nullptr)
+      {
+        throw std::bad_alloc();
+      }
+      if (EVP_MD_CTX_copy_ex(context, static_cast<EVP_MD_CTX*>(source)) != 1)
+      {
+        EVP_MD_CTX_destroy(context);
+        throw std::runtime_error("EVP_MD_CTX_copy_ex failed");
+      }
+      return context;
+    }
+
+    void* CreateSha256Context() { return CreateDigestContext(EVP_sha256()); }
+  } // namespace
+
+  Md5::Md5() : m_context(CreateDigestContext(EVP_md5())) {}
+#endif
+
+  Sha256::Sha256() : m_context(CreateSha256Context()) {}
+
+  Md5::~Md5() { DestroyDigestContext(m_context); }
+
+  void Md5::Update(const uint8_t* data, std::size_t length)
+  {
+    UpdateDigest(m_context, data, length);
+  }
+
+  std::string Md5::Digest() { return FinishDigest(m_context); }
+
+  Sha256::~Sha256() { DestroyDigestContext(m_context); }
+
+  void Sha256::Update(const uint8_t* data, std::size_t length)
+  {
+    UpdateDigest(m_context, data, length);
+  }
+
+  std::string Sha256::Digest() { return FinishDigest(m_context); }
+
+  namespace {
+    // Hashes text on top of a copy of context, which is left as it was.
+    std::string ContinueDigest(void* context, const std::string& text)
+    {
+      std::unique_ptr<void, void (*)(void*)> copy(
+          DuplicateDigestContext(context), DestroyDigestContext);
+      UpdateDigest(copy.get(), reinterpret_cast<const uint8_t*>(text.data()), text.length());
+      return FinishDigest(copy.get());
+    }
+  } // namespace
+
+  HmacSha256::HmacSha256(const std::string& key)
+  {
+    constexpr std::size_t c_blockSize = 64;
+    std::string blockKey = key;
+    if (blockKey.length() > c_blockSize)
+    {
+      Sha256 sha256;
+      sha256.Update(reinterpret_cast<const uint8_t*>(blockKey.data()), blockKey.length());
+      blockKey = sha256.Digest();
+    }
+    blockKey.resize(c_blockSize, '\0');
+
+    // The hashes of the padded key blocks are the key schedule, every signature starts from a copy
+    // of them.
+    uint8_t pad[c_blockSize];
+    m_innerContext = CreateSha256Context();
+    for (std::size_t i = 0; i < c_blockSize; ++i)
+    {
+      pad[i] = static_cast<uint8_t>(blockKey[i] ^ 0x36);
+    }
+    UpdateDigest(m_innerContext, pad, c_blockSize);
+    m_outerContext = CreateSha256Context();
+    for (std::size_t i = 0; i < c_blockSize; ++i)
+    {
+      pad[i] = static_cast<uint8_t>(blockKey[i] ^ 0x5c);
+    }
+    UpdateDigest(m_outerContext, pad, c_blockSize);
+  }
+
+  HmacSha256::~HmacSha256()
+  {
+    DestroyDigestContext(m_innerContext);
+    DestroyDigestContext(m_outerContext);
+  }
+
+  std::string HmacSha256::Sign(const std::string& text) const
   {
-    BIO* bio = BIO_new(BIO_s_mem());
-    bio = BIO_push(BIO_new(BIO_f_base64()), bio);
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
-    BIO_write(bio, text.data(), static_cast<int>(text.length()));
-    BIO_flush(bio);
-    BUF_MEM* bufferPtr;
-    BIO_get_mem_ptr(bio, &bufferPtr);
-    BIO_set_close(bio, BIO_NOCLOSE);
-    BIO_free_all(bio);
-
-    return std::string(bufferPtr->data, bufferPtr->length);
+    return ContinueDigest(m_outerContext, ContinueDigest(m_innerContext, text));
   }
 
-  std::string Base64Decode(const std::string& text)
+  std::string MD5(const std::string& text)
   {
-    std::string decoded;
-    // According to RFC 4648, the encoded length should be ceiling(n / 3) * 4, so we can infer an
-    // upper bound here
-    std::size_t maxDecodedLength = text.length() / 4 * 3;
-    decoded.resize(maxDecodedLength);
-
-    BIO* bio = BIO_new_mem_buf(text.data(), -1);
-    bio = BIO_push(BIO_new(BIO_f_base64()), bio);
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
-    int decodedLength = BIO_read(bio, &decoded[0], static_cast<int>(text.length()));
-    BIO_free_all(bio);
-
-    decoded.resize(decodedLength);
-    return decoded;
+    Md5 md5;
+    md5.Update(reinterpret_cast<const uint8_t*>(text.data()), text.length());
+    return md5.Digest();
   }
+
+  namespace {
+    // Reflected, bit i stands for the coefficient of x^(63 - i).
+    constexpr uint64_t c_crc64Polynomial = 0x9A6C9329AC4BC9B5ULL;
+
+    // Multiplies two polynomials modulo the CRC64 polynomial.
+    uint64_t Crc64MultiplyModP(uint64_t a, uint64_t b)
+    {
+      uint64_t product = 0;
+      for (uint64_t bit = uint64_t(1) << 63; bit != 0 && a != 0; bit >>= 1)
+      {
+        if (a & bit)
+        {
+          product ^= b;
+          a ^= bit;
+        }
+        b = (b >> 1) ^ (b & 1 ? c_crc64Polynomial : 0);
+      }
+      return product;
+    }
+
+    // Returns x^n modulo the CRC64 polynomial.
+    uint64_t Crc64XPowModP(uint64_t n)
+    {
+      uint64_t power = uint64_t(1) << 63;
+      uint64_t square = uint64_t(1) << 62;
+      for (; n != 0; n >>= 1)
+      {
+        if (n & 1)
+        {
+          power = Crc64MultiplyModP(power, square);
+        }
+        square = Crc64MultiplyModP(square, square);
+      }
+      return power;
+    }
+
+    struct Crc64Tables
+    {
+      // Slicing-by-8 lookup tables.
+      uint64_t Table[8][256];
+      // Folding 16 byte blocks forward by 128 and 512 bits with carry-less multiplication. The low
+      // half of a block is multiplied by x^(distance + 63), the high half by x^(distance - 1), one
+      // less than the distance because multiplying reflected polynomials shifts the product by
+      // one.
+      uint64_t Fold128[2];
+      uint64_t Fold512[2];
+      bool HasPclmul = false;
+
+      Crc64Tables()
+      {
+        for (uint64_t i = 0; i < 256; ++i)
+        {
+          uint64_t crc = i;
+          for (int j = 0; j < 8; ++j)
+          {
+            crc = (crc >> 1) ^ (crc & 1 ? c_crc64Polynomial : 0);
+          }
+          Table[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k)
+        {
+          for (int i = 0; i < 256; ++i)
+          {
+            Table[k][i] = (Table[k - 1][i] >> 8) ^ Table[0][Table[k - 1][i] & 0xff];
+          }
+        }
+        Fold128[0] = Crc64XPowModP(128 + 63);
+        Fold128[1] = Crc64XPowModP(128 - 1);
+        Fold512[0] = Crc64XPowModP(512 + 63);
+        Fold512[1] = Crc64XPowModP(512 - 1);
+#if defined(AZURE_STORAGE_CRC64_PCLMUL)
+#ifdef _MSC_VER
+        int cpuInfo[4];
+        __cpuid(cpuInfo, 1);
+        HasPclmul = (cpuInfo[2] & (1 << 1)) != 0;
+#else
+        __builtin_cpu_init();
+        HasPclmul = __builtin_cpu_supports("pclmul");
+#endif
+#endif
+      }
+    };
+
+    const Crc64Tables& GetCrc64Tables()
+    {
+      static const Crc64Tables tables;
+      return tables;
+    }
+
+    // crc is the running remainder, without the inversion applied at the start and the end.
+    uint64_t Crc64Table(uint64_t crc, const uint8_t* data, std::size_t length)
+    {
+      const auto& table = GetCrc64Tables().Table;
+#if !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+      for (; length >= 8; data += 8, length -= 8)
+      {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc ^= word;
+        crc = table[7][crc & 0xff] ^ table[6][(crc >> 8) & 0xff] ^ table[5][(crc >> 16) & 0xff]
+            ^ table[4][(crc >> 24) & 0xff] ^ table[3][(crc >> 32) & 0xff]
+            ^ table[2][(crc >> 40) & 0xff] ^ table[1][(crc >> 48) & 0xff] ^ table[0][crc >> 56];
+      }
 #endif
+      for (; length > 0; ++data, --length)
+      {
+        crc = table[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+      }
+      return crc;
+    }
+
+#if defined(AZURE_STORAGE_CRC64_PCLMUL)
+    AZURE_STORAGE_TARGET_PCLMUL __m128i Crc64Fold(__m128i block, __m128i constants)
+    {
+      return _mm_xor_si128(
+          _mm_clmulepi64_si128(block, constants, 0x00),
+          _mm_clmulepi64_si128(block, constants, 0x11));
+    }
+
+    // Folds four 16 byte lanes at a time down to a single block, which is then reduced with the
+    // table. length must be at least 64.
+    AZURE_STORAGE_TARGET_PCLMUL uint64_t
+    Crc64Pclmul(uint64_t crc, const uint8_t* data, std::size_t length)
+    {
+      const auto& tables = GetCrc64Tables();
+      const __m128i fold128 = _mm_set_epi64x(
+          static_cast<long long>(tables.Fold128[1]), static_cast<long long>(tables.Fold128[0]));
+      const __m128i fold512 = _mm_set_epi64x(
+          static_cast<long long>(tables.Fold512[1]), static_cast<long long>(tables.Fold512[0]));
+      auto load = [](const uint8_t* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      };
+
+      __m128i x0 = _mm_xor_si128(load(data), _mm_cvtsi64_si128(static_cast<long long>(crc)));
+      __m128i x1 = load(data + 16);
+      __m128i x2 = load(data + 32);
+      __m128i x3 = load(data + 48);
+      data += 64;
+      length -= 64;
+      for (; length >= 64; data += 64, length -= 64)
+      {
+        x0 = _mm_xor_si128(Crc64Fold(x0, fold512), load(data));
+        x1 = _mm_xor_si128(Crc64Fold(x1, fold512), load(data + 16));
+        x2 = _mm_xor_si128(Crc64Fold(x2, fold512), load(data + 32));
+        x3 = _mm_xor_si128(Crc64Fold(x3, fold512), load(data + 48));
+      }
+      x0 = _mm_xor_si128(Crc64Fold(x0, fold128), x1);
+      x0 = _mm_xor_si128(Crc64Fold(x0, fold128), x2);
+      x0 = _mm_xor_si128(Crc64Fold(x0, fold128), x3);
+      for (; length >= 16; data += 16, length -= 16)
+      {
+        x0 = _mm_xor_si128(Crc64Fold(x0, fold128), load(data));
+      }
+
+      // The remainder of the folded block, shifted by 64 bits, is the CRC of its bytes.
+      uint8_t folded[16];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(folded), x0);
+      crc = Crc64Table(0, folded, sizeof(folded));
+      return Crc64Table(crc, data, length);
+    }
+#endif
+  } // namespace
+
+  void Crc64::Update(const uint8_t* data, std::size_t length)
+  {
+    uint64_t crc = ~m_context;
+#if defined(AZURE_STORAGE_CRC64_PCLMUL)
+    // Below this, setting up the folding costs more than it saves.
+    constexpr std::size_t c_pclmulThreshold = 128;
+    if (length >= c_pclmulThreshold && GetCrc64Tables().HasPclmul)
+    {
+      crc = Crc64Pclmul(crc, data, length);
+    }
+    else
+#endif
+    {
+      crc = Crc64Table(crc, data, length);
+    }
+    m_context = ~crc;
+    m_length += length;
+  }
+
+  void Crc64::Concatenate(const Crc64& other)
+  {
+    // The inversions at the start and the end cancel out, so the checksums combine like the
+    // plain remainders: shift this one past the other data and add.
+    m_context = Crc64MultiplyModP(m_context, Crc64XPowModP(other.m_length * 8)) ^ other.m_context;
+    m_length += other.m_length;
+  }
+
+  std::string Crc64::Digest() const
+  {
+    std::string digest(8, '\0');
+    for (std::size_t i = 0; i < digest.length(); ++i)
+    {
+      digest[i] = static_cast<char>((m_context >> (8 * i)) & 0xff);
+    }
+    return digest;
+  }
+
+  std::string CRC64(const std::string& text)
+  {
+    Crc64 crc64;
+    crc64.Update(reinterpret_cast<const uint8_t*>(text.data()), text.length());
+    return crc64.Digest();
+  }
 
 }} // namespace Azure::Storage
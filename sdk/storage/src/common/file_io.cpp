@@ -5,17 +5,77 @@
 
 #ifndef _WIN32
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
 
+#if defined(AZURE_STORAGE_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 
 namespace Azure { namespace Storage { namespace Details {
 
 #ifdef _WIN32
+  namespace {
+    // Returns the number of bytes read, 0 at the end of the file.
+    int64_t ReadAt(FileHandle handle, uint8_t* buffer, int64_t length, int64_t offset)
+    {
+      OVERLAPPED overlapped;
+      std::memset(&overlapped, 0, sizeof(overlapped));
+      overlapped.Offset = static_cast<DWORD>(static_cast<uint64_t>(offset));
+      overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+
+      DWORD bytesRead;
+      BOOL ret = ReadFile(
+          handle,
+          buffer,
+          static_cast<DWORD>(std::min(length, int64_t(std::numeric_limits<DWORD>::max()))),
+          &bytesRead,
+          &overlapped);
+      if (!ret)
+      {
+        if (GetLastError() == ERROR_HANDLE_EOF)
+        {
+          return 0;
+        }
+        throw std::runtime_error("failed to read file");
+      }
+      return bytesRead;
+    }
+
+    // Returns the number of bytes written, which may be less than length.
+    int64_t WriteAt(FileHandle handle, const uint8_t* buffer, int64_t length, int64_t offset)
+    {
+      OVERLAPPED overlapped;
+      std::memset(&overlapped, 0, sizeof(overlapped));
+      overlapped.Offset = static_cast<DWORD>(static_cast<uint64_t>(offset));
+      overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+
+      DWORD bytesWritten;
+      BOOL ret = WriteFile(
+          handle,
+          buffer,
+          static_cast<DWORD>(std::min(length, int64_t(std::numeric_limits<DWORD>::max()))),
+          &bytesWritten,
+          &overlapped);
+      if (!ret)
+      {
+        throw std::runtime_error("failed to write file");
+      }
+      return bytesWritten;
+    }
+  } // namespace
+
   FileReader::FileReader(const std::string& filename)
   {
     m_handle = CreateFile(
@@ -39,48 +99,161 @@ namespace Azure { namespace Storage { namespace Details {
       throw std::runtime_error("failed to get size of file");
     }
     m_fileSize = fileSize.QuadPart;
+
+    FILETIME lastWriteTime;
+    if (!GetFileTime(m_handle, nullptr, nullptr, &lastWriteTime))
+    {
+      CloseHandle(m_handle);
+      throw std::runtime_error("failed to get modification time of file");
+    }
+    m_lastModifiedTime = static_cast<int64_t>(
+        (static_cast<uint64_t>(lastWriteTime.dwHighDateTime) << 32) | lastWriteTime.dwLowDateTime);
   }
 
   FileReader::~FileReader() { CloseHandle(m_handle); }
 
-  FileWriter::FileWriter(const std::string& filename)
+  MemoryMappedFile::MemoryMappedFile(const FileReader& fileReader)
+      : m_size(fileReader.GetFileSize())
+  {
+    if (m_size <= 0 || static_cast<uint64_t>(m_size) > std::numeric_limits<SIZE_T>::max())
+    {
+      throw std::runtime_error("failed to map file");
+    }
+    m_mapping = CreateFileMapping(fileReader.GetHandle(), nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == NULL)
+    {
+      throw std::runtime_error("failed to map file");
+    }
+    void* data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(m_size));
+    if (data == nullptr)
+    {
+      CloseHandle(m_mapping);
+      throw std::runtime_error("failed to map file");
+    }
+    m_data = static_cast<const uint8_t*>(data);
+  }
+
+  MemoryMappedFile::~MemoryMappedFile()
+  {
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+  }
+
+  FileWriter::FileWriter(const std::string& filename, bool directIo, bool truncate)
+      : m_directHandle(INVALID_HANDLE_VALUE)
   {
     m_handle = CreateFile(
         filename.data(),
         GENERIC_WRITE,
         FILE_SHARE_READ | FILE_SHARE_WRITE,
         nullptr,
-        CREATE_ALWAYS,
+        truncate ? CREATE_ALWAYS : OPEN_ALWAYS,
         FILE_ATTRIBUTE_NORMAL,
         NULL);
     if (m_handle == INVALID_HANDLE_VALUE)
     {
       throw std::runtime_error("failed to open file");
     }
+    if (directIo)
+    {
+      // Unbuffered writes are optional, keep going without them if the file system refuses.
+      m_directHandle = CreateFile(
+          filename.data(),
+          GENERIC_WRITE,
+          FILE_SHARE_READ | FILE_SHARE_WRITE,
+          nullptr,
+          OPEN_EXISTING,
+          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING,
+          NULL);
+    }
   }
 
-  FileWriter::~FileWriter() { CloseHandle(m_handle); }
-
-  void FileWriter::Write(const uint8_t* buffer, int64_t length, int64_t offset)
+  FileWriter::~FileWriter()
   {
-    if (length > std::numeric_limits<DWORD>::max())
+    if (m_directHandle != INVALID_HANDLE_VALUE)
     {
-      throw std::runtime_error("failed to write file");
+      CloseHandle(m_directHandle);
     }
+    CloseHandle(m_handle);
+  }
 
-    OVERLAPPED overlapped;
-    std::memset(&overlapped, 0, sizeof(overlapped));
-    overlapped.Offset = static_cast<DWORD>(static_cast<uint64_t>(offset));
-    overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+  bool FileWriter::IsDirectIo() const { return m_directHandle != INVALID_HANDLE_VALUE; }
 
-    DWORD bytesWritten;
-    BOOL ret = WriteFile(m_handle, buffer, static_cast<DWORD>(length), &bytesWritten, &overlapped);
-    if (!ret)
+  void FileWriter::Preallocate(int64_t size)
+  {
+    FILE_ALLOCATION_INFO allocationInfo;
+    allocationInfo.AllocationSize.QuadPart = size;
+    // Only a hint, failures are harmless.
+    SetFileInformationByHandle(
+        m_handle, FileAllocationInfo, &allocationInfo, sizeof(allocationInfo));
+  }
+
+  void FileWriter::DropCache(int64_t offset, int64_t length)
+  {
+    // Windows has no way to evict a range of a file from the cache.
+    (void)offset;
+    (void)length;
+  }
+
+  void FileWriter::Write(const uint8_t* buffer, int64_t length, int64_t offset)
+  {
+    while (length > 0)
     {
-      throw std::runtime_error("failed to write file");
+      int64_t bytesWritten = WriteAt(GetHandle(buffer, length, offset), buffer, length, offset);
+      if (bytesWritten == 0)
+      {
+        throw std::runtime_error("failed to write file");
+      }
+      buffer += bytesWritten;
+      length -= bytesWritten;
+      offset += bytesWritten;
     }
   }
 #else
+  namespace {
+    // Returns the number of bytes read, 0 at the end of the file.
+    int64_t ReadAt(FileHandle handle, uint8_t* buffer, int64_t length, int64_t offset)
+    {
+      if (offset > static_cast<int64_t>(std::numeric_limits<off_t>::max()))
+      {
+        throw std::runtime_error("failed to read file");
+      }
+      std::size_t count = static_cast<std::size_t>(
+          std::min(length, int64_t(std::numeric_limits<ssize_t>::max())));
+      ssize_t bytesRead;
+      do
+      {
+        bytesRead = pread(handle, buffer, count, static_cast<off_t>(offset));
+      } while (bytesRead == -1 && errno == EINTR);
+      if (bytesRead == -1)
+      {
+        throw std::runtime_error("failed to read file");
+      }
+      return bytesRead;
+    }
+
+    // Returns the number of bytes written, which may be less than length.
+    int64_t WriteAt(FileHandle handle, const uint8_t* buffer, int64_t length, int64_t offset)
+    {
+      if (offset > static_cast<int64_t>(std::numeric_limits<off_t>::max()))
+      {
+        throw std::runtime_error("failed to write file");
+      }
+      std::size_t count = static_cast<std::size_t>(
+          std::min(length, int64_t(std::numeric_limits<ssize_t>::max())));
+      ssize_t bytesWritten;
+      do
+      {
+        bytesWritten = pwrite(handle, buffer, count, static_cast<off_t>(offset));
+      } while (bytesWritten == -1 && errno == EINTR);
+      if (bytesWritten == -1)
+      {
+        throw std::runtime_error("failed to write file");
+      }
+      return bytesWritten;
+    }
+  } // namespace
+
   FileReader::FileReader(const std::string& filename)
   {
     m_handle = open(filename.data(), O_RDONLY);
@@ -94,36 +267,688 @@ namespace Azure { namespace Storage { namespace Details {
       close(m_handle);
       throw std::runtime_error("failed to get size of file");
     }
+
+    struct stat fileStat;
+    if (fstat(m_handle, &fileStat) != 0)
+    {
+      close(m_handle);
+      throw std::runtime_error("failed to get modification time of file");
+    }
+#if defined(__APPLE__)
+    const struct timespec& lastModifiedTime = fileStat.st_mtimespec;
+#else
+    const struct timespec& lastModifiedTime = fileStat.st_mtim;
+#endif
+    m_lastModifiedTime = static_cast<int64_t>(lastModifiedTime.tv_sec) * 1000000000
+        + static_cast<int64_t>(lastModifiedTime.tv_nsec);
   }
 
   FileReader::~FileReader() { close(m_handle); }
 
-  FileWriter::FileWriter(const std::string& filename)
+  MemoryMappedFile::MemoryMappedFile(const FileReader& fileReader)
+      : m_size(fileReader.GetFileSize())
+  {
+    if (m_size <= 0 || static_cast<uint64_t>(m_size) > std::numeric_limits<std::size_t>::max())
+    {
+      throw std::runtime_error("failed to map file");
+    }
+    void* data = mmap(
+        nullptr,
+        static_cast<std::size_t>(m_size),
+        PROT_READ,
+        MAP_SHARED,
+        fileReader.GetHandle(),
+        0);
+    if (data == MAP_FAILED)
+    {
+      throw std::runtime_error("failed to map file");
+    }
+    // Only hints, the mapping works the same without them.
+    posix_madvise(data, static_cast<std::size_t>(m_size), POSIX_MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(data, static_cast<std::size_t>(m_size), MADV_HUGEPAGE);
+#endif
+    m_data = static_cast<const uint8_t*>(data);
+  }
+
+  MemoryMappedFile::~MemoryMappedFile()
+  {
+    munmap(const_cast<uint8_t*>(m_data), static_cast<std::size_t>(m_size));
+  }
+
+  FileWriter::FileWriter(const std::string& filename, bool directIo, bool truncate)
+      : m_directHandle(-1)
   {
     m_handle = open(
-        filename.data(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        filename.data(),
+        O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0),
+        S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
     if (m_handle == -1)
     {
       throw std::runtime_error("failed to open file");
     }
+#ifdef O_DIRECT
+    if (directIo)
+    {
+      // Some file systems, tmpfs for example, reject O_DIRECT. Keep going without it.
+      m_directHandle = open(filename.data(), O_WRONLY | O_DIRECT);
+    }
+#else
+    (void)directIo;
+#endif
   }
 
-  FileWriter::~FileWriter() { close(m_handle); }
+  FileWriter::~FileWriter()
+  {
+    if (m_directHandle != -1)
+    {
+      close(m_directHandle);
+    }
+    close(m_handle);
+  }
+
+  bool FileWriter::IsDirectIo() const { return m_directHandle != -1; }
+
+  void FileWriter::Preallocate(int64_t size)
+  {
+#if defined(__linux__)
+    // Only a hint, failures (EOPNOTSUPP on some file systems) are harmless.
+    int ret;
+    do
+    {
+      ret = fallocate(m_handle, 0, 0, static_cast<off_t>(size));
+    } while (ret == -1 && errno == EINTR);
+#else
+    (void)size;
+#endif
+  }
+
+  void FileWriter::DropCache(int64_t offset, int64_t length)
+  {
+#if defined(__linux__)
+    // Dirty pages can't be dropped, write them back first.
+    sync_file_range(
+        m_handle,
+        static_cast<off_t>(offset),
+        static_cast<off_t>(length),
+        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    posix_fadvise(
+        m_handle, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+  }
 
   void FileWriter::Write(const uint8_t* buffer, int64_t length, int64_t offset)
   {
-    if (static_cast<uint64_t>(length) > std::numeric_limits<size_t>::max()
-        || offset > static_cast<int64_t>(std::numeric_limits<off_t>::max()))
+    while (length > 0)
+    {
+      int64_t bytesWritten = WriteAt(GetHandle(buffer, length, offset), buffer, length, offset);
+      if (bytesWritten == 0)
+      {
+        throw std::runtime_error("failed to write file");
+      }
+      buffer += bytesWritten;
+      length -= bytesWritten;
+      offset += bytesWritten;
+    }
+  }
+#endif
+
+  constexpr int64_t FileWriter::DirectIoAlignment;
+
+  FileHandle FileWriter::GetHandle(const uint8_t* buffer, int64_t length, int64_t offset) const
+  {
+    if (IsDirectIo() && reinterpret_cast<uintptr_t>(buffer) % DirectIoAlignment == 0
+        && length % DirectIoAlignment == 0 && offset % DirectIoAlignment == 0)
+    {
+      return m_directHandle;
+    }
+    return m_handle;
+  }
+
+  namespace {
+    // Finishes a request that the kernel completed only partially, or not at all.
+    void CompleteSynchronously(FileIoRequest& request)
+    {
+      while (request.BytesTransferred < request.Length)
+      {
+        uint8_t* buffer = request.Buffer + request.BytesTransferred;
+        int64_t length = request.Length - request.BytesTransferred;
+        int64_t offset = request.Offset + request.BytesTransferred;
+        int64_t bytesTransferred = request.IsWrite
+            ? WriteAt(request.Handle, buffer, length, offset)
+            : ReadAt(request.Handle, buffer, length, offset);
+        if (bytesTransferred == 0)
+        {
+          if (request.IsWrite)
+          {
+            throw std::runtime_error("failed to write file");
+          }
+          break;
+        }
+        request.BytesTransferred += bytesTransferred;
+      }
+    }
+  } // namespace
+
+#if defined(AZURE_STORAGE_IO_URING)
+  struct FileIoEngine::IoUring
+  {
+    int Fd = -1;
+    void* SqRing = MAP_FAILED;
+    std::size_t SqRingSize = 0;
+    void* CqRing = MAP_FAILED;
+    std::size_t CqRingSize = 0;
+    void* SqesMapping = MAP_FAILED;
+    std::size_t SqesSize = 0;
+
+    unsigned* SqTail = nullptr;
+    unsigned SqMask = 0;
+    unsigned* SqArray = nullptr;
+    unsigned SqEntries = 0;
+    io_uring_sqe* Sqes = nullptr;
+    unsigned* CqHead = nullptr;
+    unsigned* CqTail = nullptr;
+    unsigned CqMask = 0;
+    io_uring_cqe* Cqes = nullptr;
+    bool BuffersRegistered = false;
+
+    ~IoUring()
+    {
+      if (SqesMapping != MAP_FAILED)
+      {
+        munmap(SqesMapping, SqesSize);
+      }
+      if (CqRing != MAP_FAILED && CqRing != SqRing)
+      {
+        munmap(CqRing, CqRingSize);
+      }
+      if (SqRing != MAP_FAILED)
+      {
+        munmap(SqRing, SqRingSize);
+      }
+      if (Fd != -1)
+      {
+        close(Fd);
+      }
+    }
+
+    // Returns false if the kernel doesn't support io_uring or doesn't let us use it, seccomp
+    // profiles of container runtimes commonly block it.
+    bool Setup(unsigned entries)
+    {
+      io_uring_params params;
+      std::memset(&params, 0, sizeof(params));
+      int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+      if (fd < 0)
+      {
+        return false;
+      }
+      Fd = fd;
+
+      SqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+      if (singleMmap)
+      {
+        SqRingSize = CqRingSize = std::max(SqRingSize, CqRingSize);
+      }
+      SqRing = mmap(
+          nullptr,
+          SqRingSize,
+          PROT_READ | PROT_WRITE,
+          MAP_SHARED | MAP_POPULATE,
+          Fd,
+          IORING_OFF_SQ_RING);
+      if (SqRing == MAP_FAILED)
+      {
+        return false;
+      }
+      if (singleMmap)
+      {
+        CqRing = SqRing;
+      }
+      else
+      {
+        CqRing = mmap(
+            nullptr,
+            CqRingSize,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            Fd,
+            IORING_OFF_CQ_RING);
+        if (CqRing == MAP_FAILED)
+        {
+          return false;
+        }
+      }
+      SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+      SqesMapping = mmap(
+          nullptr,
+          SqesSize,
+          PROT_READ | PROT_WRITE,
+          MAP_SHARED | MAP_POPULATE,
+          Fd,
+          IORING_OFF_SQES);
+      if (SqesMapping == MAP_FAILED)
+      {
+        return false;
+      }
+
+      uint8_t* sq = static_cast<uint8_t*>(SqRing);
+      SqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+      SqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+      SqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+      SqEntries = params.sq_entries;
+      Sqes = static_cast<io_uring_sqe*>(SqesMapping);
+      uint8_t* cq = static_cast<uint8_t*>(CqRing);
+      CqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+      CqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+      CqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+      Cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+      // Kernels before 5.6 set up a ring, but fail IORING_OP_READ and IORING_OP_WRITE with
+      // EINVAL. The probe came with the same release, so a failing probe means no support.
+      constexpr unsigned c_probeOps = 256;
+      std::vector<uint64_t> probeBuffer(
+          (sizeof(io_uring_probe) + c_probeOps * sizeof(io_uring_probe_op)) / sizeof(uint64_t)
+          + 1);
+      auto probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+      if (syscall(__NR_io_uring_register, Fd, IORING_REGISTER_PROBE, probe, c_probeOps) < 0)
+      {
+        return false;
+      }
+      for (unsigned op : {unsigned(IORING_OP_READ), unsigned(IORING_OP_WRITE)})
+      {
+        if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    int Enter(unsigned toSubmit, unsigned minComplete, unsigned flags)
+    {
+      return static_cast<int>(
+          syscall(__NR_io_uring_enter, Fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    // Submits requests in batches of up to the ring size and waits for each batch. Stores the
+    // result of each request in BytesTransferred, negative values are errno codes. Requests the
+    // kernel didn't take are left at 0 for CompleteSynchronously. Returns false if submitting or
+    // waiting failed, the ring shouldn't be used anymore then. It never returns while the kernel
+    // still owns a buffer of the requests, nor leaves completions behind for the next call.
+    bool Run(std::vector<FileIoRequest>& requests)
     {
-      throw std::runtime_error("failed to write file");
+      // A single request transfers at most this much, CompleteSynchronously picks up the rest.
+      constexpr int64_t c_maxRequestLength = 1 << 30;
+
+      for (auto& request : requests)
+      {
+        request.BytesTransferred = 0;
+      }
+
+      std::size_t next = 0;
+      while (next < requests.size())
+      {
+        unsigned batch
+            = static_cast<unsigned>(std::min(requests.size() - next, std::size_t(SqEntries)));
+        // We are the only producer, so the tail doesn't need an atomic load.
+        unsigned tail = *SqTail;
+        for (unsigned i = 0; i < batch; ++i)
+        {
+          FileIoRequest& request = requests[next + i];
+          bool fixed = BuffersRegistered && request.BufferIndex >= 0;
+          unsigned index = (tail + i) & SqMask;
+          io_uring_sqe& sqe = Sqes[index];
+          std::memset(&sqe, 0, sizeof(sqe));
+          if (request.IsWrite)
+          {
+            sqe.opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+          }
+          else
+          {
+            sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+          }
+          sqe.fd = request.Handle;
+          sqe.addr = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(request.Buffer));
+          sqe.len = static_cast<uint32_t>(std::min(request.Length, c_maxRequestLength));
+          sqe.off = static_cast<uint64_t>(request.Offset);
+          if (fixed)
+          {
+            sqe.buf_index = static_cast<uint16_t>(request.BufferIndex);
+          }
+          sqe.user_data = next + i;
+          SqArray[index] = index;
+        }
+        __atomic_store_n(SqTail, tail + batch, __ATOMIC_RELEASE);
+
+        bool failed = false;
+        unsigned submitted = 0;
+        while (submitted < batch)
+        {
+          int ret = Enter(batch - submitted, 0, 0);
+          if (ret < 0)
+          {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+            {
+              continue;
+            }
+            // The entries the kernel didn't take stay in the ring, which is dropped with them.
+            failed = true;
+            break;
+          }
+          submitted += static_cast<unsigned>(ret);
+        }
+
+        // Every submitted request has to complete before its buffer can be given back.
+        unsigned completed = 0;
+        while (completed < submitted)
+        {
+          unsigned head = *CqHead;
+          unsigned cqTail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+          if (head == cqTail)
+          {
+            if (Enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+            {
+              // Completions are still posted to the ring, poll for them instead of blocking.
+              failed = true;
+              std::this_thread::yield();
+            }
+            continue;
+          }
+          for (; head != cqTail; ++head, ++completed)
+          {
+            const io_uring_cqe& cqe = Cqes[head & CqMask];
+            // An operation the kernel or file system doesn't support through io_uring is left
+            // to CompleteSynchronously.
+            requests[static_cast<std::size_t>(cqe.user_data)].BytesTransferred
+                = cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP ? 0 : cqe.res;
+          }
+          __atomic_store_n(CqHead, head, __ATOMIC_RELEASE);
+        }
+        if (failed)
+        {
+          return false;
+        }
+        next += batch;
+      }
+      return true;
     }
-    ssize_t bytesWritten
-        = pwrite(m_handle, buffer, static_cast<size_t>(length), static_cast<off_t>(offset));
-    if (bytesWritten != length)
+  };
+#else
+  struct FileIoEngine::IoUring
+  {
+  };
+#endif
+
+  FileIoEngine::FileIoEngine(unsigned queueDepth)
+  {
+#if defined(AZURE_STORAGE_IO_URING)
+    auto ring = std::make_unique<IoUring>();
+    if (ring->Setup(std::max(queueDepth, 1U)))
     {
-      throw std::runtime_error("failed to write file");
+      m_ring = std::move(ring);
     }
+#else
+    (void)queueDepth;
+#endif
   }
+
+  FileIoEngine::~FileIoEngine() {}
+
+  bool FileIoEngine::RegisterBuffers(const std::vector<std::pair<uint8_t*, int64_t>>& buffers)
+  {
+#if defined(AZURE_STORAGE_IO_URING)
+    if (!m_ring || m_ring->BuffersRegistered || buffers.empty())
+    {
+      return false;
+    }
+    std::vector<iovec> iovecs;
+    for (const auto& buffer : buffers)
+    {
+      iovec iov;
+      iov.iov_base = buffer.first;
+      iov.iov_len = static_cast<std::size_t>(buffer.second);
+      iovecs.emplace_back(iov);
+    }
+    // Fails with ENOMEM when the buffers exceed RLIMIT_MEMLOCK, plain requests still work then.
+    int ret = static_cast<int>(syscall(
+        __NR_io_uring_register,
+        m_ring->Fd,
+        IORING_REGISTER_BUFFERS,
+        iovecs.data(),
+        static_cast<unsigned>(iovecs.size())));
+    m_ring->BuffersRegistered = ret == 0;
+    return m_ring->BuffersRegistered;
+#else
+    (void)buffers;
+    return false;
 #endif
+  }
+
+  void FileIoEngine::Run(std::vector<FileIoRequest>& requests)
+  {
+#if defined(AZURE_STORAGE_IO_URING)
+    if (m_ring)
+    {
+      // Once the ring failed the rest of the requests, and all later ones, use pread/pwrite.
+      if (!m_ring->Run(requests))
+      {
+        m_ring.reset();
+      }
+    }
+    else
+#endif
+    {
+      for (auto& request : requests)
+      {
+        request.BytesTransferred = 0;
+      }
+    }
+
+    std::exception_ptr exception;
+    for (auto& request : requests)
+    {
+      try
+      {
+        if (request.BytesTransferred < 0)
+        {
+          throw std::runtime_error(
+              request.IsWrite ? "failed to write file" : "failed to read file");
+        }
+        CompleteSynchronously(request);
+      }
+      catch (...)
+      {
+        if (!exception)
+        {
+          exception = std::current_exception();
+        }
+      }
+    }
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  FileWriteStage::FileWriteStage(
+      FileWriter& fileWriter,
+      AlignedBufferPool* bufferPool,
+      bool dropCache)
+      : m_fileWriter(fileWriter), m_dropCache(dropCache)
+  {
+    if (bufferPool && m_engine.IsIoUring())
+    {
+      std::vector<std::pair<uint8_t*, int64_t>> buffers;
+      for (auto buffer : bufferPool->AllocateAll())
+      {
+        buffers.emplace_back(buffer, bufferPool->GetBufferSize());
+      }
+      m_buffersRegistered = m_engine.RegisterBuffers(buffers);
+    }
+  }
+
+  FileWriteStage::~FileWriteStage()
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+    {
+      m_thread.join();
+    }
+  }
+
+  void FileWriteStage::Write(AlignedBufferPool::Buffer buffer, int64_t length, int64_t offset)
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      if (m_exception)
+      {
+        std::rethrow_exception(m_exception);
+      }
+      m_queue.push_back(PendingWrite{std::move(buffer), length, offset});
+      ++m_numQueued;
+      if (!m_thread.joinable())
+      {
+        m_thread = std::thread(&FileWriteStage::WriterFunc, this);
+      }
+    }
+    m_cv.notify_all();
+  }
+
+  void FileWriteStage::WhenWritten(std::function<void()> written)
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      if (m_exception)
+      {
+        std::rethrow_exception(m_exception);
+      }
+      if (m_numWritten < m_numQueued)
+      {
+        m_writtenCallbacks.emplace_back(m_numQueued, std::move(written));
+        return;
+      }
+    }
+    written();
+  }
+
+  void FileWriteStage::Flush()
+  {
+    std::unique_lock<std::mutex> guard(m_mutex);
+    m_cv.wait(guard, [this]() { return m_queue.empty() && !m_writing; });
+    if (m_exception)
+    {
+      std::rethrow_exception(m_exception);
+    }
+  }
+
+  void FileWriteStage::WriterFunc()
+  {
+    constexpr std::size_t c_maxBatchSize = 64;
+
+    std::vector<PendingWrite> batch;
+    std::vector<FileIoRequest> requests;
+    std::vector<std::function<void()>> writtenCallbacks;
+    std::unique_lock<std::mutex> guard(m_mutex);
+    while (true)
+    {
+      m_cv.wait(guard, [this]() { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty())
+      {
+        // Stopped with nothing left to write.
+        break;
+      }
+      while (!m_queue.empty() && batch.size() < c_maxBatchSize)
+      {
+        batch.emplace_back(std::move(m_queue.front()));
+        m_queue.pop_front();
+      }
+      m_writing = true;
+      bool failed = m_exception != nullptr;
+      guard.unlock();
+
+      std::exception_ptr exception;
+      if (!failed)
+      {
+        requests.clear();
+        for (auto& pendingWrite : batch)
+        {
+          FileIoRequest request;
+          request.IsWrite = true;
+          request.Handle = m_fileWriter.GetHandle(
+              pendingWrite.Buffer.Data(), pendingWrite.Length, pendingWrite.Offset);
+          request.Buffer = pendingWrite.Buffer.Data();
+          request.Length = pendingWrite.Length;
+          request.Offset = pendingWrite.Offset;
+          if (m_buffersRegistered)
+          {
+            request.BufferIndex = static_cast<int>(pendingWrite.Buffer.Index());
+          }
+          requests.emplace_back(request);
+        }
+        try
+        {
+          m_engine.Run(requests);
+          if (m_dropCache)
+          {
+            for (const auto& request : requests)
+            {
+              m_fileWriter.DropCache(request.Offset, request.Length);
+            }
+          }
+        }
+        catch (...)
+        {
+          exception = std::current_exception();
+        }
+      }
+      std::size_t batchSize = batch.size();
+      // Hand the buffers back before waking anyone up waiting for them.
+      batch.clear();
+
+      guard.lock();
+      if (!failed && !exception)
+      {
+        m_numWritten += batchSize;
+        while (!m_writtenCallbacks.empty() && m_writtenCallbacks.front().first <= m_numWritten)
+        {
+          writtenCallbacks.emplace_back(std::move(m_writtenCallbacks.front().second));
+          m_writtenCallbacks.pop_front();
+        }
+      }
+      if (!writtenCallbacks.empty())
+      {
+        guard.unlock();
+        try
+        {
+          for (auto& written : writtenCallbacks)
+          {
+            written();
+          }
+        }
+        catch (...)
+        {
+          exception = std::current_exception();
+        }
+        writtenCallbacks.clear();
+        guard.lock();
+      }
+      m_writing = false;
+      if (exception && !m_exception)
+      {
+        m_exception = exception;
+      }
+      m_cv.notify_all();
+    }
+  }
 
 }}} // namespace Azure::Storage::Details
@@ -0,0 +1,176 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/hashing_body_stream.hpp"
+
+#include <stdexcept>
+
+namespace Azure { namespace Storage {
+
+  HashingBodyStream::HashingBodyStream(
+      Azure::Core::Http::BodyStream* inner,
+      bool md5,
+      bool crc64,
+      bool sha256)
+      : m_inner(inner), m_computeMd5(md5), m_computeCrc64(crc64), m_computeSha256(sha256)
+  {
+    Reset();
+  }
+
+  HashingBodyStream::HashingBodyStream(
+      std::unique_ptr<Azure::Core::Http::BodyStream> inner,
+      bool md5,
+      bool crc64,
+      bool sha256)
+      : HashingBodyStream(inner.get(), md5, crc64, sha256)
+  {
+    m_ownedInner = std::move(inner);
+  }
+
+  void HashingBodyStream::Rewind()
+  {
+    m_inner->Rewind();
+    Reset();
+  }
+
+  int64_t HashingBodyStream::Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count)
+  {
+    int64_t bytesRead = m_inner->Read(context, buffer, count);
+    Update(buffer, bytesRead);
+    if (bytesRead == 0 && count > 0)
+    {
+      Complete();
+    }
+    return bytesRead;
+  }
+
+  const uint8_t* HashingBodyStream::ReadContiguous(
+      Azure::Core::Context& context,
+      int64_t count,
+      int64_t* bytesRead)
+  {
+    const uint8_t* data = m_inner->ReadContiguous(context, count, bytesRead);
+    if (data != nullptr)
+    {
+      Update(data, *bytesRead);
+      if (*bytesRead == 0 && count > 0)
+      {
+        Complete();
+      }
+    }
+    return data;
+  }
+
+  const std::string& HashingBodyStream::GetMd5() const
+  {
+    if (!m_complete || !m_computeMd5)
+    {
+      throw std::runtime_error("MD5 of the stream isn't available");
+    }
+    return m_md5Digest;
+  }
+
+  const std::string& HashingBodyStream::GetCrc64() const
+  {
+    if (!m_complete || !m_computeCrc64)
+    {
+      throw std::runtime_error("CRC64 of the stream isn't available");
+    }
+    return m_crc64Digest;
+  }
+
+  const std::string& HashingBodyStream::GetSha256() const
+  {
+    if (!m_complete || !m_computeSha256)
+    {
+      throw std::runtime_error("SHA-256 of the stream isn't available");
+    }
+    return m_sha256Digest;
+  }
+
+  void HashingBodyStream::VerifyOnCompletion(
+      Azure::Core::Nullable<std::string> md5,
+      Azure::Core::Nullable<std::string> crc64)
+  {
+    m_expectedMd5 = std::move(md5);
+    m_expectedCrc64 = std::move(crc64);
+    if (m_complete)
+    {
+      Verify(m_expectedMd5, m_expectedCrc64);
+    }
+  }
+
+  void HashingBodyStream::Verify(
+      const Azure::Core::Nullable<std::string>& md5,
+      const Azure::Core::Nullable<std::string>& crc64) const
+  {
+    if (!m_complete)
+    {
+      throw std::runtime_error("the stream hasn't been read to the end");
+    }
+    if (m_computeMd5 && md5.HasValue() && Base64Decode(md5.GetValue()) != m_md5Digest)
+    {
+      throw std::runtime_error("MD5 of the content doesn't match");
+    }
+    if (m_computeCrc64 && crc64.HasValue() && Base64Decode(crc64.GetValue()) != m_crc64Digest)
+    {
+      throw std::runtime_error("CRC64 of the content doesn't match");
+    }
+  }
+
+  void HashingBodyStream::Reset()
+  {
+    m_md5 = m_computeMd5 ? std::make_unique<Md5>() : nullptr;
+    m_crc64 = Crc64();
+    m_sha256 = m_computeSha256 ? std::make_unique<Sha256>() : nullptr;
+    m_bytesRead = 0;
+    m_complete = false;
+    if (m_inner->Length() == 0)
+    {
+      // Transports don't read empty bodies at all.
+      Complete();
+    }
+  }
+
+  void HashingBodyStream::Update(const uint8_t* data, int64_t length)
+  {
+    if (length <= 0)
+    {
+      return;
+    }
+    if (m_md5)
+    {
+      m_md5->Update(data, static_cast<std::size_t>(length));
+    }
+    if (m_computeCrc64)
+    {
+      m_crc64.Update(data, static_cast<std::size_t>(length));
+    }
+    if (m_sha256)
+    {
+      m_sha256->Update(data, static_cast<std::size_t>(length));
+    }
+    m_bytesRead += length;
+
+    // Readers that stop at Length() never see the read that returns 0.
+    int64_t streamLength = m_inner->Length();
+    if (streamLength >= 0 && m_bytesRead >= streamLength)
+    {
+      Complete();
+    }
+  }
+
+  void HashingBodyStream::Complete()
+  {
+    if (m_complete)
+    {
+      return;
+    }
+    m_complete = true;
+    m_md5Digest = m_md5 ? m_md5->Digest() : std::string();
+    m_crc64Digest = m_computeCrc64 ? m_crc64.Digest() : std::string();
+    m_sha256Digest = m_sha256 ? m_sha256->Digest() : std::string();
+    Verify(m_expectedMd5, m_expectedCrc64);
+  }
+
+}} // namespace Azure::Storage
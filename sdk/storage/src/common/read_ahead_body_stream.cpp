@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/read_ahead_body_stream.hpp"
+
+#include "common/thread_pool.hpp"
+#include "common/transfer_governor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  struct ReadAheadBodyStream::State
+  {
+    struct Slot
+    {
+      int64_t ChunkId = -1;
+      bool Ready = false;
+      std::exception_ptr Exception;
+      std::unique_ptr<uint8_t[]> Data;
+    };
+
+    // Child of the stream's context, cancelled when the stream stops.
+    Azure::Core::Context Context;
+    FetchFunc Fetch;
+    GovernedTransfer Governor;
+
+    std::mutex Mutex;
+    std::condition_variable Cv;
+    // Chunk i is fetched into slot i % concurrency.
+    std::vector<Slot> Slots;
+    int NumInFlightFetches = 0;
+  };
+
+  ReadAheadBodyStream::ReadAheadBodyStream(
+      Azure::Core::Context context,
+      int64_t offset,
+      int64_t length,
+      int64_t chunkSize,
+      int concurrency,
+      FetchFunc fetchFunc)
+      : m_context(std::move(context)), m_offset(offset), m_length(length),
+        m_chunkSize(chunkSize), m_concurrency(std::max(concurrency, 1)),
+        m_fetchFunc(std::move(fetchFunc))
+  {
+    if (m_chunkSize <= 0)
+    {
+      throw std::runtime_error("chunk size must be positive");
+    }
+    Start();
+  }
+
+  ReadAheadBodyStream::~ReadAheadBodyStream() { Stop(); }
+
+  void ReadAheadBodyStream::Rewind()
+  {
+    Stop();
+    m_position = 0;
+    Start();
+  }
+
+  int64_t ReadAheadBodyStream::Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count)
+  {
+    if (count <= 0 || m_position >= m_length)
+    {
+      return 0;
+    }
+
+    int64_t chunkId = m_position / m_chunkSize;
+    auto& slot = m_state->Slots[static_cast<std::size_t>(chunkId % m_concurrency)];
+    {
+      std::unique_lock<std::mutex> guard(m_state->Mutex);
+      while (slot.ChunkId != chunkId || !slot.Ready)
+      {
+        if (context.CancelWhen() < std::chrono::system_clock::now())
+        {
+          throw std::runtime_error("the operation was cancelled");
+        }
+        m_state->Cv.wait_for(guard, std::chrono::milliseconds(100));
+      }
+      if (slot.Exception)
+      {
+        // The stream stays at this position, later reads fail the same way.
+        std::rethrow_exception(slot.Exception);
+      }
+    }
+
+    int64_t chunkOffset = chunkId * m_chunkSize;
+    int64_t chunkEnd = std::min(chunkOffset + m_chunkSize, m_length);
+    int64_t bytesRead = std::min(count, chunkEnd - m_position);
+    std::memcpy(
+        buffer, slot.Data.get() + (m_position - chunkOffset), static_cast<std::size_t>(bytesRead));
+    m_position += bytesRead;
+
+    if (m_position == chunkEnd)
+    {
+      // The slot is free again, have it fetch the next chunk it is responsible for.
+      int64_t nextChunkId = chunkId + m_concurrency;
+      if (nextChunkId * m_chunkSize < m_length)
+      {
+        Fetch(nextChunkId);
+      }
+    }
+    return bytesRead;
+  }
+
+  void ReadAheadBodyStream::Start()
+  {
+    m_state = std::make_shared<State>();
+    m_state->Context = m_context.WithDeadline(Azure::Core::Context::time_point::max());
+    m_state->Fetch = m_fetchFunc;
+    m_state->Slots.resize(static_cast<std::size_t>(m_concurrency));
+    for (int64_t chunkId = 0; chunkId < m_concurrency && chunkId * m_chunkSize < m_length;
+         ++chunkId)
+    {
+      Fetch(chunkId);
+    }
+  }
+
+  void ReadAheadBodyStream::Stop()
+  {
+    if (!m_state)
+    {
+      return;
+    }
+    m_state->Context.Cancel();
+    // fetchFunc may refer to objects the owner of the stream destroys after the stream.
+    std::unique_lock<std::mutex> guard(m_state->Mutex);
+    m_state->Cv.wait(guard, [this]() { return m_state->NumInFlightFetches == 0; });
+    guard.unlock();
+    m_state.reset();
+  }
+
+  void ReadAheadBodyStream::Fetch(int64_t chunkId)
+  {
+    int64_t chunkOffset = chunkId * m_chunkSize;
+    int64_t chunkLength = std::min(m_chunkSize, m_length - chunkOffset);
+    // The last chunk may be shorter, but every slot gets to hold a whole chunk eventually.
+    int64_t bufferSize = std::min(m_chunkSize, m_length);
+    std::size_t slotIndex = static_cast<std::size_t>(chunkId % m_concurrency);
+    {
+      std::lock_guard<std::mutex> guard(m_state->Mutex);
+      auto& slot = m_state->Slots[slotIndex];
+      slot.ChunkId = chunkId;
+      slot.Ready = false;
+      slot.Exception = nullptr;
+      ++m_state->NumInFlightFetches;
+    }
+
+    auto state = m_state;
+    int64_t offset = m_offset + chunkOffset;
+    WorkStealingThreadPool::GetDefault().Submit(
+        [state, slotIndex, offset, chunkLength, bufferSize]() {
+          // Only this task touches the slot's buffer until the slot is ready.
+          auto& slot = state->Slots[slotIndex];
+          std::exception_ptr exception;
+          try
+          {
+            Azure::Core::Context context = state->Context;
+            auto permit = state->Governor.Acquire(context, bufferSize);
+            if (!slot.Data)
+            {
+              slot.Data.reset(new uint8_t[static_cast<std::size_t>(bufferSize)]);
+            }
+            state->Fetch(context, offset, chunkLength, slot.Data.get());
+          }
+          catch (...)
+          {
+            exception = std::current_exception();
+          }
+          {
+            std::lock_guard<std::mutex> guard(state->Mutex);
+            slot.Ready = true;
+            slot.Exception = exception;
+            --state->NumInFlightFetches;
+          }
+          state->Cv.notify_all();
+        });
+  }
+
+}}} // namespace Azure::Storage::Details
@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/retriable_body_stream.hpp"
+
+#include "http/http.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  RetriableBodyStream::RetriableBodyStream(
+      std::unique_ptr<Azure::Core::Http::BodyStream> inner,
+      ReopenFunc reopenFunc,
+      int maxRetries,
+      std::chrono::milliseconds retryDelay,
+      std::chrono::milliseconds maxRetryDelay)
+      : m_inner(std::move(inner)), m_reopenFunc(std::move(reopenFunc)), m_maxRetries(maxRetries),
+        m_retryDelay(retryDelay), m_maxRetryDelay(maxRetryDelay), m_length(m_inner->Length())
+  {
+  }
+
+  void RetriableBodyStream::Rewind()
+  {
+    if (m_position != 0)
+    {
+      m_inner.reset();
+      m_position = 0;
+    }
+  }
+
+  int64_t RetriableBodyStream::Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count)
+  {
+    for (int attempt = 0;; ++attempt)
+    {
+      try
+      {
+        if (!m_inner)
+        {
+          m_inner = m_reopenFunc(context, m_position);
+        }
+        int64_t bytesRead = m_inner->Read(context, buffer, count);
+        if (bytesRead != 0 || count <= 0 || m_length < 0 || m_position >= m_length)
+        {
+          m_position += bytesRead;
+          return bytesRead;
+        }
+        if (attempt >= m_maxRetries)
+        {
+          throw std::runtime_error("connection closed before the whole body was received");
+        }
+      }
+      catch (Azure::Core::Http::TransportException&)
+      {
+        if (attempt >= m_maxRetries)
+        {
+          throw;
+        }
+      }
+      catch (Azure::Core::Http::CouldNotResolveHostException&)
+      {
+        if (attempt >= m_maxRetries)
+        {
+          throw;
+        }
+      }
+      // The connection is beyond repair, the next attempt starts with a new request.
+      m_inner.reset();
+      Backoff(context, attempt);
+    }
+  }
+
+  void RetriableBodyStream::Backoff(Azure::Core::Context& context, int attempt)
+  {
+    // Same shape as the pipeline's retry policy: doubling delays, scaled by [0.8, 1.3).
+    double jitterFactor = 0.8 + (static_cast<double>(std::rand()) / RAND_MAX) * 0.5;
+    double delay = static_cast<double>(m_retryDelay.count()) * jitterFactor
+        * static_cast<double>(int64_t(1) << std::min(attempt, 30));
+    delay = std::min(delay, static_cast<double>(m_maxRetryDelay.count()));
+    // Sleeps in slices, so that a cancelled download doesn't sit out the whole delay.
+    auto end = std::chrono::steady_clock::now()
+        + std::chrono::milliseconds(static_cast<int64_t>(delay));
+    while (true)
+    {
+      if (context.CancelWhen() < std::chrono::system_clock::now())
+      {
+        throw std::runtime_error("the operation was cancelled");
+      }
+      auto now = std::chrono::steady_clock::now();
+      if (now >= end)
+      {
+        break;
+      }
+      std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+          end - now, std::chrono::milliseconds(100)));
+    }
+  }
+
+}}} // namespace Azure::Storage::Details
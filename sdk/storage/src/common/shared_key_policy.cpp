@@ -4,86 +4,148 @@
 #include "common/shared_key_policy.hpp"
 
 #include "common/crypt.hpp"
-#include "common/storage_url_builder.hpp"
 
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <utility>
+#include <vector>
 
 namespace Azure { namespace Storage {
-  std::string SharedKeyPolicy::GetSignature(const Core::Http::Request& request) const
-  {
-    std::string string_to_sign;
-    string_to_sign += Azure::Core::Http::HttpMethodToString(request.GetMethod()) + "\n";
-
-    const auto& headers = request.GetHeaders();
-    for (std::string headerName :
-         {"Content-Encoding",
-          "Content-Language",
-          "Content-Length",
-          "Content-MD5",
-          "Content-Type",
-          "Date",
-          "If-Modified-Since",
-          "If-Match",
-          "If-None-Match",
-          "If-Unmodified-Since",
-          "Range"})
+
+  namespace {
+    // Request keeps header names in lower case.
+    const char* const c_standardHeaders[] = {
+        "content-encoding",
+        "content-language",
+        "content-length",
+        "content-md5",
+        "content-type",
+        "date",
+        "if-modified-since",
+        "if-match",
+        "if-none-match",
+        "if-unmodified-since",
+        "range",
+    };
+    constexpr std::size_t c_numStandardHeaders
+        = sizeof(c_standardHeaders) / sizeof(*c_standardHeaders);
+
+    char ToLower(char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); }
+
+    // A query parameter of the request being signed.
+    struct QueryParameter
     {
-      auto ite = headers.find(headerName);
-      if (ite != headers.end())
+      const char* Key;
+      std::size_t KeyLength;
+      const char* Value;
+      std::size_t ValueLength;
+    };
+
+    bool operator<(const QueryParameter& lhs, const QueryParameter& rhs)
+    {
+      std::size_t length = std::min(lhs.KeyLength, rhs.KeyLength);
+      for (std::size_t i = 0; i < length; ++i)
       {
-        if (headerName == "Content-Length" && ite->second == "0")
+        char l = ToLower(lhs.Key[i]);
+        char r = ToLower(rhs.Key[i]);
+        if (l != r)
         {
-          // do nothing
-        }
-        else
-        {
-          string_to_sign += ite->second;
+          return l < r;
         }
       }
-      string_to_sign += "\n";
+      if (lhs.KeyLength != rhs.KeyLength)
+      {
+        return lhs.KeyLength < rhs.KeyLength;
+      }
+      return std::lexicographical_compare(
+          lhs.Value, lhs.Value + lhs.ValueLength, rhs.Value, rhs.Value + rhs.ValueLength);
     }
+  } // namespace
+
+  std::string SharedKeyPolicy::GetSignature(const Core::Http::Request& request) const
+  {
+    // Reused by every request signed on the same thread, so signing stops allocating once they're
+    // large enough.
+    thread_local std::string stringToSign;
+    thread_local std::vector<QueryParameter> queryParameters;
+    thread_local std::vector<std::pair<const std::string*, const std::string*>>
+        canonicalizedHeaders;
+    stringToSign.clear();
+    queryParameters.clear();
+    canonicalizedHeaders.clear();
+
+    stringToSign += Azure::Core::Http::HttpMethodToString(request.GetMethod());
+    stringToSign += '\n';
 
-    // canonicalized headers
-    const std::string prefix = "x-ms-";
-    std::vector<std::pair<std::string, std::string>> ordered_kv;
-    for (auto ite = headers.lower_bound(prefix);
-         ite != headers.end() && ite->first.substr(0, prefix.length()) == prefix;
-         ++ite)
+    // The request is read in place, copies of its headers and URL would cost more than signing.
+    const std::string* standardHeaderValues[c_numStandardHeaders] = {};
+    request.ForEachHeader(
+        [&standardHeaderValues](const std::string& name, const std::string& value) {
+          for (std::size_t i = 0; i < c_numStandardHeaders; ++i)
+          {
+            if (name == c_standardHeaders[i])
+            {
+              standardHeaderValues[i] = &value;
+              return;
+            }
+          }
+          if (name.compare(0, 5, "x-ms-") == 0)
+          {
+            canonicalizedHeaders.emplace_back(&name, &value);
+          }
+        });
+    for (std::size_t i = 0; i < c_numStandardHeaders; ++i)
     {
-      std::string key = ite->first;
-      std::transform(key.begin(), key.end(), key.begin(), [](char c) {
-        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-      });
-      ordered_kv.emplace_back(std::make_pair(std::move(key), ite->second));
+      const std::string* value = standardHeaderValues[i];
+      if (value
+          && !(std::strcmp(c_standardHeaders[i], "content-length") == 0 && *value == "0"))
+      {
+        stringToSign += *value;
+      }
+      stringToSign += '\n';
     }
-    std::sort(ordered_kv.begin(), ordered_kv.end());
-    for (const auto& p : ordered_kv)
+
+    // canonicalized headers, visited in the order of their lower case names
+    for (const auto& header : canonicalizedHeaders)
     {
-      string_to_sign += p.first + ":" + p.second + "\n";
+      stringToSign += *header.first;
+      stringToSign += ':';
+      stringToSign += *header.second;
+      stringToSign += '\n';
     }
-    ordered_kv.clear();
 
-    // canonicalized resource
-    UrlBuilder resourceUrl(request.GetEncodedUrl());
-    string_to_sign += "/" + m_credential->AccountName + "/" + resourceUrl.GetPath() + "\n";
-    for (const auto& query : resourceUrl.GetQuery())
+    // canonicalized resource, the path comes with a leading slash unless it's empty
+    const std::string& path = request.GetPath();
+    stringToSign += '/';
+    stringToSign += m_credential->AccountName;
+    stringToSign += '/';
+    if (!path.empty())
     {
-      std::string key = query.first;
-      std::transform(key.begin(), key.end(), key.begin(), [](char c) {
-        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-      });
-      ordered_kv.emplace_back(std::make_pair(std::move(key), query.second));
+      stringToSign.append(path, 1, std::string::npos);
     }
-    std::sort(ordered_kv.begin(), ordered_kv.end());
-    for (const auto& p : ordered_kv)
+    stringToSign += '\n';
+
+    request.ForEachQueryParameter([](const std::string& key, const std::string& value) {
+      queryParameters.push_back(
+          QueryParameter{key.data(), key.length(), value.data(), value.length()});
+    });
+    std::sort(queryParameters.begin(), queryParameters.end());
+    for (const auto& parameter : queryParameters)
     {
-      string_to_sign += p.first + ":" + p.second + "\n";
+      std::transform(
+          parameter.Key,
+          parameter.Key + parameter.KeyLength,
+          std::back_inserter(stringToSign),
+          ToLower);
+      stringToSign += ':';
+      stringToSign.append(parameter.Value, parameter.ValueLength);
+      stringToSign += '\n';
     }
 
     // remove last linebreak
-    string_to_sign.pop_back();
+    stringToSign.pop_back();
 
-    return Base64Encode(HMAC_SHA256(string_to_sign, Base64Decode(m_credential->GetAccountKey())));
+    return Base64Encode(m_credential->GetSigningKey()->Sign(stringToSign));
   }
 }} // namespace Azure::Storage
@@ -3,8 +3,24 @@
 
 #include "common/storage_credential.hpp"
 
+#include "common/crypt.hpp"
+
 #include <algorithm>
 
+namespace Azure { namespace Storage {
+
+  std::shared_ptr<const HmacSha256> SharedKeyCredential::GetSigningKey()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!m_signingKey)
+    {
+      m_signingKey = std::make_shared<const HmacSha256>(Base64Decode(m_accountKey));
+    }
+    return m_signingKey;
+  }
+
+}} // namespace Azure::Storage
+
 namespace Azure { namespace Storage { namespace Details {
 
   ConnectionStringParts ParseConnectionString(const std::string& connectionString)
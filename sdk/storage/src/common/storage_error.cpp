@@ -42,8 +42,8 @@ namespace Azure { namespace Storage {
     {
       if (response->GetHeaders().at("Content-Type").find("xml") != std::string::npos)
       {
-        auto xmlReader
-            = XmlReader(reinterpret_cast<const char*>(bodyBuffer.data()), bodyBuffer.size());
+        XmlReader xmlReader(
+            reinterpret_cast<const char*>(bodyBuffer.data()), bodyBuffer.size());
 
         enum class XmlTagName
         {
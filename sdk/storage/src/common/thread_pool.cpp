@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  namespace {
+    // Identifies the pool and queue owned by the current thread, if it is a pool worker.
+    thread_local const WorkStealingThreadPool* t_currentPool = nullptr;
+    thread_local std::size_t t_currentQueue = 0;
+  } // namespace
+
+  WorkStealingThreadPool::WorkStealingThreadPool(std::size_t maxThreads)
+  {
+    maxThreads = std::max(maxThreads, std::size_t(1));
+    m_queues.reserve(maxThreads);
+    for (std::size_t i = 0; i < maxThreads; ++i)
+    {
+      m_queues.emplace_back(std::make_unique<WorkQueue>());
+    }
+  }
+
+  WorkStealingThreadPool::~WorkStealingThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& thread : m_threads)
+    {
+      thread.join();
+    }
+  }
+
+  WorkStealingThreadPool& WorkStealingThreadPool::GetDefault()
+  {
+    // Transfer tasks spend most of their time waiting on the network, so the pool is allowed to
+    // grow well beyond the number of cores.
+    static WorkStealingThreadPool defaultPool(
+        std::max(std::size_t(64), std::size_t(std::thread::hardware_concurrency()) * 8));
+    return defaultPool;
+  }
+
+  std::size_t WorkStealingThreadPool::GetThreadCount()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_threads.size();
+  }
+
+  void WorkStealingThreadPool::Submit(std::function<void()> task)
+  {
+    std::unique_lock<std::mutex> guard(m_mutex);
+    std::size_t queueIndex;
+    if (t_currentPool == this)
+    {
+      queueIndex = t_currentQueue;
+    }
+    else
+    {
+      queueIndex = m_nextQueue++ % std::max(m_threads.size(), std::size_t(1));
+    }
+    {
+      std::lock_guard<std::mutex> queueGuard(m_queues[queueIndex]->Mutex);
+      m_queues[queueIndex]->Tasks.emplace_back(std::move(task));
+    }
+    ++m_numPendingTasks;
+    if (m_numPendingTasks > m_numIdleThreads && m_threads.size() < m_queues.size())
+    {
+      std::size_t newIndex = m_threads.size();
+      m_threads.emplace_back(&WorkStealingThreadPool::WorkerFunc, this, newIndex);
+    }
+    guard.unlock();
+    m_cv.notify_one();
+  }
+
+  bool WorkStealingThreadPool::TryPop(std::size_t index, std::function<void()>& task)
+  {
+    {
+      auto& ownQueue = *m_queues[index];
+      std::lock_guard<std::mutex> guard(ownQueue.Mutex);
+      if (!ownQueue.Tasks.empty())
+      {
+        task = std::move(ownQueue.Tasks.back());
+        ownQueue.Tasks.pop_back();
+        return true;
+      }
+    }
+    for (std::size_t i = 1; i < m_queues.size(); ++i)
+    {
+      auto& victimQueue = *m_queues[(index + i) % m_queues.size()];
+      std::lock_guard<std::mutex> guard(victimQueue.Mutex);
+      if (!victimQueue.Tasks.empty())
+      {
+        task = std::move(victimQueue.Tasks.front());
+        victimQueue.Tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void WorkStealingThreadPool::WorkerFunc(std::size_t index)
+  {
+    t_currentPool = this;
+    t_currentQueue = index;
+
+    while (true)
+    {
+      std::function<void()> task;
+      if (TryPop(index, task))
+      {
+        {
+          std::lock_guard<std::mutex> guard(m_mutex);
+          --m_numPendingTasks;
+        }
+        task();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> guard(m_mutex);
+      if (m_stop)
+      {
+        break;
+      }
+      if (m_numPendingTasks == 0)
+      {
+        ++m_numIdleThreads;
+        m_cv.wait(guard, [this]() { return m_stop || m_numPendingTasks != 0; });
+        --m_numIdleThreads;
+      }
+    }
+  }
+
+}}} // namespace Azure::Storage::Details
@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/transfer_auto_tuner.hpp"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  namespace {
+    constexpr int c_initialConcurrency = 2;
+    // A window has to be this much faster than the best one to count as an improvement.
+    constexpr double c_minImprovement = 0.1;
+    // Latency per byte this many times the baseline means requests queue up somewhere.
+    constexpr double c_latencyInflationFactor = 3.0;
+
+    struct TunedValues
+    {
+      int64_t ChunkSize;
+      int Concurrency;
+    };
+
+    std::mutex g_tunedValuesMutex;
+    std::map<std::string, TunedValues> g_tunedValues;
+  } // namespace
+
+  TransferAutoTuner::TransferAutoTuner(
+      std::string endpoint,
+      int64_t initialChunkSize,
+      int64_t maxChunkSize,
+      int maxConcurrency)
+      : m_endpoint(std::move(endpoint)), m_maxChunkSize(std::max(maxChunkSize, int64_t(1))),
+        m_maxConcurrency(std::max(maxConcurrency, 1))
+  {
+    m_chunkSize = initialChunkSize;
+    m_concurrency = c_initialConcurrency;
+    {
+      std::lock_guard<std::mutex> guard(g_tunedValuesMutex);
+      auto ite = g_tunedValues.find(m_endpoint);
+      if (ite != g_tunedValues.end())
+      {
+        m_chunkSize = ite->second.ChunkSize;
+        m_concurrency = ite->second.Concurrency;
+      }
+    }
+    m_chunkSize = std::min(std::max(m_chunkSize, int64_t(1)), m_maxChunkSize);
+    m_concurrency = std::min(std::max(m_concurrency, 1), m_maxConcurrency);
+    m_bestChunkSize = m_chunkSize;
+    m_bestConcurrency = m_concurrency;
+  }
+
+  TransferAutoTuner::~TransferAutoTuner()
+  {
+    if (!m_tuned)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> guard(g_tunedValuesMutex);
+    g_tunedValues[m_endpoint] = TunedValues{m_bestChunkSize, m_bestConcurrency};
+  }
+
+  int64_t TransferAutoTuner::GetChunkSize()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_chunkSize;
+  }
+
+  int TransferAutoTuner::GetConcurrency()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_concurrency;
+  }
+
+  void TransferAutoTuner::OnChunkCompleted(
+      int64_t bytes,
+      std::chrono::steady_clock::duration latency,
+      std::chrono::steady_clock::time_point now)
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!m_windowStarted)
+    {
+      m_windowStarted = true;
+      m_windowStart = now - latency;
+    }
+    m_windowBytes += bytes;
+    m_windowChunks += 1;
+    m_windowLatency += std::chrono::duration<double>(latency).count();
+
+    // Chunks started with the previous configuration still complete in the early part of a
+    // window, a window spanning a couple of rounds of requests dilutes them.
+    if (m_windowChunks >= std::max(int64_t(m_concurrency) * 2, int64_t(4)))
+    {
+      CloseWindow(now);
+    }
+  }
+
+  void TransferAutoTuner::OnThrottled()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    // Requests sent before the last back off are throttled along with the one that caused it,
+    // back off again only once a chunk completed with the reduced concurrency.
+    if (m_recovering && !m_windowStarted)
+    {
+      return;
+    }
+    BackOff();
+  }
+
+  void TransferAutoTuner::CloseWindow(std::chrono::steady_clock::time_point now)
+  {
+    double seconds = std::chrono::duration<double>(now - m_windowStart).count();
+    double throughput = static_cast<double>(m_windowBytes) / std::max(seconds, 1e-9);
+    double latencyPerByte
+        = m_windowLatency / static_cast<double>(std::max(m_windowBytes, int64_t(1)));
+    bool improved = throughput > m_bestThroughput * (1.0 + c_minImprovement);
+    bool inflated = m_baselineLatency > 0.0
+        && latencyPerByte > m_baselineLatency * c_latencyInflationFactor;
+
+    if (!improved && inflated)
+    {
+      BackOff();
+      return;
+    }
+
+    m_tuned = true;
+    if (m_baselineLatency == 0.0 || latencyPerByte < m_baselineLatency)
+    {
+      m_baselineLatency = latencyPerByte;
+    }
+    if (m_recovering)
+    {
+      // After backing off, every clean window adds one parallel request until the tuner is back
+      // at the concurrency it backed off from, and ramping picks up from there.
+      if (throughput > m_bestThroughput)
+      {
+        m_bestThroughput = throughput;
+        m_bestChunkSize = m_chunkSize;
+        m_bestConcurrency = m_concurrency;
+      }
+      int recoveryConcurrency = std::min(m_recoveryConcurrency, m_maxConcurrency);
+      m_concurrency = std::min(m_concurrency + 1, recoveryConcurrency);
+      if (m_concurrency >= recoveryConcurrency)
+      {
+        m_recovering = false;
+        m_ramping = true;
+      }
+    }
+    else if (improved)
+    {
+      m_bestThroughput = throughput;
+      m_bestChunkSize = m_chunkSize;
+      m_bestConcurrency = m_concurrency;
+    }
+    else
+    {
+      // The last step didn't pay off, go back to the best configuration seen and stop growing
+      // in that direction.
+      m_chunkSize = m_bestChunkSize;
+      m_concurrency = m_bestConcurrency;
+      if (m_lastGrewChunkSize)
+      {
+        m_chunkSizeSettled = true;
+      }
+      else
+      {
+        m_concurrencySettled = true;
+      }
+    }
+    if (m_ramping)
+    {
+      Grow();
+    }
+
+    m_windowStarted = false;
+    m_windowBytes = 0;
+    m_windowChunks = 0;
+    m_windowLatency = 0.0;
+  }
+
+  void TransferAutoTuner::Grow()
+  {
+    bool canGrowChunkSize = !m_chunkSizeSettled && m_chunkSize < m_maxChunkSize;
+    bool canGrowConcurrency = !m_concurrencySettled && m_concurrency < m_maxConcurrency;
+    if (canGrowChunkSize && (m_lastGrewConcurrency || !canGrowConcurrency))
+    {
+      m_chunkSize = std::min(m_chunkSize * 2, m_maxChunkSize);
+      m_lastGrewChunkSize = true;
+      m_lastGrewConcurrency = false;
+    }
+    else if (canGrowConcurrency)
+    {
+      m_concurrency = std::min(m_concurrency * 2, m_maxConcurrency);
+      m_lastGrewChunkSize = false;
+      m_lastGrewConcurrency = true;
+    }
+    else
+    {
+      m_ramping = false;
+    }
+  }
+
+  void TransferAutoTuner::BackOff()
+  {
+    m_recoveryConcurrency = m_concurrency;
+    m_recovering = true;
+    m_ramping = false;
+    m_concurrency = std::max(m_concurrency / 2, 1);
+    m_chunkSize = std::min(m_chunkSize, m_bestChunkSize);
+    m_bestChunkSize = m_chunkSize;
+    m_bestConcurrency = m_concurrency;
+    // Throughput measured before backing off is no reference anymore, and the configuration
+    // backed off to isn't remembered for the endpoint until a window measured it.
+    m_bestThroughput = 0.0;
+    m_tuned = false;
+
+    m_windowStarted = false;
+    m_windowBytes = 0;
+    m_windowChunks = 0;
+    m_windowLatency = 0.0;
+  }
+
+}}} // namespace Azure::Storage::Details
@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/transfer_governor.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace Azure { namespace Storage {
+
+  TransferGovernor& TransferGovernor::GetDefault()
+  {
+    static TransferGovernor defaultGovernor;
+    return defaultGovernor;
+  }
+
+  void TransferGovernor::SetMaximumInFlightChunks(int64_t maxInFlightChunks)
+  {
+    if (maxInFlightChunks <= 0)
+    {
+      throw std::invalid_argument("maximum in-flight chunks must be positive");
+    }
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_maxInFlightChunks = maxInFlightChunks;
+    AdmitWaiters();
+  }
+
+  void TransferGovernor::SetMaximumBufferBytes(int64_t maxBufferBytes)
+  {
+    if (maxBufferBytes <= 0)
+    {
+      throw std::invalid_argument("maximum buffer bytes must be positive");
+    }
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_maxBufferBytes = maxBufferBytes;
+    AdmitWaiters();
+  }
+
+  int64_t TransferGovernor::GetMaximumInFlightChunks()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_maxInFlightChunks;
+  }
+
+  int64_t TransferGovernor::GetMaximumBufferBytes()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_maxBufferBytes;
+  }
+
+  TransferGovernorUsage TransferGovernor::GetUsage()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    TransferGovernorUsage usage;
+    usage.ActiveTransfers = static_cast<int64_t>(m_transfers.size());
+    usage.InFlightChunks = m_inFlightChunks;
+    usage.BufferBytes = m_bufferBytes;
+    usage.QueuedChunks = static_cast<int64_t>(m_waiters.size());
+    return usage;
+  }
+
+  uint64_t TransferGovernor::RegisterTransfer()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    uint64_t transferId = m_nextTransferId++;
+    m_transfers[transferId] = 0;
+    return transferId;
+  }
+
+  void TransferGovernor::UnregisterTransfer(uint64_t transferId)
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_transfers.erase(transferId);
+  }
+
+  void TransferGovernor::Acquire(
+      Azure::Core::Context& context,
+      uint64_t transferId,
+      int64_t bufferBytes)
+  {
+    std::unique_lock<std::mutex> guard(m_mutex);
+    Waiter waiter;
+    waiter.TransferId = transferId;
+    waiter.BufferBytes = bufferBytes;
+    auto ite = m_waiters.insert(m_waiters.end(), &waiter);
+    AdmitWaiters();
+    while (!waiter.Admitted)
+    {
+      m_cv.wait_for(guard, std::chrono::milliseconds(100));
+      if (!waiter.Admitted && context.CancelWhen() < std::chrono::system_clock::now())
+      {
+        m_waiters.erase(ite);
+        // The head of the queue may have changed.
+        AdmitWaiters();
+        throw std::runtime_error("the operation was cancelled");
+      }
+    }
+  }
+
+  void TransferGovernor::Release(uint64_t transferId, int64_t bufferBytes)
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    --m_inFlightChunks;
+    m_bufferBytes -= bufferBytes;
+    auto ite = m_transfers.find(transferId);
+    if (ite != m_transfers.end())
+    {
+      --ite->second;
+    }
+    AdmitWaiters();
+  }
+
+  void TransferGovernor::AdmitWaiters()
+  {
+    bool admittedAny = false;
+    while (!m_waiters.empty())
+    {
+      // Pick the waiter whose transfer has the fewest chunks in flight, the earliest one on ties.
+      auto next = m_waiters.begin();
+      int64_t nextInFlight = m_transfers[(*next)->TransferId];
+      for (auto ite = std::next(m_waiters.begin()); ite != m_waiters.end(); ++ite)
+      {
+        int64_t inFlight = m_transfers[(*ite)->TransferId];
+        if (inFlight < nextInFlight)
+        {
+          next = ite;
+          nextInFlight = inFlight;
+        }
+      }
+
+      // Stop at the first waiter that doesn't fit so that large chunks are not starved by small
+      // ones.
+      Waiter& waiter = **next;
+      if (m_inFlightChunks >= m_maxInFlightChunks
+          || (m_inFlightChunks != 0 && m_bufferBytes + waiter.BufferBytes > m_maxBufferBytes))
+      {
+        break;
+      }
+      ++m_inFlightChunks;
+      m_bufferBytes += waiter.BufferBytes;
+      ++m_transfers[waiter.TransferId];
+      waiter.Admitted = true;
+      m_waiters.erase(next);
+      admittedAny = true;
+    }
+    if (admittedAny)
+    {
+      m_cv.notify_all();
+    }
+  }
+
+}} // namespace Azure::Storage
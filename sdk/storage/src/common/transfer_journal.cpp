@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/transfer_journal.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+namespace Azure { namespace Storage { namespace Details {
+
+  namespace {
+    constexpr const char* c_journalSignature = "azure-storage-transfer-journal 1";
+  } // namespace
+
+  TransferJournal::TransferJournal(std::string path, const std::string& guard)
+      : m_path(std::move(path)), m_guard(guard)
+  {
+    if (m_guard.find_first_of("\r\n") != std::string::npos)
+    {
+      throw std::runtime_error("transfer journal guard must fit on one line");
+    }
+
+    std::ifstream existing(m_path, std::ios::binary);
+    std::string line;
+    if (existing && std::getline(existing, line) && line == c_journalSignature
+        && std::getline(existing, line) && line == m_guard)
+    {
+      // A line that isn't followed by a newline was cut off while it was written.
+      while (std::getline(existing, line) && !existing.eof())
+      {
+        try
+        {
+          std::size_t parsedLength = 0;
+          int64_t chunkId = std::stoll(line, &parsedLength);
+          if (parsedLength == line.length() && chunkId >= 0)
+          {
+            m_completedChunks.insert(chunkId);
+          }
+        }
+        catch (std::logic_error&)
+        {
+        }
+      }
+    }
+    existing.close();
+
+    // Drops records of other transfers and cut off lines, appending after those would garble the
+    // next record.
+    Rewrite();
+  }
+
+  void TransferJournal::SetCompletedChunks(std::set<int64_t> completedChunks)
+  {
+    m_completedChunks = std::move(completedChunks);
+    Rewrite();
+  }
+
+  void TransferJournal::MarkCompleted(int64_t chunkId)
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_stream << chunkId << '\n';
+    m_stream.flush();
+    if (!m_stream)
+    {
+      throw std::runtime_error("failed to write transfer journal");
+    }
+  }
+
+  void TransferJournal::Remove()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_stream.close();
+    std::remove(m_path.data());
+  }
+
+  void TransferJournal::Rewrite()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_stream.is_open())
+    {
+      m_stream.close();
+    }
+    m_stream.clear();
+    m_stream.open(m_path, std::ios::binary | std::ios::trunc);
+    m_stream << c_journalSignature << '\n' << m_guard << '\n';
+    for (int64_t chunkId : m_completedChunks)
+    {
+      m_stream << chunkId << '\n';
+    }
+    m_stream.flush();
+    if (!m_stream)
+    {
+      throw std::runtime_error("failed to write transfer journal");
+    }
+  }
+
+}}} // namespace Azure::Storage::Details
@@ -6,6 +6,8 @@
 #include "libxml/xmlreader.h"
 #include "libxml/xmlwriter.h"
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 
@@ -19,6 +21,55 @@ namespace Azure { namespace Storage {
 
   static void XmlGlobalInitialize() { static XmlGlobalInitializer globalInitializer; }
 
+  namespace {
+    // The same characters are escaped in text as by xmlTextWriter.
+    const char* XmlTextEscape(char c)
+    {
+      switch (c)
+      {
+        case '&':
+          return "&amp;";
+        case '<':
+          return "&lt;";
+        case '>':
+          return "&gt;";
+        case '\r':
+          return "&#13;";
+        default:
+          return nullptr;
+      }
+    }
+
+    std::size_t XmlTextLength(const char* text)
+    {
+      std::size_t length = 0;
+      for (; *text != '\0'; ++text)
+      {
+        const char* escape = XmlTextEscape(*text);
+        length += escape ? std::strlen(escape) : 1;
+      }
+      return length;
+    }
+
+    void AppendXmlText(std::string& document, const char* text)
+    {
+      for (; *text != '\0'; ++text)
+      {
+        const char* escape = XmlTextEscape(*text);
+        if (escape)
+        {
+          document += escape;
+        }
+        else
+        {
+          document += *text;
+        }
+      }
+    }
+
+    constexpr char c_xmlDeclaration[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+  } // namespace
+
   XmlReader::XmlReader(const char* data, std::size_t length)
   {
     XmlGlobalInitialize();
@@ -35,8 +86,44 @@ namespace Azure { namespace Storage {
     }
   }
 
+  XmlReader::XmlReader(Azure::Core::Context context, Azure::Core::Http::BodyStream& stream)
+      : m_input(new StreamInput{std::move(context), &stream, nullptr})
+  {
+    XmlGlobalInitialize();
+
+    // libxml calls back from C, exceptions are kept until control is back in Read.
+    auto readCallback = [](void* inputContext, char* buffer, int length) {
+      auto input = static_cast<StreamInput*>(inputContext);
+      try
+      {
+        return static_cast<int>(input->Stream->Read(
+            input->Context, reinterpret_cast<uint8_t*>(buffer), static_cast<int64_t>(length)));
+      }
+      catch (...)
+      {
+        input->Exception = std::current_exception();
+        return -1;
+      }
+    };
+    auto closeCallback = [](void*) { return 0; };
+    m_reader = xmlReaderForIO(readCallback, closeCallback, m_input.get(), nullptr, nullptr, 0);
+    if (!m_reader)
+    {
+      ThrowParseError();
+    }
+  }
+
   XmlReader::~XmlReader() { xmlFreeTextReader(m_reader); }
 
+  void XmlReader::ThrowParseError()
+  {
+    if (m_input && m_input->Exception)
+    {
+      std::rethrow_exception(m_input->Exception);
+    }
+    throw std::runtime_error("failed to parse xml");
+  }
+
   XmlNode XmlReader::Read()
   {
     if (m_readingAttributes)
@@ -44,8 +131,8 @@ namespace Azure { namespace Storage {
       int ret = xmlTextReaderMoveToNextAttribute(m_reader);
       if (ret == 1)
       {
-        const char* name = reinterpret_cast<const char*>(xmlTextReaderName(m_reader));
-        const char* value = reinterpret_cast<const char*>(xmlTextReaderValue(m_reader));
+        const char* name = reinterpret_cast<const char*>(xmlTextReaderConstName(m_reader));
+        const char* value = reinterpret_cast<const char*>(xmlTextReaderConstValue(m_reader));
         return XmlNode{XmlNodeType::Attribute, name, value};
       }
       else if (ret == 0)
@@ -54,7 +141,7 @@ namespace Azure { namespace Storage {
       }
       else
       {
-        throw std::runtime_error("failed to parse xml");
+        ThrowParseError();
       }
     }
 
@@ -65,7 +152,7 @@ namespace Azure { namespace Storage {
     }
     if (ret != 1)
     {
-      throw std::runtime_error("failed to parse xml");
+      ThrowParseError();
     }
 
     int type = xmlTextReaderNodeType(m_reader);
@@ -73,8 +160,10 @@ namespace Azure { namespace Storage {
     bool has_value = xmlTextReaderHasValue(m_reader) == 1;
     bool has_attributes = xmlTextReaderHasAttributes(m_reader) == 1;
 
-    const char* name = reinterpret_cast<const char*>(xmlTextReaderName(m_reader));
-    const char* value = reinterpret_cast<const char*>(xmlTextReaderValue(m_reader));
+    // Both belong to the reader, names are interned in its dictionary and values live in the
+    // node being read, so nothing is copied or has to be freed.
+    const char* name = reinterpret_cast<const char*>(xmlTextReaderConstName(m_reader));
+    const char* value = reinterpret_cast<const char*>(xmlTextReaderConstValue(m_reader));
 
     if (has_attributes)
     {
@@ -174,4 +263,78 @@ namespace Azure { namespace Storage {
     return std::string(reinterpret_cast<const char*>(m_buffer->content), m_buffer->use);
   }
 
+  XmlListBodyStream::XmlListBodyStream(
+      std::string rootName,
+      std::size_t numElements,
+      std::function<XmlNode(std::size_t index)> element)
+      : m_rootName(std::move(rootName)), m_numElements(numElements), m_element(std::move(element))
+  {
+    // <?xml ...?><Root>, </Root>, and <Name>Text</Name> for every element.
+    std::size_t length = std::strlen(c_xmlDeclaration) + 2 * m_rootName.length() + 5;
+    for (std::size_t i = 0; i < m_numElements; ++i)
+    {
+      XmlNode node = m_element(i);
+      length += 2 * std::strlen(node.Name) + 5 + XmlTextLength(node.Value);
+    }
+    m_length = static_cast<int64_t>(length);
+  }
+
+  void XmlListBodyStream::Rewind()
+  {
+    m_nextPiece = 0;
+    m_piece.clear();
+    m_pieceOffset = 0;
+  }
+
+  bool XmlListBodyStream::NextPiece()
+  {
+    m_piece.clear();
+    m_pieceOffset = 0;
+    if (m_nextPiece == 0)
+    {
+      m_piece = c_xmlDeclaration;
+      m_piece += "<" + m_rootName + ">";
+    }
+    else if (m_nextPiece <= m_numElements)
+    {
+      XmlNode node = m_element(m_nextPiece - 1);
+      m_piece += '<';
+      m_piece += node.Name;
+      m_piece += '>';
+      AppendXmlText(m_piece, node.Value);
+      m_piece += "</";
+      m_piece += node.Name;
+      m_piece += '>';
+    }
+    else if (m_nextPiece == m_numElements + 1)
+    {
+      m_piece = "</" + m_rootName + ">";
+    }
+    else
+    {
+      return false;
+    }
+    ++m_nextPiece;
+    return true;
+  }
+
+  int64_t XmlListBodyStream::Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count)
+  {
+    context.ThrowIfCanceled();
+    int64_t bytesRead = 0;
+    while (bytesRead < count)
+    {
+      if (m_pieceOffset == m_piece.length() && !NextPiece())
+      {
+        break;
+      }
+      std::size_t length = static_cast<std::size_t>(std::min(
+          count - bytesRead, static_cast<int64_t>(m_piece.length() - m_pieceOffset)));
+      std::memcpy(buffer + bytesRead, m_piece.data() + m_pieceOffset, length);
+      m_pieceOffset += length;
+      bytesRead += static_cast<int64_t>(length);
+    }
+    return bytesRead;
+  }
+
 }} // namespace Azure::Storage
@@ -185,4 +185,33 @@ namespace Azure { namespace Storage { namespace DataLake {
         m_dfsUri.ToString(), *m_pipeline, options.Context, protocolLayerOptions);
   }
 
+  PagedRange<Path> FileSystemClient::ListAllPaths(
+      bool recursive,
+      const ListPathsOptions& options) const
+  {
+    FileSystemClient fileSystemClient = *this;
+    ListPathsOptions segmentOptions;
+    segmentOptions.UserPrincipalName = options.UserPrincipalName;
+    segmentOptions.MaxResults = options.MaxResults;
+    segmentOptions.Directory = options.Directory;
+    segmentOptions.Timeout = options.Timeout;
+    return PagedRange<Path>(
+        options.Context,
+        options.Continuation.HasValue() ? options.Continuation.GetValue() : std::string(),
+        options.PrefetchDepth,
+        [fileSystemClient, recursive, segmentOptions](
+            Azure::Core::Context& context, const std::string& marker, std::string& nextMarker) {
+          ListPathsOptions pageOptions = segmentOptions;
+          pageOptions.Context = context;
+          if (!marker.empty())
+          {
+            pageOptions.Continuation = marker;
+          }
+          auto response = fileSystemClient.ListPaths(recursive, pageOptions);
+          nextMarker = response.Continuation.HasValue() ? response.Continuation.GetValue()
+                                                        : std::string();
+          return std::move(response.Paths);
+        });
+  }
+
 }}} // namespace Azure::Storage::DataLake
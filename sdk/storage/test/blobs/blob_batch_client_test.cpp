@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "blobs/blob.hpp"
+#include "test_base.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  namespace {
+    // Answers batch requests with a canned response instead of sending them.
+    class FakeBatchServicePolicy : public Azure::Core::Http::HttpPolicy {
+    public:
+      struct State
+      {
+        std::string RequestBody;
+        std::string RequestContentType;
+        std::string ResponseContentType;
+        std::string ResponseBody;
+      };
+
+      explicit FakeBatchServicePolicy(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+
+      HttpPolicy* Clone() const override { return new FakeBatchServicePolicy(m_state); }
+
+      std::unique_ptr<Azure::Core::Http::Response> Send(
+          Azure::Core::Context& context,
+          Azure::Core::Http::Request& request,
+          Azure::Core::Http::NextHttpPolicy) const override
+      {
+        auto body = Azure::Core::Http::BodyStream::ReadToEnd(context, *request.GetBodyStream());
+        m_state->RequestBody.assign(body.begin(), body.end());
+        m_state->RequestContentType = request.GetHeaders().at("content-type");
+
+        auto response = std::make_unique<Azure::Core::Http::Response>(
+            1, 1, Azure::Core::Http::HttpStatusCode::Accepted, "Accepted");
+        response->AddHeader("Content-Type", m_state->ResponseContentType);
+        response->AddHeader("x-ms-request-id", "batch-request");
+        response->AddHeader("x-ms-version", "2019-07-07");
+        response->AddHeader("Date", "Thu, 14 Jun 2018 16:46:54 GMT");
+        response->SetBodyStream(std::make_unique<Azure::Core::Http::MemoryBodyStream>(
+            reinterpret_cast<const uint8_t*>(m_state->ResponseBody.data()),
+            static_cast<int64_t>(m_state->ResponseBody.length())));
+        return response;
+      }
+
+    private:
+      std::shared_ptr<State> m_state;
+    };
+  } // namespace
+
+  TEST(BlobBatchTest, MultipartRequestAndResponse)
+  {
+    auto state = std::make_shared<FakeBatchServicePolicy::State>();
+    Azure::Storage::Blobs::BlobBatchClientOptions clientOptions;
+    clientOptions.PerRetryPolicies.emplace_back(std::make_unique<FakeBatchServicePolicy>(state));
+    Azure::Storage::Blobs::BlobBatchClient batchClient(
+        "https://account.blob.core.windows.net",
+        std::make_shared<SharedKeyCredential>("account", "a2V5"),
+        clientOptions);
+
+    Azure::Storage::Blobs::BlobBatch batch;
+    EXPECT_EQ(batch.DeleteBlob("container", "blob 0"), 0U);
+    EXPECT_EQ(
+        batch.SetBlobAccessTier("container", "blob1", Azure::Storage::Blobs::AccessTier::Cool),
+        1U);
+    EXPECT_EQ(batch.DeleteBlob("container", "blob2"), 2U);
+
+    // Parts may come in any order.
+    state->ResponseContentType = "multipart/mixed; boundary=batchresponse_1";
+    state->ResponseBody = "--batchresponse_1\r\n"
+                          "Content-Type: application/http\r\n"
+                          "Content-ID: 2\r\n"
+                          "\r\n"
+                          "HTTP/1.1 404 The specified blob does not exist.\r\n"
+                          "x-ms-error-code: BlobNotFound\r\n"
+                          "x-ms-request-id: request-2\r\n"
+                          "Content-Length: 24\r\n"
+                          "Content-Type: application/xml\r\n"
+                          "\r\n"
+                          "<Error>missing</Error>\r\n"
+                          "\r\n"
+                          "--batchresponse_1\r\n"
+                          "Content-Type: application/http\r\n"
+                          "Content-ID: 0\r\n"
+                          "\r\n"
+                          "HTTP/1.1 202 Accepted\r\n"
+                          "x-ms-request-id: request-0\r\n"
+                          "\r\n"
+                          "--batchresponse_1\r\n"
+                          "Content-Type: application/http\r\n"
+                          "Content-ID: 1\r\n"
+                          "\r\n"
+                          "HTTP/1.1 200 OK\r\n"
+                          "x-ms-request-id: request-1\r\n"
+                          "\r\n"
+                          "--batchresponse_1--\r\n";
+    auto result = batchClient.SubmitBatch(batch);
+
+    EXPECT_EQ(result.RequestId, "batch-request");
+    ASSERT_EQ(result.Results.size(), 3U);
+    EXPECT_EQ(result.Results[0].StatusCode, Azure::Core::Http::HttpStatusCode::Accepted);
+    EXPECT_TRUE(result.Results[0].Succeeded());
+    EXPECT_EQ(result.Results[0].RequestId, "request-0");
+    EXPECT_EQ(result.Results[1].StatusCode, Azure::Core::Http::HttpStatusCode::Ok);
+    EXPECT_TRUE(result.Results[1].Succeeded());
+    EXPECT_EQ(result.Results[2].StatusCode, Azure::Core::Http::HttpStatusCode::NotFound);
+    EXPECT_FALSE(result.Results[2].Succeeded());
+    EXPECT_EQ(result.Results[2].ErrorCode, "BlobNotFound");
+    EXPECT_EQ(result.Results[2].ReasonPhrase, "The specified blob does not exist.");
+
+    const std::string& body = state->RequestBody;
+    const std::string boundaryPrefix = "multipart/mixed; boundary=";
+    ASSERT_EQ(state->RequestContentType.compare(0, boundaryPrefix.length(), boundaryPrefix), 0);
+    const std::string delimiter
+        = "--" + state->RequestContentType.substr(boundaryPrefix.length());
+    EXPECT_EQ(body.compare(0, delimiter.length(), delimiter), 0);
+    EXPECT_EQ(body.substr(body.length() - delimiter.length() - 4), delimiter + "--\r\n");
+    EXPECT_NE(
+        body.find("Content-ID: 0\r\n\r\nDELETE /container/blob%200 HTTP/1.1\r\n"),
+        std::string::npos);
+    EXPECT_NE(
+        body.find("Content-ID: 1\r\n\r\nPUT /container/blob1?comp=tier HTTP/1.1\r\n"),
+        std::string::npos);
+    EXPECT_NE(body.find("x-ms-access-tier: Cool\r\n"), std::string::npos);
+    EXPECT_NE(
+        body.find("Content-ID: 2\r\n\r\nDELETE /container/blob2 HTTP/1.1\r\n"),
+        std::string::npos);
+    // Every operation is signed on its own and goes without a version of its own.
+    std::size_t numSignatures = 0;
+    const std::string signature = "authorization: SharedKey account:";
+    for (std::size_t pos = body.find(signature); pos != std::string::npos;
+         pos = body.find(signature, pos + 1))
+    {
+      ++numSignatures;
+    }
+    EXPECT_EQ(numSignatures, 3U);
+    EXPECT_EQ(body.find("x-ms-version"), std::string::npos);
+
+    // The service rejects the batch as a whole with a single part without Content-ID.
+    state->ResponseBody = "--batchresponse_1\r\n"
+                          "Content-Type: application/http\r\n"
+                          "\r\n"
+                          "HTTP/1.1 403 Server failed to authenticate the request.\r\n"
+                          "x-ms-error-code: AuthenticationFailed\r\n"
+                          "\r\n"
+                          "--batchresponse_1--\r\n";
+    try
+    {
+      batchClient.SubmitBatch(batch);
+      FAIL();
+    }
+    catch (StorageError& e)
+    {
+      EXPECT_EQ(e.StatusCode, Azure::Core::Http::HttpStatusCode::Forbidden);
+      EXPECT_EQ(e.ErrorCode, "AuthenticationFailed");
+    }
+
+    EXPECT_THROW(batchClient.SubmitBatch(Azure::Storage::Blobs::BlobBatch()), std::runtime_error);
+    Azure::Storage::Blobs::BlobBatch fullBatch;
+    for (std::size_t i = 0; i < Azure::Storage::Blobs::BlobBatch::MaximumSize; ++i)
+    {
+      fullBatch.DeleteBlob("container", "blob" + std::to_string(i));
+    }
+    EXPECT_THROW(fullBatch.DeleteBlob("container", "one too many"), std::runtime_error);
+  }
+
+  TEST(BlobBatchClientTest, DeleteAndSetAccessTier)
+  {
+    const std::string containerName = LowercaseRandomString();
+    auto containerClient = Azure::Storage::Blobs::BlobContainerClient::CreateFromConnectionString(
+        StandardStorageConnectionString(), containerName);
+    containerClient.Create();
+
+    std::vector<std::string> blobNames;
+    for (int i = 0; i < 6; ++i)
+    {
+      blobNames.emplace_back(RandomString());
+      auto blobClient = containerClient.GetBlockBlobClient(blobNames.back());
+      std::vector<uint8_t> content(1);
+      auto contentStream = Azure::Core::Http::MemoryBodyStream(content);
+      blobClient.Upload(contentStream);
+    }
+
+    auto batchClient = Azure::Storage::Blobs::BlobBatchClient::CreateFromConnectionString(
+        StandardStorageConnectionString());
+    Azure::Storage::Blobs::BlobBatch batch;
+    batch.DeleteBlob(containerName, blobNames[0]);
+    batch.SetBlobAccessTier(containerName, blobNames[1], Azure::Storage::Blobs::AccessTier::Cool);
+    std::size_t missingBlob = batch.DeleteBlob(containerName, RandomString());
+    auto result = batchClient.SubmitBatch(batch);
+    ASSERT_EQ(result.Results.size(), 3U);
+    EXPECT_TRUE(result.Results[0].Succeeded());
+    EXPECT_TRUE(result.Results[1].Succeeded());
+    EXPECT_FALSE(result.Results[missingBlob].Succeeded());
+    EXPECT_EQ(result.Results[missingBlob].ErrorCode, "BlobNotFound");
+    EXPECT_THROW(
+        containerClient.GetBlobClient(blobNames[0]).GetProperties(), std::runtime_error);
+    EXPECT_EQ(
+        containerClient.GetBlobClient(blobNames[1]).GetProperties().Tier.GetValue(),
+        Azure::Storage::Blobs::AccessTier::Cool);
+
+    std::vector<Azure::Storage::Blobs::BlobBatch> batches(2);
+    for (std::size_t i = 2; i < blobNames.size(); ++i)
+    {
+      batches[i % 2].DeleteBlob(containerName, blobNames[i]);
+    }
+    Azure::Storage::Blobs::SubmitBlobBatchesOptions options;
+    options.Concurrency = 2;
+    for (const auto& batchResult : batchClient.SubmitBatches(batches, options))
+    {
+      ASSERT_EQ(batchResult.Results.size(), 2U);
+      for (const auto& itemResult : batchResult.Results)
+      {
+        EXPECT_TRUE(itemResult.Succeeded());
+      }
+    }
+    for (std::size_t i = 2; i < blobNames.size(); ++i)
+    {
+      EXPECT_THROW(
+          containerClient.GetBlobClient(blobNames[i]).GetProperties(), std::runtime_error);
+    }
+
+    containerClient.Delete();
+  }
+
+}}} // namespace Azure::Storage::Test
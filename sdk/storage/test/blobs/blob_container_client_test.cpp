@@ -3,8 +3,117 @@
 
 #include "blob_container_client_test.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
 namespace Azure { namespace Storage { namespace Test {
 
+  namespace {
+    // Answers list blobs requests from a set of blob names instead of sending them. The marker
+    // of a page is the name it starts at.
+    class FakeListingServicePolicy : public Azure::Core::Http::HttpPolicy {
+    public:
+      struct State
+      {
+        std::set<std::string> BlobNames;
+        std::atomic<int> NumRequests{0};
+        // The request with this number fails with a 503.
+        int FailingRequest = -1;
+        std::mutex Mutex;
+        // Response bodies, which the body streams don't own.
+        std::deque<std::string> Bodies;
+      };
+
+      explicit FakeListingServicePolicy(std::shared_ptr<State> state) : m_state(std::move(state))
+      {
+      }
+
+      HttpPolicy* Clone() const override { return new FakeListingServicePolicy(m_state); }
+
+      std::unique_ptr<Azure::Core::Http::Response> Send(
+          Azure::Core::Context&,
+          Azure::Core::Http::Request& request,
+          Azure::Core::Http::NextHttpPolicy) const override
+      {
+        if (m_state->NumRequests++ == m_state->FailingRequest)
+        {
+          return std::make_unique<Azure::Core::Http::Response>(
+              1, 1, Azure::Core::Http::HttpStatusCode::ServiceUnavailable, "Server Busy");
+        }
+
+        std::map<std::string, std::string> query;
+        std::string url = request.GetEncodedUrl();
+        std::size_t pos = url.find('?');
+        while (pos != std::string::npos)
+        {
+          std::size_t end = url.find('&', pos + 1);
+          std::string parameter = url.substr(pos + 1, end - pos - 1);
+          std::size_t equal = parameter.find('=');
+          query[parameter.substr(0, equal)] = parameter.substr(equal + 1);
+          pos = end;
+        }
+        const std::string prefix = query["prefix"];
+        const std::string delimiter = query["delimiter"];
+        const std::size_t maxResults
+            = query.count("maxresults") != 0 ? std::stoul(query["maxresults"]) : 5000;
+
+        std::string body = "<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults "
+                           "ServiceEndpoint=\"https://account.blob.core.windows.net/\" "
+                           "ContainerName=\"container\"><Blobs>";
+        std::size_t numResults = 0;
+        std::string lastBlobPrefix;
+        std::string nextMarker;
+        for (auto name = m_state->BlobNames.lower_bound(std::max(prefix, query["marker"]));
+             name != m_state->BlobNames.end() && name->compare(0, prefix.length(), prefix) == 0;
+             ++name)
+        {
+          if (!lastBlobPrefix.empty()
+              && name->compare(0, lastBlobPrefix.length(), lastBlobPrefix) == 0)
+          {
+            continue;
+          }
+          if (numResults == maxResults)
+          {
+            nextMarker = *name;
+            break;
+          }
+          ++numResults;
+          std::size_t delimiterPos = delimiter.empty()
+              ? std::string::npos
+              : name->find(delimiter, prefix.length());
+          if (delimiterPos != std::string::npos)
+          {
+            lastBlobPrefix = name->substr(0, delimiterPos + delimiter.length());
+            body += "<BlobPrefix><Name>" + lastBlobPrefix + "</Name></BlobPrefix>";
+          }
+          else
+          {
+            body += "<Blob><Name>" + *name + "</Name><Properties /></Blob>";
+          }
+        }
+        body += "</Blobs><NextMarker>" + nextMarker + "</NextMarker></EnumerationResults>";
+
+        auto response = std::make_unique<Azure::Core::Http::Response>(
+            1, 1, Azure::Core::Http::HttpStatusCode::Ok, "OK");
+        response->AddHeader("Content-Type", "application/xml");
+        response->AddHeader("x-ms-request-id", "list-request");
+        response->AddHeader("x-ms-version", "2019-07-07");
+        response->AddHeader("Date", "Thu, 14 Jun 2018 16:46:54 GMT");
+        std::lock_guard<std::mutex> guard(m_state->Mutex);
+        m_state->Bodies.emplace_back(std::move(body));
+        response->SetBodyStream(std::make_unique<Azure::Core::Http::MemoryBodyStream>(
+            reinterpret_cast<const uint8_t*>(m_state->Bodies.back().data()),
+            static_cast<int64_t>(m_state->Bodies.back().length())));
+        return response;
+      }
+
+    private:
+      std::shared_ptr<State> m_state;
+    };
+  } // namespace
+
   std::shared_ptr<Azure::Storage::Blobs::BlobContainerClient>
       BlobContainerClientTest::m_blobContainerClient;
   std::string BlobContainerClientTest::m_containerName;
@@ -142,6 +251,50 @@ namespace Azure { namespace Storage { namespace Test {
     EXPECT_TRUE(std::includes(listBlobs.begin(), listBlobs.end(), p1Blobs.begin(), p1Blobs.end()));
   }
 
+  TEST_F(BlobContainerClientTest, ListBlobs)
+  {
+    const std::string prefix = "listblobs-" + LowercaseRandomString() + "-";
+    std::vector<std::string> blobNames;
+    for (int i = 0; i < 7; ++i)
+    {
+      std::string blobName = prefix + "blob" + std::to_string(i);
+      auto blobClient = m_blobContainerClient->GetBlockBlobClient(blobName);
+      auto emptyContent = Azure::Core::Http::MemoryBodyStream(nullptr, 0);
+      blobClient.Upload(emptyContent);
+      blobNames.emplace_back(blobName);
+    }
+
+    for (int prefetchDepth : {0, 1, 3})
+    {
+      Azure::Storage::Blobs::ListBlobsOptions options;
+      options.Prefix = prefix;
+      options.MaxResults = 2;
+      options.PrefetchDepth = prefetchDepth;
+      std::vector<std::string> listBlobs;
+      for (const auto& blob : m_blobContainerClient->ListBlobs(options))
+      {
+        listBlobs.emplace_back(blob.Name);
+      }
+      EXPECT_EQ(listBlobs, blobNames);
+    }
+
+    // Resuming from the marker of a range picks up where it stopped.
+    Azure::Storage::Blobs::ListBlobsOptions options;
+    options.Prefix = prefix;
+    options.MaxResults = 3;
+    auto range = m_blobContainerClient->ListBlobs(options);
+    std::vector<Azure::Storage::Blobs::BlobItem> page;
+    ASSERT_TRUE(range.NextPage(page));
+    EXPECT_EQ(page.size(), 3U);
+    options.Marker = range.GetNextMarker();
+    std::vector<std::string> listBlobs;
+    for (const auto& blob : m_blobContainerClient->ListBlobs(options))
+    {
+      listBlobs.emplace_back(blob.Name);
+    }
+    EXPECT_EQ(listBlobs, std::vector<std::string>(blobNames.begin() + 3, blobNames.end()));
+  }
+
   TEST_F(BlobContainerClientTest, ListBlobsHierarchy)
   {
     const std::string delimiter = "/";
@@ -190,4 +343,253 @@ namespace Azure { namespace Storage { namespace Test {
     EXPECT_EQ(listBlobs, blobs);
   }
 
+  TEST(ListBlobsFlatTest, ParsesSegment)
+  {
+    // Elements the parser doesn't know, or knows from elsewhere, mustn't be mistaken for the
+    // ones it reads.
+    const std::string body
+        = "<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults "
+          "ServiceEndpoint=\"https://account.blob.core.windows.net/\" ContainerName=\"c\">"
+          "<Prefix>p</Prefix><Marker>m</Marker><Delimiter>/</Delimiter>"
+          "<Extra><Name>not a blob</Name><NextMarker>not a marker</NextMarker></Extra><Blobs>"
+          "<Blob><Name>p0</Name><Snapshot>2020-01-01T00:00:00.0000000Z</Snapshot>"
+          "<Deleted>true</Deleted><Extra><Name>not a name</Name></Extra><Properties>"
+          "<Creation-Time>Mon, 01 Jun 2020 00:00:00 GMT</Creation-Time>"
+          "<Last-Modified>Tue, 02 Jun 2020 00:00:00 GMT</Last-Modified><Etag>0x8D8</Etag>"
+          "<Content-Length>1024</Content-Length><Content-Type>text/plain</Content-Type>"
+          "<Content-Encoding>gzip</Content-Encoding><Content-Language>en</Content-Language>"
+          "<Content-MD5>md5</Content-MD5><Cache-Control>no-cache</Cache-Control>"
+          "<Content-Disposition>inline</Content-Disposition><BlobType>AppendBlob</BlobType>"
+          "<AccessTier>Cool</AccessTier><AccessTierInferred>false</AccessTierInferred>"
+          "<LeaseStatus>locked</LeaseStatus><LeaseState>leased</LeaseState>"
+          "<LeaseDuration>infinite</LeaseDuration><ServerEncrypted>true</ServerEncrypted>"
+          "<EncryptionKeySHA256>sha</EncryptionKeySHA256><Name>not a name</Name>"
+          "<Unknown><Etag>not an etag</Etag></Unknown></Properties>"
+          "<Metadata><k1>v1</k1><Name>v2</Name></Metadata><Content-Type>not a type</Content-Type>"
+          "</Blob><BlobPrefix><Name>p/</Name><Extra>x</Extra></BlobPrefix>"
+          "<Blob><Name>p1</Name><Properties /><Metadata /></Blob></Blobs>"
+          "<NextMarker>next</NextMarker></EnumerationResults>";
+    auto response = std::make_unique<Azure::Core::Http::Response>(
+        1, 1, Azure::Core::Http::HttpStatusCode::Ok, "OK");
+    response->AddHeader("x-ms-version", "2019-07-07");
+    response->AddHeader("Date", "Thu, 14 Jun 2018 16:46:54 GMT");
+    response->AddHeader("x-ms-request-id", "list-request");
+    response->SetBodyStream(std::make_unique<Azure::Core::Http::MemoryBodyStream>(
+        reinterpret_cast<const uint8_t*>(body.data()), static_cast<int64_t>(body.length())));
+    auto segment = Azure::Storage::Blobs::BlobRestClient::Container::ListBlobsParseResponse(
+        Azure::Core::Context(), std::move(response));
+
+    EXPECT_EQ(segment.ServiceEndpoint, "https://account.blob.core.windows.net/");
+    EXPECT_EQ(segment.Container, "c");
+    EXPECT_EQ(segment.Prefix, "p");
+    EXPECT_EQ(segment.Marker, "m");
+    EXPECT_EQ(segment.Delimiter, "/");
+    EXPECT_EQ(segment.NextMarker, "next");
+    EXPECT_EQ(segment.BlobPrefixes, std::vector<std::string>{"p/"});
+    ASSERT_EQ(segment.Items.size(), 2U);
+    const auto& blob = segment.Items[0];
+    EXPECT_EQ(blob.Name, "p0");
+    EXPECT_EQ(blob.Snapshot, "2020-01-01T00:00:00.0000000Z");
+    EXPECT_TRUE(blob.Deleted);
+    EXPECT_EQ(blob.CreationTime, "Mon, 01 Jun 2020 00:00:00 GMT");
+    EXPECT_EQ(blob.LastModified, "Tue, 02 Jun 2020 00:00:00 GMT");
+    EXPECT_EQ(blob.ETag, "0x8D8");
+    EXPECT_EQ(blob.ContentLength, 1024);
+    EXPECT_EQ(blob.HttpHeaders.ContentType, "text/plain");
+    EXPECT_EQ(blob.HttpHeaders.ContentEncoding, "gzip");
+    EXPECT_EQ(blob.HttpHeaders.ContentLanguage, "en");
+    EXPECT_EQ(blob.HttpHeaders.ContentMD5, "md5");
+    EXPECT_EQ(blob.HttpHeaders.CacheControl, "no-cache");
+    EXPECT_EQ(blob.HttpHeaders.ContentDisposition, "inline");
+    EXPECT_EQ(blob.BlobType, Azure::Storage::Blobs::BlobType::AppendBlob);
+    EXPECT_EQ(blob.Tier, Azure::Storage::Blobs::AccessTier::Cool);
+    EXPECT_FALSE(blob.AccessTierInferred);
+    EXPECT_EQ(blob.LeaseStatus, Azure::Storage::Blobs::BlobLeaseStatus::Locked);
+    EXPECT_EQ(blob.LeaseState, Azure::Storage::Blobs::BlobLeaseState::Leased);
+    EXPECT_EQ(blob.LeaseDuration.GetValue(), "infinite");
+    EXPECT_TRUE(blob.ServerEncrypted.GetValue());
+    EXPECT_EQ(blob.EncryptionKeySHA256.GetValue(), "sha");
+    EXPECT_EQ(
+        blob.Metadata, (std::map<std::string, std::string>{{"k1", "v1"}, {"Name", "v2"}}));
+    EXPECT_EQ(segment.Items[1].Name, "p1");
+    EXPECT_TRUE(segment.Items[1].Metadata.empty());
+  }
+
+  TEST(ListBlobsFlatTest, HandsOutBlobsAsParsed)
+  {
+    auto state = std::make_shared<FakeListingServicePolicy::State>();
+    for (int i = 0; i < 10; ++i)
+    {
+      state->BlobNames.insert("dir/" + std::to_string(i));
+      state->BlobNames.insert(std::to_string(i));
+    }
+    Azure::Storage::Blobs::BlobContainerClientOptions clientOptions;
+    clientOptions.PerRetryPolicies.emplace_back(
+        std::make_unique<FakeListingServicePolicy>(state));
+    Azure::Storage::Blobs::BlobContainerClient containerClient(
+        "https://account.blob.core.windows.net/container",
+        std::make_shared<SharedKeyCredential>("account", "a2V5"),
+        clientOptions);
+
+    Azure::Storage::Blobs::ListBlobsOptions options;
+    options.Delimiter = "/";
+    options.MaxResults = 5;
+    std::vector<std::string> blobNames;
+    auto segment = containerClient.ListBlobsFlat(
+        [&](Azure::Storage::Blobs::BlobItem& blob) { blobNames.emplace_back(blob.Name); },
+        options);
+    EXPECT_TRUE(segment.Items.empty());
+    EXPECT_EQ(segment.NextMarker, "5");
+    EXPECT_EQ(blobNames, std::vector<std::string>({"0", "1", "2", "3", "4"}));
+
+    options.Marker = segment.NextMarker;
+    options.MaxResults = 10;
+    segment = containerClient.ListBlobsFlat(
+        [&](Azure::Storage::Blobs::BlobItem& blob) { blobNames.emplace_back(blob.Name); },
+        options);
+    EXPECT_TRUE(segment.Items.empty());
+    EXPECT_EQ(segment.BlobPrefixes, std::vector<std::string>{"dir/"});
+    EXPECT_TRUE(segment.NextMarker.empty());
+    EXPECT_EQ(blobNames.size(), 10U);
+    EXPECT_EQ(blobNames.back(), "9");
+  }
+
+  TEST(ListBlobsParallelTest, SplitsIntoRanges)
+  {
+    auto state = std::make_shared<FakeListingServicePolicy::State>();
+    std::vector<std::string> expected;
+    for (const std::string directory : {"a", "b/c", "b/d", "b/e/f", "g"})
+    {
+      for (int i = 0; i < 7; ++i)
+      {
+        state->BlobNames.insert(directory + "/" + std::to_string(i));
+      }
+      state->BlobNames.insert(directory);
+    }
+    state->BlobNames.insert("b");
+    state->BlobNames.insert("b/c/");
+    state->BlobNames.insert("b0");
+    state->BlobNames.insert("other");
+    for (const auto& name : state->BlobNames)
+    {
+      if (name.compare(0, 1, "b") == 0)
+      {
+        expected.emplace_back(name);
+      }
+    }
+
+    Azure::Storage::Blobs::BlobContainerClientOptions clientOptions;
+    clientOptions.PerRetryPolicies.emplace_back(
+        std::make_unique<FakeListingServicePolicy>(state));
+    Azure::Storage::Blobs::BlobContainerClient containerClient(
+        "https://account.blob.core.windows.net/container",
+        std::make_shared<SharedKeyCredential>("account", "a2V5"),
+        clientOptions);
+
+    for (bool sorted : {true, false})
+    {
+      for (int partitionDepth : {0, 1, 2, 5})
+      {
+        for (bool alphabet : {true, false})
+        {
+          Azure::Storage::Blobs::ListBlobsParallelOptions options;
+          options.Prefix = "b";
+          options.MaxResults = 2;
+          options.PartitionDepth = partitionDepth;
+          options.Concurrency = 3;
+          options.Sorted = sorted;
+          if (alphabet)
+          {
+            options.PartitionAlphabet = "/0";
+          }
+          // A page that fails is requested again.
+          state->NumRequests = 0;
+          state->FailingRequest = partitionDepth == 1 ? 2 : -1;
+
+          std::mutex mutex;
+          std::vector<std::string> listed;
+          containerClient.ListBlobsParallel(
+              [&](std::vector<Azure::Storage::Blobs::BlobItem>& blobs) {
+                EXPECT_FALSE(blobs.empty());
+                std::unique_lock<std::mutex> guard(mutex, std::try_to_lock);
+                EXPECT_TRUE(guard.owns_lock());
+                for (const auto& blob : blobs)
+                {
+                  listed.emplace_back(blob.Name);
+                }
+              },
+              options);
+          if (!sorted)
+          {
+            std::sort(listed.begin(), listed.end());
+          }
+          EXPECT_EQ(listed, expected);
+        }
+      }
+    }
+
+    // Characters outside of the alphabet aren't listed.
+    Azure::Storage::Blobs::ListBlobsParallelOptions options;
+    options.PartitionAlphabet = "ag";
+    options.Sorted = true;
+    state->FailingRequest = -1;
+    std::vector<std::string> listed;
+    containerClient.ListBlobsParallel(
+        [&](std::vector<Azure::Storage::Blobs::BlobItem>& blobs) {
+          for (const auto& blob : blobs)
+          {
+            listed.emplace_back(blob.Name);
+          }
+        },
+        options);
+    EXPECT_EQ(listed.size(), 16U);
+    EXPECT_EQ(listed.front(), "a");
+    EXPECT_EQ(listed.back(), "g/6");
+
+    options.PartitionAlphabet = "";
+    EXPECT_THROW(
+        containerClient.ListBlobsParallel(
+            [](std::vector<Azure::Storage::Blobs::BlobItem>&) {}, options),
+        std::runtime_error);
+  }
+
+  TEST_F(BlobContainerClientTest, ListBlobsParallel)
+  {
+    const std::string prefix = "listblobsparallel-" + LowercaseRandomString() + "/";
+    std::set<std::string> blobNames;
+    for (const std::string directory : {"a/", "b/c/", "b/d/", ""})
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        std::string blobName = prefix + directory + "blob" + std::to_string(i);
+        auto blobClient = m_blobContainerClient->GetBlockBlobClient(blobName);
+        auto emptyContent = Azure::Core::Http::MemoryBodyStream(nullptr, 0);
+        blobClient.Upload(emptyContent);
+        blobNames.insert(blobName);
+      }
+    }
+
+    for (bool alphabet : {true, false})
+    {
+      Azure::Storage::Blobs::ListBlobsParallelOptions options;
+      options.Prefix = prefix;
+      options.MaxResults = 2;
+      options.Sorted = true;
+      if (alphabet)
+      {
+        options.PartitionAlphabet = "abcdefghijklmnopqrstuvwxyz";
+      }
+      std::vector<std::string> listBlobs;
+      m_blobContainerClient->ListBlobsParallel(
+          [&](std::vector<Azure::Storage::Blobs::BlobItem>& blobs) {
+            for (const auto& blob : blobs)
+            {
+              listBlobs.emplace_back(blob.Name);
+            }
+          },
+          options);
+      EXPECT_EQ(listBlobs, std::vector<std::string>(blobNames.begin(), blobNames.end()));
+    }
+  }
+
 }}} // namespace Azure::Storage::Test
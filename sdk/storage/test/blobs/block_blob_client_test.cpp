@@ -5,6 +5,7 @@
 
 #include "common/crypt.hpp"
 #include "common/file_io.hpp"
+#include "common/transfer_journal.hpp"
 
 #include <future>
 #include <random>
@@ -520,6 +521,8 @@ namespace Azure { namespace Storage { namespace Test {
         options.HttpHeaders = m_blobUploadOptions.HttpHeaders;
         options.Metadata = m_blobUploadOptions.Metadata;
         options.Tier = m_blobUploadOptions.Tier;
+        // Files are uploaded through a mapping with some of the concurrencies.
+        options.MemoryMapFile = c != 2;
         {
           auto res = blockBlobClient.UploadFromBuffer(
               m_blobContent.data(), static_cast<std::size_t>(length), options);
@@ -580,4 +583,187 @@ namespace Azure { namespace Storage { namespace Test {
     DeleteFile(tempFilename);
   }
 
+  TEST_F(BlockBlobClientTest, UploadFromStream)
+  {
+    auto blockBlobClient = Azure::Storage::Blobs::BlockBlobClient::CreateFromConnectionString(
+        StandardStorageConnectionString(), m_containerName, RandomString());
+    for (int64_t length : {0ULL, 1ULL, 1_MB, 3_MB + 1234})
+    {
+      Azure::Storage::Blobs::UploadBlobOptions options;
+      options.ChunkSize = 1_MB;
+      options.Concurrency = 2;
+      options.Metadata = m_blobUploadOptions.Metadata;
+      std::vector<uint8_t> expected(
+          m_blobContent.begin(), m_blobContent.begin() + static_cast<std::size_t>(length));
+      Azure::Core::Http::MemoryBodyStream stream(expected);
+      auto res = blockBlobClient.UploadFromStream(stream, options);
+      EXPECT_FALSE(res.ETag.empty());
+      auto properties = blockBlobClient.GetProperties();
+      EXPECT_EQ(properties.ContentLength, length);
+      EXPECT_EQ(properties.Metadata, options.Metadata);
+      std::vector<uint8_t> downloadContent(static_cast<std::size_t>(length), '\x00');
+      blockBlobClient.DownloadToBuffer(downloadContent.data(), downloadContent.size());
+      EXPECT_EQ(downloadContent, expected);
+    }
+  }
+
+  TEST_F(BlockBlobClientTest, ResumableTransfers)
+  {
+    auto blockBlobClient = Azure::Storage::Blobs::BlockBlobClient::CreateFromConnectionString(
+        StandardStorageConnectionString(), m_containerName, RandomString());
+    const std::string tempFilename = RandomString();
+    const std::string journalFilename = RandomString() + ".journal";
+    const std::size_t fileSize = static_cast<std::size_t>(3_MB + 1234);
+    const std::vector<uint8_t> expected(m_blobContent.begin(), m_blobContent.begin() + fileSize);
+    {
+      Azure::Storage::Details::FileWriter fileWriter(tempFilename);
+      fileWriter.Write(expected.data(), fileSize, 0);
+    }
+
+    Azure::Storage::Blobs::UploadBlobOptions uploadOptions;
+    uploadOptions.ChunkSize = 1_MB;
+    uploadOptions.Concurrency = 2;
+    uploadOptions.JournalFile = journalFilename;
+    // Fails to commit after all blocks were staged.
+    uploadOptions.Metadata = {{"0invalid", "value"}};
+    EXPECT_THROW(blockBlobClient.UploadFromFile(tempFilename, uploadOptions), StorageError);
+    EXPECT_FALSE(ReadFile(journalFilename).empty());
+
+    uploadOptions.Metadata.clear();
+    blockBlobClient.UploadFromFile(tempFilename, uploadOptions);
+    std::vector<uint8_t> downloadContent(fileSize);
+    blockBlobClient.DownloadToBuffer(downloadContent.data(), downloadContent.size());
+    EXPECT_EQ(downloadContent, expected);
+    EXPECT_THROW(ReadFile(journalFilename), std::runtime_error);
+
+    // Committing something else drops the staged blocks, they must be staged again.
+    uploadOptions.Metadata = {{"0invalid", "value"}};
+    EXPECT_THROW(blockBlobClient.UploadFromFile(tempFilename, uploadOptions), StorageError);
+    blockBlobClient.UploadFromBuffer(m_blobContent.data(), 1_KB);
+    uploadOptions.Metadata.clear();
+    blockBlobClient.UploadFromFile(tempFilename, uploadOptions);
+    blockBlobClient.DownloadToBuffer(downloadContent.data(), downloadContent.size());
+    EXPECT_EQ(downloadContent, expected);
+
+    // A journal of another transfer is started over.
+    {
+      Azure::Storage::Details::TransferJournal journal(journalFilename, "another transfer");
+      journal.MarkCompleted(0);
+    }
+    Azure::Storage::Blobs::DownloadBlobToFileOptions downloadOptions;
+    downloadOptions.InitialChunkSize = 1_MB;
+    downloadOptions.ChunkSize = 1_MB;
+    downloadOptions.Concurrency = 2;
+    downloadOptions.JournalFile = journalFilename;
+    const std::string downloadFilename = RandomString();
+    blockBlobClient.DownloadToFile(downloadFilename, downloadOptions);
+    EXPECT_EQ(ReadFile(downloadFilename), expected);
+    EXPECT_THROW(ReadFile(journalFilename), std::runtime_error);
+
+    DeleteFile(tempFilename);
+    DeleteFile(downloadFilename);
+  }
+
+  TEST_F(BlockBlobClientTest, OpenRead)
+  {
+    auto blockBlobClient = Azure::Storage::Blobs::BlockBlobClient::CreateFromConnectionString(
+        StandardStorageConnectionString(), m_containerName, RandomString());
+    const int64_t blobSize = 3_MB + 1234;
+    blockBlobClient.UploadFromBuffer(m_blobContent.data(), static_cast<std::size_t>(blobSize));
+
+    Azure::Storage::Blobs::OpenReadBlobOptions options;
+    options.Offset = 1234;
+    options.Length = 2_MB + 5;
+    options.ChunkSize = 512_KB;
+    options.Concurrency = 3;
+    auto stream = blockBlobClient.OpenRead(options);
+    EXPECT_EQ(stream->Length(), options.Length.GetValue());
+    auto downloadContent = Azure::Core::Http::BodyStream::ReadToEnd(options.Context, *stream);
+    EXPECT_EQ(
+        downloadContent,
+        std::vector<uint8_t>(
+            m_blobContent.begin() + 1234,
+            m_blobContent.begin() + 1234 + static_cast<std::size_t>(options.Length.GetValue())));
+
+    // Chunks after the blob changed must not be mixed into the content.
+    options.Offset.Reset();
+    options.Length.Reset();
+    options.Concurrency = 1;
+    stream = blockBlobClient.OpenRead(options);
+    EXPECT_EQ(stream->Length(), blobSize);
+    std::vector<uint8_t> buffer(static_cast<std::size_t>(options.ChunkSize));
+    EXPECT_EQ(
+        Azure::Core::Http::BodyStream::ReadToCount(
+            options.Context, *stream, buffer.data(), options.ChunkSize),
+        options.ChunkSize);
+    blockBlobClient.UploadFromBuffer(m_blobContent.data(), static_cast<std::size_t>(blobSize));
+    EXPECT_THROW(
+        Azure::Core::Http::BodyStream::ReadToEnd(options.Context, *stream), StorageError);
+  }
+
+  TEST_F(BlockBlobClientTest, TransactionalCRC64)
+  {
+    std::string tempFilename = RandomString();
+
+    auto blockBlobClient = Azure::Storage::Blobs::BlockBlobClient::CreateFromConnectionString(
+        StandardStorageConnectionString(), m_containerName, RandomString());
+    for (int64_t length : {0ULL, 1ULL, 4_MB, 8_MB - 1234})
+    {
+      Azure::Storage::Blobs::UploadBlobOptions uploadOptions;
+      uploadOptions.ChunkSize = 3_MB;
+      uploadOptions.Concurrency = 2;
+      uploadOptions.TransactionalCRC64 = true;
+      blockBlobClient.UploadFromBuffer(
+          m_blobContent.data(), static_cast<std::size_t>(length), uploadOptions);
+
+      Azure::Storage::Blobs::DownloadBlobToFileOptions downloadOptions;
+      // Larger than the service returns checksums for, chunks are capped.
+      downloadOptions.InitialChunkSize = 5_MB;
+      downloadOptions.ChunkSize = 5_MB;
+      downloadOptions.Concurrency = 2;
+      downloadOptions.TransactionalCRC64 = true;
+      std::vector<uint8_t> expected(
+          m_blobContent.begin(), m_blobContent.begin() + static_cast<std::size_t>(length));
+      std::vector<uint8_t> downloadContent(static_cast<std::size_t>(length), '\x00');
+      blockBlobClient.DownloadToBuffer(
+          downloadContent.data(), downloadContent.size(), downloadOptions);
+      EXPECT_EQ(downloadContent, expected);
+      blockBlobClient.DownloadToFile(tempFilename, downloadOptions);
+      EXPECT_EQ(ReadFile(tempFilename), expected);
+
+      {
+        Azure::Storage::Details::FileWriter fileWriter(tempFilename);
+        fileWriter.Write(m_blobContent.data(), length, 0);
+      }
+      blockBlobClient.UploadFromFile(tempFilename, uploadOptions);
+      blockBlobClient.DownloadToBuffer(
+          downloadContent.data(), downloadContent.size(), downloadOptions);
+      EXPECT_EQ(downloadContent, expected);
+    }
+    DeleteFile(tempFilename);
+  }
+
+  TEST_F(BlockBlobClientTest, CompactBlockIds)
+  {
+    auto blockBlobClient = Azure::Storage::Blobs::BlockBlobClient::CreateFromConnectionString(
+        StandardStorageConnectionString(), m_containerName, RandomString());
+    Azure::Storage::Blobs::UploadBlobOptions options;
+    options.ChunkSize = 1_MB;
+    options.Concurrency = 2;
+    options.CompactBlockIds = true;
+    std::size_t length = static_cast<std::size_t>(3_MB + 1234);
+    blockBlobClient.UploadFromBuffer(m_blobContent.data(), length, options);
+
+    auto blockList = blockBlobClient.GetBlockList().CommittedBlocks;
+    ASSERT_EQ(blockList.size(), 4U);
+    for (const auto& block : blockList)
+    {
+      EXPECT_EQ(block.Name.length(), 8U);
+    }
+    std::vector<uint8_t> downloadContent(length, '\x00');
+    blockBlobClient.DownloadToBuffer(downloadContent.data(), downloadContent.size());
+    std::vector<uint8_t> expected(m_blobContent.begin(), m_blobContent.begin() + length);
+    EXPECT_EQ(downloadContent, expected);
+  }
+
 }}} // namespace Azure::Storage::Test
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/base64.hpp"
+#include "test_base.hpp"
+
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  TEST(Base64Test, EncodeDecode)
+  {
+    const std::vector<std::pair<std::string, std::string>> vectors = {
+        {"", ""},
+        {"f", "Zg=="},
+        {"fo", "Zm8="},
+        {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="},
+        {"fooba", "Zm9vYmE="},
+        {"foobar", "Zm9vYmFy"},
+        {"\xfb\xff\xbf", "+/+/"},
+    };
+    for (const auto& v : vectors)
+    {
+      EXPECT_EQ(Base64Encode(v.first), v.second);
+      EXPECT_EQ(Base64Decode(v.second), v.first);
+    }
+
+    // Long enough for every vectorized path and its tail, encoding whole triples one at a time
+    // has to give the same result.
+    std::vector<uint8_t> buffer = RandomBuffer(1000);
+    for (std::size_t length = 0; length <= buffer.size(); length += length < 100 ? 1 : 97)
+    {
+      std::string text(buffer.begin(), buffer.begin() + length);
+      std::string encoded = Base64Encode(text);
+      ASSERT_EQ(encoded.length(), Base64EncodedLength(length));
+      std::string expected;
+      for (std::size_t i = 0; i < length; i += 3)
+      {
+        expected += Base64Encode(text.substr(i, 3));
+      }
+      EXPECT_EQ(encoded, expected);
+      EXPECT_EQ(Base64Decode(encoded), text);
+
+      // In place.
+      std::vector<char> inPlace(encoded.begin(), encoded.end());
+      std::size_t decodedLength = Base64Decode(
+          inPlace.data(), inPlace.size(), reinterpret_cast<uint8_t*>(inPlace.data()));
+      EXPECT_EQ(std::string(inPlace.data(), decodedLength), text);
+    }
+  }
+
+  TEST(Base64Test, Invalid)
+  {
+    for (const char* text : {"Zg=", "Zg", "Z===", "====", "Zm=v", "Zm9v\nYg==", "Zm9-"})
+    {
+      EXPECT_THROW(Base64Decode(text), std::runtime_error) << text;
+    }
+
+    // Invalid characters and padding anywhere in a long string.
+    const std::string valid = Base64Encode(RandomString(300));
+    EXPECT_NO_THROW(Base64Decode(valid));
+    for (std::size_t i = 0; i + 4 < valid.length(); i += 13)
+    {
+      for (char c : {'=', '*', '\0', '\x80', ' '})
+      {
+        std::string text = valid;
+        text[i] = c;
+        EXPECT_THROW(Base64Decode(text), std::runtime_error) << i;
+      }
+    }
+  }
+
+}}} // namespace Azure::Storage::Test
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/buffer_pool.hpp"
+#include "common/file_io.hpp"
+#include "test_base.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  TEST(AlignedBufferPoolTest, ReusesAlignedBuffers)
+  {
+    Details::AlignedBufferPool pool(10000, 2);
+    EXPECT_EQ(pool.GetBufferSize(), 12288);
+
+    Azure::Core::Context context;
+    {
+      auto buffer1 = pool.Acquire(context);
+      auto buffer2 = pool.Acquire(context);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer1.Data()) % 4096, 0U);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer2.Data()) % 4096, 0U);
+      EXPECT_NE(buffer1.Data(), buffer2.Data());
+      EXPECT_EQ(pool.GetAllocatedBuffers(), 2);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+      auto buffer = pool.Acquire(context);
+      EXPECT_NE(buffer.Data(), nullptr);
+    }
+    EXPECT_EQ(pool.GetAllocatedBuffers(), 2);
+  }
+
+  TEST(AlignedBufferPoolTest, Backpressure)
+  {
+    Details::AlignedBufferPool pool(4_KB, 1);
+    Azure::Core::Context context;
+    auto buffer = pool.Acquire(context);
+
+    std::atomic<bool> acquired{false};
+    auto waiter = std::async(std::launch::async, [&]() {
+      Azure::Core::Context waiterContext;
+      auto buffer2 = pool.Acquire(waiterContext);
+      acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(acquired);
+    {
+      auto released = std::move(buffer);
+    }
+    waiter.get();
+    EXPECT_TRUE(acquired);
+
+    auto buffer3 = pool.Acquire(context);
+    Azure::Core::Context cancelledContext
+        = context.WithDeadline(std::chrono::system_clock::now() - std::chrono::seconds(1));
+    EXPECT_THROW(pool.Acquire(cancelledContext), std::runtime_error);
+  }
+
+  TEST(FileWriteStageTest, WritesBuffersInBackground)
+  {
+    const std::string filename = "file_write_stage_test_" + RandomString();
+    const int64_t bufferSize = 4_KB;
+    const int numBuffers = 64;
+    std::vector<uint8_t> expected = RandomBuffer(static_cast<std::size_t>(bufferSize * numBuffers));
+    {
+      Details::FileWriter fileWriter(filename);
+      Details::AlignedBufferPool pool(bufferSize, 3);
+      Details::FileWriteStage writeStage(fileWriter);
+      Azure::Core::Context context;
+      // Write back to front, the stage must honor offsets.
+      for (int i = numBuffers - 1; i >= 0; --i)
+      {
+        auto buffer = pool.Acquire(context);
+        std::memcpy(
+            buffer.Data(),
+            expected.data() + i * bufferSize,
+            static_cast<std::size_t>(bufferSize));
+        writeStage.Write(std::move(buffer), bufferSize, i * bufferSize);
+      }
+      writeStage.Flush();
+      EXPECT_LE(pool.GetAllocatedBuffers(), 3);
+    }
+    EXPECT_EQ(ReadFile(filename), expected);
+    DeleteFile(filename);
+  }
+
+  TEST(FileWriteStageTest, CallsBackOnceWritten)
+  {
+    const std::string filename = "file_write_stage_test_" + RandomString();
+    const int64_t bufferSize = 4_KB;
+    const int numBuffers = 32;
+    std::vector<uint8_t> expected = RandomBuffer(static_cast<std::size_t>(bufferSize * numBuffers));
+    {
+      Details::FileWriter fileWriter(filename);
+      Details::AlignedBufferPool pool(bufferSize, 3);
+      Details::FileWriteStage writeStage(fileWriter);
+      Azure::Core::Context context;
+
+      bool called = false;
+      writeStage.WhenWritten([&]() { called = true; });
+      EXPECT_TRUE(called);
+
+      std::vector<int> written;
+      for (int i = 0; i < numBuffers; ++i)
+      {
+        auto buffer = pool.Acquire(context);
+        std::memcpy(
+            buffer.Data(),
+            expected.data() + i * bufferSize,
+            static_cast<std::size_t>(bufferSize));
+        writeStage.Write(std::move(buffer), bufferSize, i * bufferSize);
+        writeStage.WhenWritten([&, i]() {
+          // Everything queued before the callback is in the file by now.
+          EXPECT_GE(ReadFile(filename).size(), static_cast<std::size_t>((i + 1) * bufferSize));
+          written.emplace_back(i);
+        });
+      }
+      writeStage.Flush();
+      ASSERT_EQ(written.size(), static_cast<std::size_t>(numBuffers));
+      for (int i = 0; i < numBuffers; ++i)
+      {
+        EXPECT_EQ(written[static_cast<std::size_t>(i)], i);
+      }
+    }
+    EXPECT_EQ(ReadFile(filename), expected);
+    DeleteFile(filename);
+  }
+
+}}} // namespace Azure::Storage::Test
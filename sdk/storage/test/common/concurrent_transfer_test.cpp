@@ -0,0 +1,384 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/concurrent_transfer.hpp"
+#include "common/storage_error.hpp"
+#include "common/thread_pool.hpp"
+#include "test_base.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  namespace {
+    // A forward-only stream of unknown length that returns at most 700 bytes per read.
+    class TrickleBodyStream : public Azure::Core::Http::BodyStream {
+    public:
+      explicit TrickleBodyStream(const std::vector<uint8_t>& data) : m_data(data) {}
+
+      int64_t Length() const override { return -1; }
+
+      void Rewind() override { throw std::runtime_error("not rewindable"); }
+
+      int64_t Read(Azure::Core::Context&, uint8_t* buffer, int64_t count) override
+      {
+        std::size_t length = std::min(
+            {static_cast<std::size_t>(count), m_data.size() - m_offset, std::size_t(700)});
+        std::copy(m_data.begin() + m_offset, m_data.begin() + m_offset + length, buffer);
+        m_offset += length;
+        return static_cast<int64_t>(length);
+      }
+
+    private:
+      const std::vector<uint8_t>& m_data;
+      std::size_t m_offset = 0;
+    };
+  } // namespace
+
+  TEST(ConcurrentTransferTest, CoversAllChunks)
+  {
+    for (int concurrency : {1, 2, 4, 16})
+    {
+      for (int64_t length : {0LL, 1LL, 1000LL, 1024LL, 1025LL, 100000LL})
+      {
+        std::vector<std::atomic<int>> visited(static_cast<std::size_t>(length));
+        Details::ConcurrentTransfer(
+            Azure::Core::Context(),
+            100,
+            length,
+            1024,
+            concurrency,
+            [&](Azure::Core::Context&,
+                int64_t offset,
+                int64_t chunkLength,
+                int64_t chunkId,
+                int64_t numChunks) {
+              EXPECT_EQ(numChunks, (length + 1023) / 1024);
+              EXPECT_EQ(offset, 100 + chunkId * 1024);
+              for (int64_t i = offset - 100; i < offset - 100 + chunkLength; ++i)
+              {
+                visited[static_cast<std::size_t>(i)].fetch_add(1);
+              }
+            });
+        for (const auto& v : visited)
+        {
+          EXPECT_EQ(v.load(), 1);
+        }
+      }
+    }
+  }
+
+  TEST(ConcurrentTransferTest, PropagatesFirstException)
+  {
+    std::atomic<int> numCalls{0};
+    EXPECT_THROW(
+        Details::ConcurrentTransfer(
+            Azure::Core::Context(),
+            0,
+            1000,
+            1,
+            4,
+            [&](Azure::Core::Context&, int64_t, int64_t, int64_t chunkId, int64_t) {
+              numCalls.fetch_add(1);
+              if (chunkId == 10)
+              {
+                throw std::runtime_error("chunk failed");
+              }
+            }),
+        std::runtime_error);
+    EXPECT_LT(numCalls.load(), 1000);
+  }
+
+  TEST(ConcurrentTransferTest, Cancellation)
+  {
+    Azure::Core::Context context;
+    auto cancelledContext = context.WithDeadline(std::chrono::system_clock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::atomic<int> numCalls{0};
+    EXPECT_THROW(
+        Details::ConcurrentTransfer(
+            cancelledContext,
+            0,
+            1000,
+            1,
+            4,
+            [&](Azure::Core::Context&, int64_t, int64_t, int64_t, int64_t) {
+              numCalls.fetch_add(1);
+            }),
+        std::runtime_error);
+    EXPECT_EQ(numCalls.load(), 0);
+  }
+
+  TEST(ConcurrentTransferTest, RetriesTransientFailures)
+  {
+    std::vector<std::atomic<int>> numAttempts(4);
+    Details::ConcurrentTransfer(
+        Azure::Core::Context(),
+        0,
+        4,
+        1,
+        2,
+        [&](Azure::Core::Context&, int64_t, int64_t, int64_t chunkId, int64_t) {
+          int attempt = numAttempts[static_cast<std::size_t>(chunkId)]++;
+          if (chunkId == 1 && attempt == 0)
+          {
+            throw Azure::Core::Http::TransportException();
+          }
+          if (chunkId == 2 && attempt == 0)
+          {
+            StorageError e("server busy");
+            e.StatusCode = Azure::Core::Http::HttpStatusCode::ServiceUnavailable;
+            throw e;
+          }
+        });
+    EXPECT_EQ(numAttempts[0].load(), 1);
+    EXPECT_EQ(numAttempts[1].load(), 2);
+    EXPECT_EQ(numAttempts[2].load(), 2);
+    EXPECT_EQ(numAttempts[3].load(), 1);
+
+    // Other errors aren't retried.
+    std::atomic<int> numCalls{0};
+    EXPECT_THROW(
+        Details::ConcurrentTransfer(
+            Azure::Core::Context(),
+            0,
+            1,
+            1,
+            1,
+            [&](Azure::Core::Context&, int64_t, int64_t, int64_t, int64_t) {
+              ++numCalls;
+              StorageError e("condition not met");
+              e.StatusCode = Azure::Core::Http::HttpStatusCode::PreconditionFailed;
+              throw e;
+            }),
+        StorageError);
+    EXPECT_EQ(numCalls.load(), 1);
+  }
+
+  TEST(ConcurrentTransferTest, FailureCancelsChunksInFlight)
+  {
+    std::atomic<bool> otherChunkStarted{false};
+    std::atomic<bool> otherChunkCancelled{false};
+    auto waitFor = [](const std::function<bool()>& condition) {
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (!condition() && std::chrono::steady_clock::now() < deadline)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    };
+    try
+    {
+      Details::ConcurrentTransfer(
+          Azure::Core::Context(),
+          0,
+          2,
+          1,
+          2,
+          [&](Azure::Core::Context& context, int64_t, int64_t, int64_t chunkId, int64_t) {
+            if (chunkId == 0)
+            {
+              waitFor([&]() { return otherChunkStarted.load(); });
+              throw std::runtime_error("chunk 0 failed");
+            }
+            otherChunkStarted = true;
+            waitFor([&]() { return context.CancelWhen() < std::chrono::system_clock::now(); });
+            otherChunkCancelled = context.CancelWhen() < std::chrono::system_clock::now();
+          });
+      FAIL();
+    }
+    catch (std::runtime_error& e)
+    {
+      EXPECT_EQ(std::string(e.what()), "chunk 0 failed");
+    }
+    EXPECT_TRUE(otherChunkCancelled.load());
+  }
+
+  TEST(ConcurrentTransferTest, FailureCancelsBodyStreamReads)
+  {
+    // The other chunk is in the middle of reading a body when the transfer fails, the read has to
+    // throw rather than take down the process.
+    const std::vector<uint8_t> content(1024 * 1024);
+    std::atomic<bool> otherChunkReading{false};
+    std::string otherChunkError;
+    try
+    {
+      Details::ConcurrentTransfer(
+          Azure::Core::Context(),
+          0,
+          2,
+          1,
+          2,
+          [&](Azure::Core::Context& context, int64_t, int64_t, int64_t chunkId, int64_t) {
+            if (chunkId == 0)
+            {
+              auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+              while (!otherChunkReading.load() && std::chrono::steady_clock::now() < deadline)
+              {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+              }
+              throw std::runtime_error("chunk 0 failed");
+            }
+            Azure::Core::Http::MemoryBodyStream stream(content);
+            uint8_t buffer[16];
+            try
+            {
+              while (true)
+              {
+                if (stream.Read(context, buffer, sizeof(buffer)) == 0)
+                {
+                  stream.Rewind();
+                }
+                otherChunkReading = true;
+              }
+            }
+            catch (std::runtime_error& e)
+            {
+              otherChunkError = e.what();
+              throw;
+            }
+          });
+      FAIL();
+    }
+    catch (std::runtime_error& e)
+    {
+      EXPECT_EQ(std::string(e.what()), "chunk 0 failed");
+    }
+    EXPECT_EQ(otherChunkError, "the operation was cancelled");
+  }
+
+  TEST(ConcurrentTransferTest, ThreadsAreReused)
+  {
+    auto& threadPool = Details::WorkStealingThreadPool::GetDefault();
+    std::vector<std::future<void>> transfers;
+    for (int i = 0; i < 64; ++i)
+    {
+      transfers.emplace_back(std::async(std::launch::async, []() {
+        Details::ConcurrentTransfer(
+            Azure::Core::Context(),
+            0,
+            64,
+            1,
+            8,
+            [](Azure::Core::Context&, int64_t, int64_t, int64_t, int64_t) {
+              std::this_thread::sleep_for(std::chrono::microseconds(100));
+            });
+      }));
+    }
+    for (auto& transfer : transfers)
+    {
+      transfer.get();
+    }
+    EXPECT_LE(threadPool.GetThreadCount(), threadPool.GetMaximumThreads());
+  }
+
+  TEST(ConcurrentTransferTest, Streaming)
+  {
+    for (int concurrency : {1, 3})
+    {
+      for (std::size_t length : {0, 1, 1024, 1025, 100000})
+      {
+        std::vector<uint8_t> data = RandomBuffer(length);
+        std::vector<uint8_t> received(length);
+        TrickleBodyStream stream(data);
+        std::atomic<int> inFlight{0};
+        std::atomic<int> maxInFlight{0};
+        int64_t numChunks = Details::StreamingConcurrentTransfer(
+            Azure::Core::Context(),
+            stream,
+            1024,
+            concurrency,
+            1000,
+            [&](Azure::Core::Context&,
+                const uint8_t* chunk,
+                int64_t chunkLength,
+                int64_t chunkId) {
+              int current = ++inFlight;
+              int previous = maxInFlight.load();
+              while (previous < current && !maxInFlight.compare_exchange_weak(previous, current))
+              {
+              }
+              // Every chunk is full except the last one.
+              EXPECT_TRUE(
+                  chunkLength == 1024
+                  || static_cast<std::size_t>(chunkId * 1024 + chunkLength) == length);
+              std::copy(chunk, chunk + chunkLength, received.begin() + chunkId * 1024);
+              std::this_thread::sleep_for(std::chrono::microseconds(200));
+              --inFlight;
+            });
+        EXPECT_EQ(numChunks, static_cast<int64_t>((length + 1023) / 1024));
+        EXPECT_EQ(received, data);
+        EXPECT_LE(maxInFlight.load(), concurrency);
+      }
+    }
+
+    std::vector<uint8_t> data = RandomBuffer(100000);
+    {
+      TrickleBodyStream stream(data);
+      std::atomic<int> numCalls{0};
+      EXPECT_THROW(
+          Details::StreamingConcurrentTransfer(
+              Azure::Core::Context(),
+              stream,
+              100,
+              4,
+              10000,
+              [&](Azure::Core::Context&, const uint8_t*, int64_t, int64_t chunkId) {
+                numCalls.fetch_add(1);
+                if (chunkId == 10)
+                {
+                  throw std::runtime_error("chunk failed");
+                }
+              }),
+          std::runtime_error);
+      EXPECT_LT(numCalls.load(), 1000);
+    }
+    {
+      TrickleBodyStream stream(data);
+      EXPECT_THROW(
+          Details::StreamingConcurrentTransfer(
+              Azure::Core::Context(),
+              stream,
+              1000,
+              2,
+              99,
+              [](Azure::Core::Context&, const uint8_t*, int64_t, int64_t) {}),
+          std::runtime_error);
+    }
+  }
+
+  TEST(ThreadPoolTest, WorkStealing)
+  {
+    std::mutex mutex;
+    std::vector<std::thread::id> threadIds;
+    std::atomic<int> remaining{100};
+    std::promise<void> done;
+    Details::WorkStealingThreadPool threadPool(4);
+    for (int i = 0; i < 100; ++i)
+    {
+      threadPool.Submit([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        {
+          std::lock_guard<std::mutex> guard(mutex);
+          threadIds.emplace_back(std::this_thread::get_id());
+        }
+        if (remaining.fetch_sub(1) == 1)
+        {
+          done.set_value();
+        }
+      });
+    }
+    done.get_future().wait();
+    EXPECT_LE(threadPool.GetThreadCount(), std::size_t(4));
+    EXPECT_EQ(threadIds.size(), std::size_t(100));
+  }
+
+}}} // namespace Azure::Storage::Test
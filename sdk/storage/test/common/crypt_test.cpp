@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/crypt.hpp"
+#include "test_base.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  namespace {
+    std::vector<uint8_t> PatternBuffer(std::size_t length)
+    {
+      std::vector<uint8_t> buffer(length);
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        buffer[i] = static_cast<uint8_t>(i * 31 + 7);
+      }
+      return buffer;
+    }
+
+    std::string Crc64Of(const uint8_t* data, std::size_t length)
+    {
+      Crc64 crc64;
+      crc64.Update(data, length);
+      return crc64.Digest();
+    }
+  } // namespace
+
+  TEST(CryptTest, Crc64)
+  {
+    EXPECT_EQ(Base64Encode(CRC64("")), "AAAAAAAAAAA=");
+    EXPECT_EQ(Base64Encode(CRC64("a")), "PPzLtEWEL4w=");
+    EXPECT_EQ(Base64Encode(CRC64("123456789")), "iJh5CoYUi64=");
+
+    // Long enough for the carry-less multiplication path.
+    auto buffer = PatternBuffer(1000);
+    EXPECT_EQ(Base64Encode(Crc64Of(buffer.data(), buffer.size())), "Tm6MwRSqm4Q=");
+
+    // Every split point and length must agree with the byte at a time table lookup.
+    buffer = RandomBuffer(300);
+    for (std::size_t length = 0; length <= buffer.size(); length += 7)
+    {
+      std::string expected;
+      {
+        Crc64 crc64;
+        for (std::size_t i = 0; i < length; ++i)
+        {
+          crc64.Update(&buffer[i], 1);
+        }
+        expected = crc64.Digest();
+      }
+      EXPECT_EQ(Crc64Of(buffer.data(), length), expected);
+    }
+  }
+
+  TEST(CryptTest, Crc64Concatenate)
+  {
+    auto buffer = RandomBuffer(static_cast<std::size_t>(1_MB + 17));
+    std::string expected = Crc64Of(buffer.data(), buffer.size());
+
+    for (std::size_t chunkSize : {std::size_t(1000), std::size_t(4099), std::size_t(256_KB)})
+    {
+      Crc64 combined;
+      for (std::size_t offset = 0; offset < buffer.size(); offset += chunkSize)
+      {
+        Crc64 chunk;
+        chunk.Update(&buffer[offset], std::min(chunkSize, buffer.size() - offset));
+        combined.Concatenate(chunk);
+      }
+      EXPECT_EQ(combined.Digest(), expected);
+
+      // Concatenating empty checksums changes nothing.
+      combined.Concatenate(Crc64());
+      EXPECT_EQ(combined.Digest(), expected);
+    }
+  }
+
+  TEST(CryptTest, Md5)
+  {
+    EXPECT_EQ(Base64Encode(MD5("")), "1B2M2Y8AsgTpgAmY7PhCfg==");
+    EXPECT_EQ(Base64Encode(MD5("abc")), "kAFQmDzST7DWlj99KOF/cg==");
+
+    auto buffer = PatternBuffer(1000);
+    Md5 md5;
+    md5.Update(buffer.data(), 1);
+    md5.Update(buffer.data() + 1, 500);
+    md5.Update(buffer.data() + 501, 499);
+    EXPECT_EQ(Base64Encode(md5.Digest()), "Kx541XZd6eEElaAUEqHPIg==");
+  }
+
+  TEST(CryptTest, Sha256)
+  {
+    Sha256 sha256;
+    sha256.Update(reinterpret_cast<const uint8_t*>("ab"), 2);
+    sha256.Update(reinterpret_cast<const uint8_t*>("c"), 1);
+    EXPECT_EQ(Base64Encode(sha256.Digest()), "ungWv48Bz+pBQUDeXa4iI7ADYaOWF3qctBD/YfIAFa0=");
+  }
+
+  TEST(CryptTest, HmacSha256)
+  {
+    HmacSha256 hmac(std::string(20, '\x0b'));
+    EXPECT_EQ(Base64Encode(hmac.Sign("Hi There")), "sDRMYdjbOFNcqK/OrwvxK4gdwgDJgz2nJuk3bC4yz/c=");
+    // Signing doesn't consume the key schedule.
+    EXPECT_EQ(Base64Encode(hmac.Sign("Hi There")), "sDRMYdjbOFNcqK/OrwvxK4gdwgDJgz2nJuk3bC4yz/c=");
+
+    // Keys longer than a block are hashed first.
+    const std::string longKey(131, '\xaa');
+    const std::string text = "Test Using Larger Than Block-Size Key - Hash Key First";
+    EXPECT_EQ(
+        Base64Encode(HmacSha256(longKey).Sign(text)),
+        "YOQxWR7gtn8Niiaqy/W3f44LxiE3KMUUBUYEDw7jf1Q=");
+    EXPECT_EQ(HmacSha256(longKey).Sign(text), HMAC_SHA256(text, longKey));
+  }
+
+}}} // namespace Azure::Storage::Test
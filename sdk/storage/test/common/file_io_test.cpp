@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/buffer_pool.hpp"
+#include "common/file_io.hpp"
+#include "test_base.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  TEST(FileIoEngineTest, BatchedReadsAndWrites)
+  {
+    const std::string filename = "file_io_engine_test_" + RandomString();
+    const int64_t bufferSize = 16_KB;
+    const int numBuffers = 100;
+    std::vector<uint8_t> expected = RandomBuffer(static_cast<std::size_t>(bufferSize * numBuffers));
+
+    Details::AlignedBufferPool pool(bufferSize, numBuffers);
+    std::vector<uint8_t*> buffers = pool.AllocateAll();
+    ASSERT_EQ(buffers.size(), static_cast<std::size_t>(numBuffers));
+
+    Details::FileIoEngine engine(8);
+    std::vector<std::pair<uint8_t*, int64_t>> registration;
+    for (auto buffer : buffers)
+    {
+      registration.emplace_back(buffer, bufferSize);
+    }
+    bool registered = engine.RegisterBuffers(registration);
+    EXPECT_TRUE(!registered || engine.IsIoUring());
+
+    {
+      Details::FileWriter fileWriter(filename);
+      std::vector<Details::FileIoRequest> requests;
+      // More requests than the queue depth, in reverse order.
+      for (int i = numBuffers - 1; i >= 0; --i)
+      {
+        std::memcpy(
+            buffers[i], expected.data() + i * bufferSize, static_cast<std::size_t>(bufferSize));
+        Details::FileIoRequest request;
+        request.IsWrite = true;
+        request.Handle = fileWriter.GetHandle();
+        request.Buffer = buffers[i];
+        request.Length = bufferSize;
+        request.Offset = i * bufferSize;
+        request.BufferIndex = registered ? i : -1;
+        requests.emplace_back(request);
+      }
+      engine.Run(requests);
+      for (const auto& request : requests)
+      {
+        EXPECT_EQ(request.BytesTransferred, bufferSize);
+      }
+    }
+    EXPECT_EQ(ReadFile(filename), expected);
+
+    {
+      Details::FileReader fileReader(filename);
+      std::vector<Details::FileIoRequest> requests;
+      for (int i = 0; i < numBuffers; ++i)
+      {
+        std::memset(buffers[i], 0, static_cast<std::size_t>(bufferSize));
+        Details::FileIoRequest request;
+        request.Handle = fileReader.GetHandle();
+        request.Buffer = buffers[i];
+        request.Length = bufferSize;
+        // The last read starts half a buffer before the end of the file.
+        request.Offset = i == numBuffers - 1 ? i * bufferSize + bufferSize / 2 : i * bufferSize;
+        request.BufferIndex = registered ? i : -1;
+        requests.emplace_back(request);
+      }
+      engine.Run(requests);
+      for (int i = 0; i < numBuffers - 1; ++i)
+      {
+        EXPECT_EQ(requests[i].BytesTransferred, bufferSize);
+        EXPECT_EQ(
+            std::memcmp(
+                buffers[i],
+                expected.data() + i * bufferSize,
+                static_cast<std::size_t>(bufferSize)),
+            0);
+      }
+      const auto& lastRequest = requests.back();
+      EXPECT_EQ(lastRequest.BytesTransferred, bufferSize / 2);
+      EXPECT_EQ(
+          std::memcmp(
+              lastRequest.Buffer,
+              expected.data() + lastRequest.Offset,
+              static_cast<std::size_t>(bufferSize / 2)),
+          0);
+    }
+    DeleteFile(filename);
+  }
+
+  TEST(FileWriterTest, DirectIoPreallocateAndDropCache)
+  {
+    const std::string filename = "file_writer_test_" + RandomString();
+    const int64_t bufferSize = 64_KB;
+    const int numBuffers = 8;
+    // Ends with a partial buffer, which can't bypass the page cache.
+    const int64_t fileSize = bufferSize * numBuffers - 100;
+    std::vector<uint8_t> expected = RandomBuffer(static_cast<std::size_t>(fileSize));
+    {
+      Details::FileWriter fileWriter(filename, true);
+      fileWriter.Preallocate(fileSize);
+
+      Details::AlignedBufferPool pool(bufferSize, 2);
+      Details::FileWriteStage writeStage(fileWriter, &pool, true);
+      Azure::Core::Context context;
+      for (int i = 0; i < numBuffers; ++i)
+      {
+        auto buffer = pool.Acquire(context);
+        int64_t length = std::min(bufferSize, fileSize - i * bufferSize);
+        std::memcpy(
+            buffer.Data(), expected.data() + i * bufferSize, static_cast<std::size_t>(length));
+        if (fileWriter.IsDirectIo())
+        {
+          EXPECT_EQ(
+              fileWriter.GetHandle(buffer.Data(), length, i * bufferSize) != fileWriter.GetHandle(),
+              length == bufferSize);
+        }
+        writeStage.Write(std::move(buffer), length, i * bufferSize);
+      }
+      writeStage.Flush();
+
+      // Unaligned writes outside of the stage fall back to the page cache as well.
+      fileWriter.Write(expected.data() + 1, 10, 1);
+    }
+    EXPECT_EQ(ReadFile(filename), expected);
+    DeleteFile(filename);
+  }
+
+  TEST(MemoryMappedFileTest, MapsWholeFile)
+  {
+    const std::string filename = "memory_mapped_file_test_" + RandomString();
+    std::vector<uint8_t> expected = RandomBuffer(static_cast<std::size_t>(1_MB + 123));
+    {
+      Details::FileWriter fileWriter(filename);
+      fileWriter.Write(expected.data(), static_cast<int64_t>(expected.size()), 0);
+    }
+    {
+      Details::FileReader fileReader(filename);
+      Details::MemoryMappedFile mappedFile(fileReader);
+      ASSERT_EQ(mappedFile.Size(), static_cast<int64_t>(expected.size()));
+      EXPECT_EQ(std::memcmp(mappedFile.Data(), expected.data(), expected.size()), 0);
+    }
+    DeleteFile(filename);
+
+    {
+      Details::FileWriter fileWriter(filename);
+    }
+    {
+      Details::FileReader fileReader(filename);
+      EXPECT_THROW(Details::MemoryMappedFile mappedFile(fileReader), std::runtime_error);
+    }
+    DeleteFile(filename);
+  }
+
+}}} // namespace Azure::Storage::Test
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/hashing_body_stream.hpp"
+#include "test_base.hpp"
+
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  namespace {
+    std::string Sha256Of(const std::vector<uint8_t>& buffer)
+    {
+      Sha256 sha256;
+      sha256.Update(buffer.data(), buffer.size());
+      return sha256.Digest();
+    }
+
+    void ReadToEnd(Azure::Core::Http::BodyStream& stream, int64_t chunkSize)
+    {
+      Azure::Core::Context context;
+      std::vector<uint8_t> buffer(static_cast<std::size_t>(chunkSize));
+      while (stream.Read(context, buffer.data(), chunkSize) != 0)
+      {
+      }
+    }
+  } // namespace
+
+  TEST(HashingBodyStreamTest, HashesWhileReading)
+  {
+    std::vector<uint8_t> content = RandomBuffer(static_cast<std::size_t>(1_MB + 5));
+    const std::string contentString(content.begin(), content.end());
+
+    Azure::Core::Http::MemoryBodyStream memoryStream(content);
+    HashingBodyStream stream(&memoryStream, true, true, true);
+    EXPECT_EQ(stream.Length(), static_cast<int64_t>(content.size()));
+    EXPECT_THROW(stream.GetMd5(), std::runtime_error);
+
+    // A retry rewinds after a partial read, the hashes must only cover the last attempt.
+    Azure::Core::Context context;
+    std::vector<uint8_t> buffer(static_cast<std::size_t>(100_KB));
+    stream.Read(context, buffer.data(), static_cast<int64_t>(buffer.size()));
+    stream.Rewind();
+    ReadToEnd(stream, 100_KB);
+
+    ASSERT_TRUE(stream.IsComplete());
+    EXPECT_EQ(stream.GetMd5(), MD5(contentString));
+    EXPECT_EQ(stream.GetCrc64(), CRC64(contentString));
+    EXPECT_EQ(stream.GetSha256(), Sha256Of(content));
+    EXPECT_NO_THROW(stream.Verify(
+        Base64Encode(MD5(contentString)), Azure::Core::Nullable<std::string>()));
+    EXPECT_THROW(
+        stream.Verify(Azure::Core::Nullable<std::string>(), Base64Encode(CRC64("x"))),
+        std::runtime_error);
+
+    // Contiguous reads are hashed too, and completing doesn't need the read that returns 0.
+    stream.Rewind();
+    int64_t offset = 0;
+    while (offset < stream.Length())
+    {
+      int64_t bytesRead = 0;
+      ASSERT_NE(stream.ReadContiguous(context, 300_KB, &bytesRead), nullptr);
+      offset += bytesRead;
+    }
+    ASSERT_TRUE(stream.IsComplete());
+    EXPECT_EQ(stream.GetCrc64(), CRC64(contentString));
+    EXPECT_THROW(HashingBodyStream(&memoryStream, false, true).GetMd5(), std::runtime_error);
+  }
+
+  TEST(HashingBodyStreamTest, VerifyOnCompletion)
+  {
+    std::vector<uint8_t> content = RandomBuffer(static_cast<std::size_t>(10_KB));
+    const std::string contentString(content.begin(), content.end());
+
+    auto stream = std::make_unique<HashingBodyStream>(
+        std::make_unique<Azure::Core::Http::MemoryBodyStream>(content), true, true);
+    stream->VerifyOnCompletion(
+        Base64Encode(MD5(contentString)), Base64Encode(CRC64(contentString)));
+    EXPECT_NO_THROW(ReadToEnd(*stream, 1_KB));
+
+    stream = std::make_unique<HashingBodyStream>(
+        std::make_unique<Azure::Core::Http::MemoryBodyStream>(content), true, true);
+    stream->VerifyOnCompletion(
+        Azure::Core::Nullable<std::string>(), Base64Encode(CRC64(contentString + "x")));
+    EXPECT_THROW(ReadToEnd(*stream, 1_KB), std::runtime_error);
+
+    // Empty bodies are never read by the transport.
+    stream = std::make_unique<HashingBodyStream>(
+        std::make_unique<Azure::Core::Http::MemoryBodyStream>(nullptr, 0), true, true);
+    EXPECT_TRUE(stream->IsComplete());
+    EXPECT_EQ(stream->GetMd5(), MD5(""));
+    EXPECT_THROW(
+        stream->VerifyOnCompletion(Base64Encode(MD5("x")), Azure::Core::Nullable<std::string>()),
+        std::runtime_error);
+  }
+
+}}} // namespace Azure::Storage::Test
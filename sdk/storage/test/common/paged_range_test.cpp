@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/paged_range.hpp"
+#include "common/xml_wrapper.hpp"
+#include "test_base.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  namespace {
+    // Pages of pageSize numbers from 0 to numItems, the marker of a page is its first number.
+    // An endless XML document, <Items><Item/><Item/>..., read through MemoryBodyStream as a
+    // response body would be.
+    class EndlessXmlBodyStream : public Azure::Core::Http::BodyStream {
+    public:
+      int64_t Length() const override { return -1; }
+
+      int64_t Read(Azure::Core::Context& context, uint8_t* buffer, int64_t count) override
+      {
+        int64_t bytesRead = m_stream.Read(context, buffer, count);
+        if (bytesRead == 0)
+        {
+          m_stream = Azure::Core::Http::MemoryBodyStream(
+              reinterpret_cast<const uint8_t*>(c_items), std::strlen(c_items));
+          bytesRead = m_stream.Read(context, buffer, count);
+        }
+        return bytesRead;
+      }
+
+    private:
+      static constexpr const char* c_start = "<Items>";
+      static constexpr const char* c_items = "<Item/><Item/><Item/><Item/>";
+      Azure::Core::Http::MemoryBodyStream m_stream{
+          reinterpret_cast<const uint8_t*>(c_start),
+          std::strlen(c_start)};
+    };
+
+    std::vector<int> FetchNumbers(
+        const std::string& marker,
+        std::string& nextMarker,
+        int numItems,
+        int pageSize)
+    {
+      int first = marker.empty() ? 0 : std::stoi(marker);
+      std::vector<int> page;
+      for (int i = first; i < std::min(first + pageSize, numItems); ++i)
+      {
+        page.emplace_back(i);
+      }
+      nextMarker = first + pageSize < numItems ? std::to_string(first + pageSize) : std::string();
+      return page;
+    }
+  } // namespace
+
+  TEST(PagedRangeTest, WalksAllItems)
+  {
+    for (int prefetchDepth : {0, 1, 4})
+    {
+      for (int numItems : {0, 1, 10, 11})
+      {
+        std::atomic<int> numFetches{0};
+        PagedRange<int> range(
+            Azure::Core::Context(),
+            "",
+            prefetchDepth,
+            [&](Azure::Core::Context&, const std::string& marker, std::string& nextMarker) {
+              ++numFetches;
+              return FetchNumbers(marker, nextMarker, numItems, 5);
+            });
+        std::vector<int> items;
+        for (int item : range)
+        {
+          items.emplace_back(item);
+        }
+        std::vector<int> expected;
+        for (int i = 0; i < numItems; ++i)
+        {
+          expected.emplace_back(i);
+        }
+        EXPECT_EQ(items, expected);
+        EXPECT_EQ(numFetches.load(), std::max((numItems + 4) / 5, 1));
+        EXPECT_TRUE(range.GetNextMarker().empty());
+      }
+    }
+
+    PagedRange<int> range(
+        Azure::Core::Context(),
+        "3",
+        1,
+        [](Azure::Core::Context&, const std::string& marker, std::string& nextMarker) {
+          return FetchNumbers(marker, nextMarker, 10, 3);
+        });
+    std::vector<int> page;
+    ASSERT_TRUE(range.NextPage(page));
+    EXPECT_EQ(page, std::vector<int>({3, 4, 5}));
+    EXPECT_EQ(range.GetNextMarker(), "6");
+  }
+
+  TEST(PagedRangeTest, Prefetches)
+  {
+    std::atomic<int> numFetches{0};
+    PagedRange<int> range(
+        Azure::Core::Context(),
+        "",
+        2,
+        [&](Azure::Core::Context&, const std::string& marker, std::string& nextMarker) {
+          ++numFetches;
+          return FetchNumbers(marker, nextMarker, 100, 1);
+        });
+    // The first pages are fetched before anybody asks for them, but no more than the depth.
+    for (int i = 0; i < 1000 && numFetches.load() < 2; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(numFetches.load(), 2);
+
+    std::vector<int> page;
+    ASSERT_TRUE(range.NextPage(page));
+    for (int i = 0; i < 1000 && numFetches.load() < 3; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(numFetches.load(), 3);
+  }
+
+  TEST(PagedRangeTest, Failures)
+  {
+    PagedRange<int> range(
+        Azure::Core::Context(),
+        "",
+        3,
+        [](Azure::Core::Context&, const std::string& marker, std::string& nextMarker) {
+          if (marker == "2")
+          {
+            throw std::runtime_error("page failed");
+          }
+          return FetchNumbers(marker, nextMarker, 100, 1);
+        });
+    std::vector<int> page;
+    EXPECT_TRUE(range.NextPage(page));
+    EXPECT_TRUE(range.NextPage(page));
+    EXPECT_THROW(range.NextPage(page), std::runtime_error);
+    EXPECT_THROW(range.NextPage(page), std::runtime_error);
+
+    // A fetch in flight is cancelled when the range goes away.
+    std::atomic<bool> cancelled{false};
+    {
+      PagedRange<int> slowRange(
+          Azure::Core::Context(),
+          "",
+          1,
+          [&](Azure::Core::Context& context, const std::string&, std::string&) {
+            while (context.CancelWhen() >= std::chrono::system_clock::now())
+            {
+              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            cancelled = true;
+            return std::vector<int>();
+          });
+    }
+    EXPECT_TRUE(cancelled.load());
+  }
+
+  TEST(PagedRangeTest, CancelsPageBeingParsed)
+  {
+    // Leaving the range while the prefetch of the next page is parsing its response makes the
+    // read of the body throw, which the parser hands on.
+    std::atomic<bool> parsing{false};
+    std::string error;
+    {
+      PagedRange<int> range(
+          Azure::Core::Context(),
+          "",
+          1,
+          [&](Azure::Core::Context& context, const std::string& marker, std::string& nextMarker) {
+            if (marker.empty())
+            {
+              nextMarker = "1";
+              return std::vector<int>{0};
+            }
+            EndlessXmlBodyStream stream;
+            XmlReader reader(context, stream);
+            try
+            {
+              while (reader.Read().Type != XmlNodeType::End)
+              {
+                parsing = true;
+              }
+            }
+            catch (std::runtime_error& e)
+            {
+              error = e.what();
+              throw;
+            }
+            return std::vector<int>();
+          });
+      for (int item : range)
+      {
+        EXPECT_EQ(item, 0);
+        for (int i = 0; i < 10000 && !parsing.load(); ++i)
+        {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        break;
+      }
+    }
+    EXPECT_TRUE(parsing.load());
+    EXPECT_EQ(error, "the operation was cancelled");
+  }
+
+}}} // namespace Azure::Storage::Test
@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/read_ahead_body_stream.hpp"
+#include "test_base.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  TEST(ReadAheadBodyStreamTest, ReadsInOrder)
+  {
+    const std::vector<uint8_t> content = RandomBuffer(static_cast<std::size_t>(1_MB + 123));
+    const int concurrency = 3;
+    std::atomic<int> inFlight(0);
+    std::atomic<int> maxInFlight(0);
+    auto fetchFunc = [&](Azure::Core::Context&, int64_t offset, int64_t length, uint8_t* buffer) {
+      int current = ++inFlight;
+      int previous = maxInFlight.load();
+      while (current > previous && !maxInFlight.compare_exchange_weak(previous, current))
+      {
+      }
+      // Later chunks finishing first mustn't change the order bytes are delivered in.
+      std::this_thread::sleep_for(std::chrono::milliseconds(offset % 3));
+      std::memcpy(buffer, content.data() + offset, static_cast<std::size_t>(length));
+      --inFlight;
+    };
+
+    const int64_t offset = 100;
+    const int64_t length = static_cast<int64_t>(content.size()) - offset - 10;
+    Details::ReadAheadBodyStream stream(
+        Azure::Core::Context(), offset, length, 64_KB, concurrency, fetchFunc);
+    EXPECT_EQ(stream.Length(), length);
+
+    for (int i = 0; i < 2; ++i)
+    {
+      Azure::Core::Context context;
+      std::vector<uint8_t> result;
+      std::vector<uint8_t> buffer(static_cast<std::size_t>(10_KB + 7));
+      int64_t bytesRead;
+      while ((bytesRead
+              = stream.Read(context, buffer.data(), static_cast<int64_t>(buffer.size())))
+             != 0)
+      {
+        result.insert(result.end(), buffer.begin(), buffer.begin() + bytesRead);
+      }
+      EXPECT_EQ(
+          result,
+          std::vector<uint8_t>(content.begin() + offset, content.begin() + offset + length));
+      stream.Rewind();
+    }
+    EXPECT_LE(maxInFlight.load(), concurrency);
+  }
+
+  TEST(ReadAheadBodyStreamTest, FetchFailure)
+  {
+    auto fetchFunc = [](Azure::Core::Context&, int64_t offset, int64_t length, uint8_t* buffer) {
+      if (offset == static_cast<int64_t>(2_KB))
+      {
+        throw std::runtime_error("fetch failed");
+      }
+      std::fill(buffer, buffer + length, uint8_t(1));
+    };
+    Details::ReadAheadBodyStream stream(Azure::Core::Context(), 0, 4_KB, 1_KB, 2, fetchFunc);
+
+    Azure::Core::Context context;
+    std::vector<uint8_t> buffer(static_cast<std::size_t>(4_KB));
+    EXPECT_EQ(
+        Azure::Core::Http::BodyStream::ReadToCount(context, stream, buffer.data(), 2_KB),
+        static_cast<int64_t>(2_KB));
+    EXPECT_THROW(stream.Read(context, buffer.data(), 1_KB), std::runtime_error);
+    EXPECT_THROW(stream.Read(context, buffer.data(), 1_KB), std::runtime_error);
+  }
+
+  TEST(ReadAheadBodyStreamTest, CancelledOnDestruction)
+  {
+    std::atomic<int> cancelledFetches(0);
+    auto fetchFunc = [&](Azure::Core::Context& context, int64_t, int64_t, uint8_t*) {
+      while (context.CancelWhen() >= std::chrono::system_clock::now())
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      ++cancelledFetches;
+      throw std::runtime_error("the operation was cancelled");
+    };
+    {
+      Details::ReadAheadBodyStream stream(Azure::Core::Context(), 0, 4_KB, 1_KB, 2, fetchFunc);
+    }
+    // The destructor waits for the fetches in flight.
+    EXPECT_EQ(cancelledFetches.load(), 2);
+  }
+
+  TEST(ReadAheadBodyStreamTest, CancelsBodyReadsInFlight)
+  {
+    // Fetches that are reading a response body when the stream is rewound or destroyed see the
+    // read fail, they don't get to finish.
+    const std::vector<uint8_t> body(static_cast<std::size_t>(64_KB));
+    std::atomic<int> readingFetches(0);
+    std::mutex mutex;
+    std::vector<std::string> errors;
+    auto fetchFunc = [&](Azure::Core::Context& context, int64_t, int64_t, uint8_t* buffer) {
+      Azure::Core::Http::MemoryBodyStream stream(body);
+      ++readingFetches;
+      try
+      {
+        while (true)
+        {
+          if (stream.Read(context, buffer, 1) == 0)
+          {
+            stream.Rewind();
+          }
+        }
+      }
+      catch (std::runtime_error& e)
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        errors.emplace_back(e.what());
+        throw;
+      }
+    };
+    auto waitForReadingFetches = [&](int numFetches) {
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (readingFetches.load() < numFetches && std::chrono::steady_clock::now() < deadline)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    };
+    {
+      Details::ReadAheadBodyStream stream(Azure::Core::Context(), 0, 4_KB, 1_KB, 2, fetchFunc);
+      waitForReadingFetches(2);
+      stream.Rewind();
+      EXPECT_EQ(errors.size(), 2U);
+      waitForReadingFetches(4);
+    }
+    EXPECT_EQ(errors, std::vector<std::string>(4, "the operation was cancelled"));
+  }
+
+}}} // namespace Azure::Storage::Test
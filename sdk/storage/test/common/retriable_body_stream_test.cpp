@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/retriable_body_stream.hpp"
+#include "http/http.hpp"
+#include "test_base.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  namespace {
+    // Serves content from offset on and fails after failAfter bytes, by throwing or by ending
+    // early.
+    class FlakyBodyStream : public Azure::Core::Http::BodyStream {
+    public:
+      FlakyBodyStream(
+          const std::vector<uint8_t>& content,
+          int64_t offset,
+          int64_t failAfter,
+          bool throwOnFailure)
+          : m_content(content), m_offset(offset), m_failAfter(failAfter),
+            m_throwOnFailure(throwOnFailure)
+      {
+      }
+
+      int64_t Length() const override
+      {
+        return static_cast<int64_t>(m_content.size()) - m_offset;
+      }
+
+      void Rewind() override { throw std::runtime_error("not supported"); }
+
+      int64_t Read(Azure::Core::Context&, uint8_t* buffer, int64_t count) override
+      {
+        int64_t available = std::min(
+            static_cast<int64_t>(m_content.size()) - m_offset - m_bytesRead,
+            m_failAfter - m_bytesRead);
+        if (available <= 0 && m_bytesRead == m_failAfter && m_throwOnFailure)
+        {
+          throw Azure::Core::Http::TransportException();
+        }
+        int64_t bytesRead = std::max(std::min(count, available), int64_t(0));
+        std::copy(
+            m_content.begin() + static_cast<std::ptrdiff_t>(m_offset + m_bytesRead),
+            m_content.begin() + static_cast<std::ptrdiff_t>(m_offset + m_bytesRead + bytesRead),
+            buffer);
+        m_bytesRead += bytesRead;
+        return bytesRead;
+      }
+
+    private:
+      const std::vector<uint8_t>& m_content;
+      int64_t m_offset;
+      int64_t m_failAfter;
+      bool m_throwOnFailure;
+      int64_t m_bytesRead = 0;
+    };
+  } // namespace
+
+  TEST(RetriableBodyStreamTest, ResumesWhereItStopped)
+  {
+    const std::vector<uint8_t> content = RandomBuffer(static_cast<std::size_t>(100_KB));
+    for (bool throwOnFailure : {true, false})
+    {
+      std::vector<int64_t> reopenOffsets;
+      Details::RetriableBodyStream stream(
+          std::make_unique<FlakyBodyStream>(content, 0, 30_KB + 1, throwOnFailure),
+          [&](Azure::Core::Context&, int64_t offset) {
+            reopenOffsets.push_back(offset);
+            return std::make_unique<FlakyBodyStream>(content, offset, 30_KB, throwOnFailure);
+          },
+          5,
+          std::chrono::milliseconds(1));
+      EXPECT_EQ(stream.Length(), static_cast<int64_t>(content.size()));
+
+      Azure::Core::Context context;
+      EXPECT_EQ(Azure::Core::Http::BodyStream::ReadToEnd(context, stream), content);
+      EXPECT_EQ(
+          reopenOffsets,
+          std::vector<int64_t>({static_cast<int64_t>(30_KB + 1),
+                                static_cast<int64_t>(60_KB + 1),
+                                static_cast<int64_t>(90_KB + 1)}));
+    }
+  }
+
+  TEST(RetriableBodyStreamTest, GivesUp)
+  {
+    const std::vector<uint8_t> content = RandomBuffer(static_cast<std::size_t>(10_KB));
+    int numReopens = 0;
+    Details::RetriableBodyStream stream(
+        std::make_unique<FlakyBodyStream>(content, 0, 1_KB, true),
+        [&](Azure::Core::Context&, int64_t offset) {
+          ++numReopens;
+          return std::make_unique<FlakyBodyStream>(content, offset, 0, true);
+        },
+        3,
+        std::chrono::milliseconds(1));
+
+    Azure::Core::Context context;
+    std::vector<uint8_t> buffer(static_cast<std::size_t>(10_KB));
+    EXPECT_EQ(stream.Read(context, buffer.data(), 10_KB), static_cast<int64_t>(1_KB));
+    EXPECT_THROW(stream.Read(context, buffer.data(), 10_KB), Azure::Core::Http::TransportException);
+    EXPECT_EQ(numReopens, 3);
+
+    // Errors of the new requests themselves aren't retried.
+    Details::RetriableBodyStream failingStream(
+        std::make_unique<FlakyBodyStream>(content, 0, 0, true),
+        [](Azure::Core::Context&, int64_t) -> std::unique_ptr<Azure::Core::Http::BodyStream> {
+          throw std::runtime_error("412 Precondition Failed");
+        },
+        3,
+        std::chrono::milliseconds(1));
+    EXPECT_THROW(failingStream.Read(context, buffer.data(), 10_KB), std::runtime_error);
+  }
+
+  TEST(RetriableBodyStreamTest, CancelledDuringBackoff)
+  {
+    const std::vector<uint8_t> content = RandomBuffer(static_cast<std::size_t>(10_KB));
+    Details::RetriableBodyStream stream(
+        std::make_unique<FlakyBodyStream>(content, 0, 0, true),
+        [&](Azure::Core::Context&, int64_t offset) {
+          return std::make_unique<FlakyBodyStream>(content, offset, 0, true);
+        },
+        3,
+        std::chrono::seconds(20));
+
+    auto context = Azure::Core::Context().WithDeadline(
+        std::chrono::system_clock::now() + std::chrono::milliseconds(100));
+    std::vector<uint8_t> buffer(static_cast<std::size_t>(10_KB));
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(stream.Read(context, buffer.data(), 10_KB), std::runtime_error);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  }
+
+}}} // namespace Azure::Storage::Test
@@ -0,0 +1,231 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/concurrent_transfer.hpp"
+#include "common/transfer_auto_tuner.hpp"
+#include "test_base.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  namespace {
+    // Feeds one measurement window worth of chunks to tuner. throughputFunc returns bytes per
+    // second for a concurrency and chunk size, latencyFactor inflates the latency of each chunk.
+    void SimulateWindow(
+        Details::TransferAutoTuner& tuner,
+        std::chrono::steady_clock::time_point& now,
+        const std::function<double(int, int64_t)>& throughputFunc,
+        double latencyFactor = 1.0)
+    {
+      int concurrency = tuner.GetConcurrency();
+      int64_t chunkSize = tuner.GetChunkSize();
+      double throughput = throughputFunc(concurrency, chunkSize);
+      auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(static_cast<double>(chunkSize) / throughput));
+      for (int i = 0; i < std::max(concurrency * 2, 4); ++i)
+      {
+        now += interval;
+        tuner.OnChunkCompleted(
+            chunkSize,
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                interval * concurrency * latencyFactor),
+            now);
+      }
+    }
+  } // namespace
+
+  TEST(TransferAutoTunerTest, RampsUntilThroughputPlateaus)
+  {
+    // Bandwidth saturates at 8 parallel requests, chunk size doesn't matter.
+    auto throughputFunc
+        = [](int concurrency, int64_t) { return std::min(concurrency, 8) * 10.0 * 1_MB; };
+    auto now = std::chrono::steady_clock::now();
+    {
+      Details::TransferAutoTuner tuner("ramp.test/upload", 1_MB, 8_MB, 64);
+      EXPECT_EQ(tuner.GetConcurrency(), 2);
+      EXPECT_EQ(tuner.GetChunkSize(), static_cast<int64_t>(1_MB));
+      for (int i = 0; i < 10; ++i)
+      {
+        SimulateWindow(tuner, now, throughputFunc);
+      }
+      EXPECT_EQ(tuner.GetConcurrency(), 8);
+      EXPECT_EQ(tuner.GetChunkSize(), static_cast<int64_t>(1_MB));
+    }
+
+    // Tuned values are remembered for the endpoint and clamped to the new limits.
+    {
+      Details::TransferAutoTuner tuner("ramp.test/upload", 4_MB, 8_MB, 64);
+      EXPECT_EQ(tuner.GetConcurrency(), 8);
+      EXPECT_EQ(tuner.GetChunkSize(), static_cast<int64_t>(1_MB));
+    }
+    {
+      Details::TransferAutoTuner tuner("ramp.test/upload", 4_MB, 8_MB, 4);
+      EXPECT_EQ(tuner.GetConcurrency(), 4);
+    }
+    {
+      Details::TransferAutoTuner tuner("ramp.test/download", 4_MB, 8_MB, 64);
+      EXPECT_EQ(tuner.GetConcurrency(), 2);
+      EXPECT_EQ(tuner.GetChunkSize(), static_cast<int64_t>(4_MB));
+    }
+  }
+
+  TEST(TransferAutoTunerTest, RespectsLimits)
+  {
+    auto throughputFunc = [](int concurrency, int64_t chunkSize) {
+      return concurrency * static_cast<double>(chunkSize) * 10.0;
+    };
+    auto now = std::chrono::steady_clock::now();
+    Details::TransferAutoTuner tuner("limits.test/upload", 1_MB, 4_MB, 16);
+    for (int i = 0; i < 20; ++i)
+    {
+      SimulateWindow(tuner, now, throughputFunc);
+      EXPECT_LE(tuner.GetConcurrency(), 16);
+      EXPECT_LE(tuner.GetChunkSize(), static_cast<int64_t>(4_MB));
+    }
+    EXPECT_EQ(tuner.GetConcurrency(), 16);
+    EXPECT_EQ(tuner.GetChunkSize(), static_cast<int64_t>(4_MB));
+  }
+
+  TEST(TransferAutoTunerTest, BacksOff)
+  {
+    auto throughputFunc = [](int concurrency, int64_t) { return concurrency * 10.0 * 1_MB; };
+    auto now = std::chrono::steady_clock::now();
+    {
+      Details::TransferAutoTuner tuner("backoff.test/upload", 1_MB, 1_MB, 64);
+      SimulateWindow(tuner, now, throughputFunc);
+      SimulateWindow(tuner, now, throughputFunc);
+      SimulateWindow(tuner, now, throughputFunc);
+      EXPECT_EQ(tuner.GetConcurrency(), 16);
+
+      tuner.OnThrottled();
+      EXPECT_EQ(tuner.GetConcurrency(), 8);
+
+      // Clean windows add parallel requests back one at a time.
+      SimulateWindow(tuner, now, throughputFunc);
+      EXPECT_EQ(tuner.GetConcurrency(), 9);
+      SimulateWindow(tuner, now, throughputFunc);
+      EXPECT_EQ(tuner.GetConcurrency(), 10);
+
+      // Same throughput with latency way above the baseline.
+      SimulateWindow(tuner, now, throughputFunc, 5.0);
+      EXPECT_EQ(tuner.GetConcurrency(), 5);
+    }
+    {
+      // Values backed off to aren't remembered before they were measured.
+      Details::TransferAutoTuner tuner("backoff.test/upload", 1_MB, 1_MB, 64);
+      EXPECT_EQ(tuner.GetConcurrency(), 2);
+      SimulateWindow(tuner, now, throughputFunc);
+      SimulateWindow(tuner, now, throughputFunc);
+      EXPECT_EQ(tuner.GetConcurrency(), 8);
+      tuner.OnThrottled();
+      SimulateWindow(tuner, now, throughputFunc);
+      EXPECT_EQ(tuner.GetConcurrency(), 5);
+    }
+    {
+      Details::TransferAutoTuner tuner("backoff.test/upload", 1_MB, 1_MB, 64);
+      EXPECT_EQ(tuner.GetConcurrency(), 4);
+    }
+  }
+
+  TEST(TransferAutoTunerTest, RampsAgainAfterBackingOff)
+  {
+    auto throughputFunc = [](int concurrency, int64_t) { return concurrency * 10.0 * 1_MB; };
+    auto now = std::chrono::steady_clock::now();
+    Details::TransferAutoTuner tuner("recover.test/upload", 1_MB, 1_MB, 64);
+    SimulateWindow(tuner, now, throughputFunc);
+    SimulateWindow(tuner, now, throughputFunc);
+    SimulateWindow(tuner, now, throughputFunc);
+    EXPECT_EQ(tuner.GetConcurrency(), 16);
+
+    // Throttled requests don't cap the rest of the transfer.
+    tuner.OnThrottled();
+    tuner.OnThrottled();
+    EXPECT_EQ(tuner.GetConcurrency(), 8);
+    for (int i = 0; i < 7; ++i)
+    {
+      SimulateWindow(tuner, now, throughputFunc);
+    }
+    EXPECT_EQ(tuner.GetConcurrency(), 15);
+    SimulateWindow(tuner, now, throughputFunc);
+    EXPECT_EQ(tuner.GetConcurrency(), 32);
+    SimulateWindow(tuner, now, throughputFunc);
+    EXPECT_EQ(tuner.GetConcurrency(), 64);
+  }
+
+  TEST(TransferAutoTunerTest, AdaptiveTransferCoversAllChunks)
+  {
+    Details::TransferAutoTuner tuner("adaptive.test/download", 3, 64, 4);
+
+    std::mutex mutex;
+    std::vector<std::pair<int64_t, int64_t>> chunks;
+    std::vector<int64_t> chunkIds;
+    std::atomic<int> inFlight{0};
+    std::atomic<int> maxInFlight{0};
+    auto transferFunc = [&](Azure::Core::Context&,
+                            int64_t offset,
+                            int64_t length,
+                            int64_t chunkId) {
+      int current = inFlight.fetch_add(1) + 1;
+      int previous = maxInFlight.load();
+      while (current > previous && !maxInFlight.compare_exchange_weak(previous, current))
+      {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      inFlight.fetch_sub(1);
+      std::lock_guard<std::mutex> guard(mutex);
+      chunks.emplace_back(offset, length);
+      chunkIds.emplace_back(chunkId);
+    };
+    int64_t numChunks = Details::AdaptiveConcurrentTransfer(
+        Azure::Core::Context(), 100, 1000, 50000, tuner, transferFunc);
+
+    EXPECT_EQ(numChunks, static_cast<int64_t>(chunks.size()));
+    EXPECT_LE(maxInFlight.load(), 4);
+    std::sort(chunks.begin(), chunks.end());
+    std::sort(chunkIds.begin(), chunkIds.end());
+    int64_t expectedOffset = 100;
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+      EXPECT_EQ(chunks[i].first, expectedOffset);
+      EXPECT_GT(chunks[i].second, 0);
+      EXPECT_LE(chunks[i].second, 64);
+      expectedOffset += chunks[i].second;
+      EXPECT_EQ(chunkIds[i], static_cast<int64_t>(i));
+    }
+    EXPECT_EQ(expectedOffset, 1100);
+  }
+
+  TEST(TransferAutoTunerTest, AdaptiveTransferRespectsMaxNumChunks)
+  {
+    Details::TransferAutoTuner tuner("adaptive.test/upload", 1, 1, 4);
+    std::atomic<int64_t> totalLength{0};
+    int64_t numChunks = Details::AdaptiveConcurrentTransfer(
+        Azure::Core::Context(),
+        0,
+        1000,
+        7,
+        tuner,
+        [&](Azure::Core::Context&, int64_t, int64_t length, int64_t) {
+          totalLength.fetch_add(length);
+        });
+    EXPECT_LE(numChunks, 7);
+    EXPECT_EQ(totalLength.load(), 1000);
+
+    numChunks = Details::AdaptiveConcurrentTransfer(
+        Azure::Core::Context(),
+        0,
+        0,
+        7,
+        tuner,
+        [&](Azure::Core::Context&, int64_t, int64_t, int64_t) {});
+    EXPECT_EQ(numChunks, 0);
+  }
+
+}}} // namespace Azure::Storage::Test
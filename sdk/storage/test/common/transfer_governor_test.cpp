@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/concurrent_transfer.hpp"
+#include "common/transfer_governor.hpp"
+#include "test_base.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  TEST(TransferGovernorTest, BoundsInFlightChunks)
+  {
+    auto& governor = TransferGovernor::GetDefault();
+    governor.SetMaximumInFlightChunks(3);
+
+    std::atomic<int> inFlight{0};
+    std::atomic<int> maxInFlight{0};
+    auto transferFunc = [&](Azure::Core::Context&, int64_t, int64_t, int64_t, int64_t) {
+      int current = inFlight.fetch_add(1) + 1;
+      int previous = maxInFlight.load();
+      while (current > previous && !maxInFlight.compare_exchange_weak(previous, current))
+      {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      inFlight.fetch_sub(1);
+    };
+
+    std::vector<std::future<void>> transfers;
+    for (int i = 0; i < 4; ++i)
+    {
+      transfers.emplace_back(std::async(std::launch::async, [&]() {
+        Details::ConcurrentTransfer(Azure::Core::Context(), 0, 32, 1, 4, transferFunc);
+      }));
+    }
+    for (auto& transfer : transfers)
+    {
+      transfer.get();
+    }
+    EXPECT_LE(maxInFlight.load(), 3);
+
+    auto usage = governor.GetUsage();
+    EXPECT_EQ(usage.ActiveTransfers, 0);
+    EXPECT_EQ(usage.InFlightChunks, 0);
+    EXPECT_EQ(usage.BufferBytes, 0);
+    EXPECT_EQ(usage.QueuedChunks, 0);
+    governor.SetMaximumInFlightChunks(std::numeric_limits<int64_t>::max());
+  }
+
+  TEST(TransferGovernorTest, BoundsBufferBytes)
+  {
+    TransferGovernor governor;
+    governor.SetMaximumBufferBytes(100);
+    Azure::Core::Context context;
+
+    Details::GovernedTransfer transfer1(governor);
+    Details::GovernedTransfer transfer2(governor);
+    auto permit1 = transfer1.Acquire(context, 60);
+    EXPECT_EQ(governor.GetUsage().BufferBytes, 60);
+
+    auto pending = std::async(std::launch::async, [&]() {
+      auto permit2 = transfer2.Acquire(context, 60);
+      EXPECT_EQ(governor.GetUsage().BufferBytes, 60);
+    });
+    EXPECT_EQ(pending.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+    EXPECT_EQ(governor.GetUsage().QueuedChunks, 1);
+    permit1.Release();
+    pending.get();
+    EXPECT_EQ(governor.GetUsage().BufferBytes, 0);
+
+    // A chunk larger than the limit is admitted when nothing else is in flight.
+    auto permit3 = transfer1.Acquire(context, 200);
+    EXPECT_EQ(governor.GetUsage().BufferBytes, 200);
+  }
+
+  TEST(TransferGovernorTest, FairAcrossTransfers)
+  {
+    TransferGovernor governor;
+    governor.SetMaximumInFlightChunks(2);
+    Azure::Core::Context context;
+
+    Details::GovernedTransfer busyTransfer(governor);
+    Details::GovernedTransfer idleTransfer(governor);
+    auto permit1 = busyTransfer.Acquire(context, 0);
+    auto permit2 = busyTransfer.Acquire(context, 0);
+
+    std::atomic<int> order{0};
+    int busyOrder = 0;
+    int idleOrder = 0;
+    auto busy = std::async(std::launch::async, [&]() {
+      auto p = busyTransfer.Acquire(context, 0);
+      busyOrder = ++order;
+    });
+    while (governor.GetUsage().QueuedChunks != 1)
+    {
+      std::this_thread::yield();
+    }
+    auto idle = std::async(std::launch::async, [&]() {
+      auto p = idleTransfer.Acquire(context, 0);
+      idleOrder = ++order;
+    });
+    while (governor.GetUsage().QueuedChunks != 2)
+    {
+      std::this_thread::yield();
+    }
+    // The busy transfer queued first, but the idle transfer is admitted first because it has
+    // nothing in flight.
+    permit1.Release();
+    idle.get();
+    permit2.Release();
+    busy.get();
+    EXPECT_EQ(idleOrder, 1);
+    EXPECT_EQ(busyOrder, 2);
+  }
+
+}}} // namespace Azure::Storage::Test
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/transfer_journal.hpp"
+#include "test_base.hpp"
+
+#include <fstream>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  TEST(TransferJournalTest, ResumesSameTransfer)
+  {
+    const std::string path = RandomString() + ".journal";
+    {
+      Details::TransferJournal journal(path, "transfer 1");
+      EXPECT_TRUE(journal.GetCompletedChunks().empty());
+      journal.MarkCompleted(3);
+      journal.MarkCompleted(0);
+      // Chunks marked in this run aren't reported as done by earlier runs.
+      EXPECT_FALSE(journal.IsCompleted(3));
+    }
+    {
+      Details::TransferJournal journal(path, "transfer 1");
+      EXPECT_EQ(journal.GetCompletedChunks(), std::set<int64_t>({0, 3}));
+      EXPECT_TRUE(journal.IsCompleted(3));
+      EXPECT_FALSE(journal.IsCompleted(1));
+      journal.SetCompletedChunks({3});
+      journal.MarkCompleted(5);
+    }
+    {
+      Details::TransferJournal journal(path, "transfer 1");
+      EXPECT_EQ(journal.GetCompletedChunks(), std::set<int64_t>({3, 5}));
+      journal.Remove();
+    }
+    EXPECT_FALSE(std::ifstream(path).good());
+  }
+
+  TEST(TransferJournalTest, StartsOver)
+  {
+    const std::string path = RandomString() + ".journal";
+    {
+      Details::TransferJournal journal(path, "transfer 1");
+      journal.MarkCompleted(1);
+      journal.MarkCompleted(2);
+    }
+    {
+      // A crash in the middle of a record leaves it without a newline.
+      std::ofstream stream(path, std::ios::binary | std::ios::app);
+      stream << "12";
+    }
+    {
+      Details::TransferJournal journal(path, "transfer 1");
+      EXPECT_EQ(journal.GetCompletedChunks(), std::set<int64_t>({1, 2}));
+      journal.MarkCompleted(4);
+    }
+    {
+      Details::TransferJournal journal(path, "transfer 1");
+      EXPECT_EQ(journal.GetCompletedChunks(), std::set<int64_t>({1, 2, 4}));
+    }
+    {
+      // The source changed, nothing of the earlier transfer can be kept.
+      Details::TransferJournal journal(path, "transfer 2");
+      EXPECT_TRUE(journal.GetCompletedChunks().empty());
+    }
+    {
+      Details::TransferJournal journal(path, "transfer 1");
+      EXPECT_TRUE(journal.GetCompletedChunks().empty());
+      journal.Remove();
+    }
+    EXPECT_THROW(Details::TransferJournal(path, "two\nlines"), std::runtime_error);
+  }
+
+}}} // namespace Azure::Storage::Test
@@ -0,0 +1,163 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "common/xml_wrapper.hpp"
+#include "test_base.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Azure { namespace Storage { namespace Test {
+
+  namespace {
+    // Hands out a document a few bytes at a time, as a slow connection would, and fails once
+    // FailAt bytes have been read.
+    class TrickleBodyStream : public Azure::Core::Http::BodyStream {
+    public:
+      explicit TrickleBodyStream(std::string content) : m_content(std::move(content)) {}
+
+      int64_t Length() const override { return -1; }
+
+      int64_t Read(Azure::Core::Context&, uint8_t* buffer, int64_t count) override
+      {
+        if (BytesRead >= FailAt)
+        {
+          throw std::runtime_error("connection reset");
+        }
+        int64_t length = std::min(
+            {count, int64_t(7), static_cast<int64_t>(m_content.length()) - BytesRead});
+        std::memcpy(buffer, m_content.data() + BytesRead, static_cast<std::size_t>(length));
+        BytesRead += length;
+        return length;
+      }
+
+      int64_t BytesRead = 0;
+      int64_t FailAt = std::numeric_limits<int64_t>::max();
+
+    private:
+      std::string m_content;
+    };
+
+    std::vector<std::string> ReadTexts(XmlReader& reader)
+    {
+      std::vector<std::string> texts;
+      while (true)
+      {
+        auto node = reader.Read();
+        if (node.Type == XmlNodeType::End)
+        {
+          break;
+        }
+        if (node.Type == XmlNodeType::Text)
+        {
+          texts.emplace_back(node.Value);
+        }
+      }
+      return texts;
+    }
+  } // namespace
+
+  TEST(XmlReaderTest, ReadsFromStream)
+  {
+    std::string document = "<?xml version=\"1.0\" encoding=\"utf-8\"?><Items>";
+    std::vector<std::string> expected;
+    for (int i = 0; i < 2000; ++i)
+    {
+      expected.emplace_back("item" + std::to_string(i));
+      document += "<Item>" + expected.back() + "</Item>";
+    }
+    document += "</Items>";
+
+    XmlReader bufferReader(document.data(), document.length());
+    EXPECT_EQ(ReadTexts(bufferReader), expected);
+
+    TrickleBodyStream stream(document);
+    XmlReader streamReader(Azure::Core::Context(), stream);
+    // Nodes come out long before the whole document has been read.
+    auto node = streamReader.Read();
+    while (node.Type != XmlNodeType::Text)
+    {
+      node = streamReader.Read();
+    }
+    EXPECT_EQ(std::string(node.Value), expected[0]);
+    EXPECT_LT(stream.BytesRead, static_cast<int64_t>(document.length()) / 2);
+    auto texts = ReadTexts(streamReader);
+    EXPECT_EQ(texts, std::vector<std::string>(expected.begin() + 1, expected.end()));
+    EXPECT_EQ(stream.BytesRead, static_cast<int64_t>(document.length()));
+
+    // A stream that fails makes the reader throw what the stream threw.
+    TrickleBodyStream failingStream(document);
+    failingStream.FailAt = static_cast<int64_t>(document.length()) / 2;
+    XmlReader failingReader(Azure::Core::Context(), failingStream);
+    try
+    {
+      ReadTexts(failingReader);
+      FAIL();
+    }
+    catch (std::runtime_error& e)
+    {
+      EXPECT_EQ(std::string(e.what()), "connection reset");
+    }
+
+    TrickleBodyStream truncatedStream(document.substr(0, document.length() / 2));
+    XmlReader truncatedReader(Azure::Core::Context(), truncatedStream);
+    EXPECT_THROW(ReadTexts(truncatedReader), std::runtime_error);
+  }
+
+  TEST(XmlListBodyStreamTest, SerializesElements)
+  {
+    std::vector<std::pair<std::string, std::string>> elements
+        = {{"Latest", "MDAwMDAw"}, {"Uncommitted", "a<b>&c\r"}, {"Committed", ""}};
+    XmlListBodyStream stream("BlockList", elements.size(), [&](std::size_t index) {
+      const auto& element = elements[index];
+      return XmlNode{XmlNodeType::StartTag, element.first.data(), element.second.data()};
+    });
+    const std::string expected = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<BlockList>"
+                                 "<Latest>MDAwMDAw</Latest><Uncommitted>a&lt;b&gt;&amp;c&#13;"
+                                 "</Uncommitted><Committed></Committed></BlockList>";
+    EXPECT_EQ(stream.Length(), static_cast<int64_t>(expected.length()));
+
+    Azure::Core::Context context;
+    for (int64_t chunkSize : {1, 5, 1000})
+    {
+      stream.Rewind();
+      std::string document;
+      std::vector<uint8_t> buffer(static_cast<std::size_t>(chunkSize));
+      while (true)
+      {
+        int64_t bytesRead = stream.Read(context, buffer.data(), chunkSize);
+        if (bytesRead == 0)
+        {
+          break;
+        }
+        document.append(buffer.begin(), buffer.begin() + static_cast<std::size_t>(bytesRead));
+      }
+      EXPECT_EQ(document, expected);
+    }
+
+    stream.Rewind();
+    XmlReader reader(context, stream);
+    EXPECT_EQ(ReadTexts(reader), std::vector<std::string>({"MDAwMDAw", "a<b>&c\r"}));
+
+    // A cancelled request fails the read instead of taking down the process.
+    stream.Rewind();
+    auto cancelledContext = context.WithDeadline(Azure::Core::Context::time_point::max());
+    cancelledContext.Cancel();
+    uint8_t buffer[16];
+    try
+    {
+      stream.Read(cancelledContext, buffer, sizeof(buffer));
+      FAIL();
+    }
+    catch (std::runtime_error& e)
+    {
+      EXPECT_EQ(std::string(e.what()), "the operation was cancelled");
+    }
+  }
+
+}}} // namespace Azure::Storage::Test
@@ -4,6 +4,8 @@
 #include "file_system_client_test.hpp"
 
 #include <algorithm>
+#include <stdexcept>
+#include <string>
 
 namespace Azure { namespace Storage { namespace Test {
 
@@ -244,4 +246,61 @@ namespace Azure { namespace Storage { namespace Test {
       EXPECT_LE(2U, response.Paths.size());
     }
   }
+
+  TEST(ListPathsTest, ParsesStream)
+  {
+    std::string document = R"({"paths": [)"
+                           R"({"contentLength": "1024", "etag": "0x8D8", "group": "$superuser",)"
+                           R"( "lastModified": "Thu, 14 Jun 2018 16:46:54 GMT", "name": "dir/a",)"
+                           R"( "owner": "$superuser", "permissions": "rw-r-----"},)"
+                           R"({"name": "dir", "isDirectory": true, "contentLength": 0,)"
+                           R"( "extra": {"name": "decoy", "paths": [{"name": "decoy"}]}}]})";
+    Azure::Core::Http::MemoryBodyStream stream(
+        reinterpret_cast<const uint8_t*>(document.data()), document.length());
+    auto paths = DataLake::PathList::CreateFromJsonStream(Azure::Core::Context(), stream).Paths;
+    ASSERT_EQ(paths.size(), 2U);
+    EXPECT_EQ(paths[0].Name, "dir/a");
+    EXPECT_FALSE(paths[0].IsDirectory.HasValue());
+    EXPECT_EQ(paths[0].ContentLength.GetValue(), 1024);
+    EXPECT_EQ(paths[0].Etag, "0x8D8");
+    EXPECT_EQ(paths[0].LastModified, "Thu, 14 Jun 2018 16:46:54 GMT");
+    EXPECT_EQ(paths[0].Owner, "$superuser");
+    EXPECT_EQ(paths[0].Group, "$superuser");
+    EXPECT_EQ(paths[0].Permissions, "rw-r-----");
+    EXPECT_EQ(paths[1].Name, "dir");
+    EXPECT_TRUE(paths[1].IsDirectory.GetValue());
+    EXPECT_EQ(paths[1].ContentLength.GetValue(), 0);
+
+    // Arrays nested in an item don't end the list.
+    document = R"({"paths":[{"name":"a","acl":[1,2]},{"name":"b"},{"name":"c"}]})";
+    Azure::Core::Http::MemoryBodyStream nestedStream(
+        reinterpret_cast<const uint8_t*>(document.data()), document.length());
+    paths = DataLake::PathList::CreateFromJsonStream(Azure::Core::Context(), nestedStream).Paths;
+    ASSERT_EQ(paths.size(), 3U);
+    EXPECT_EQ(paths[0].Name, "a");
+    EXPECT_EQ(paths[1].Name, "b");
+    EXPECT_EQ(paths[2].Name, "c");
+
+    document = R"({"filesystems": [{"name": "a", "etag": "0x1"}, {"name": "b"}]})";
+    Azure::Core::Http::MemoryBodyStream fileSystemsStream(
+        reinterpret_cast<const uint8_t*>(document.data()), document.length());
+    auto fileSystems
+        = DataLake::FileSystemList::CreateFromJsonStream(Azure::Core::Context(), fileSystemsStream)
+              .Filesystems;
+    ASSERT_EQ(fileSystems.size(), 2U);
+    EXPECT_EQ(fileSystems[0].Name, "a");
+    EXPECT_EQ(fileSystems[0].Etag, "0x1");
+    EXPECT_EQ(fileSystems[1].Name, "b");
+
+    Azure::Core::Http::NullBodyStream emptyStream;
+    auto emptyList = DataLake::PathList::CreateFromJsonStream(Azure::Core::Context(), emptyStream);
+    EXPECT_TRUE(emptyList.Paths.empty());
+
+    document = R"({"paths": [{"name": "a"},)";
+    Azure::Core::Http::MemoryBodyStream truncatedStream(
+        reinterpret_cast<const uint8_t*>(document.data()), document.length());
+    EXPECT_THROW(
+        DataLake::PathList::CreateFromJsonStream(Azure::Core::Context(), truncatedStream),
+        std::runtime_error);
+  }
 }}} // namespace Azure::Storage::Test